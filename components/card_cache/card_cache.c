@@ -0,0 +1,121 @@
+#include "card_cache.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "string.h"
+
+static const char *TAG = "card_cache";
+
+_Static_assert(sizeof(card_cache_entry_t) == 48, "card_cache_entry_t should stay 48 bytes");
+
+static card_cache_entry_t s_entries[CARD_CACHE_MAX_ENTRIES];
+static uint32_t s_hits = 0;
+static uint32_t s_misses = 0;
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static card_cache_entry_t* find_entry(const uint8_t* uid, uint8_t uid_length)
+{
+    for (int i = 0; i < CARD_CACHE_MAX_ENTRIES; i++) {
+        card_cache_entry_t *e = &s_entries[i];
+        if (e->uid_length == uid_length && memcmp(e->uid, uid, uid_length) == 0) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+void card_cache_init(void)
+{
+    memset(s_entries, 0, sizeof(s_entries));
+    s_hits = 0;
+    s_misses = 0;
+}
+
+bool card_cache_lookup(const uint8_t* uid, uint8_t uid_length, uint32_t max_age_ms, card_cache_entry_t* entry)
+{
+    if (!uid || uid_length == 0 || uid_length > CARD_CACHE_MAX_UID_LENGTH) {
+        return false;
+    }
+
+    card_cache_entry_t *e = find_entry(uid, uid_length);
+    uint32_t now = now_ms();
+
+    // Wrap-safe age check; a stale entry is kept for eviction but reported as a miss
+    if (!e || (max_age_ms > 0 && (uint32_t)(now - e->last_seen_ms) > max_age_ms)) {
+        s_misses++;
+        return false;
+    }
+
+    e->last_seen_ms = now;
+    if (entry) {
+        *entry = *e;
+    }
+    s_hits++;
+    ESP_LOGD(TAG, "Cache hit (%lu hits, %lu misses)", (unsigned long)s_hits, (unsigned long)s_misses);
+    return true;
+}
+
+esp_err_t card_cache_store(const card_cache_entry_t* entry)
+{
+    if (!entry || entry->uid_length == 0 || entry->uid_length > CARD_CACHE_MAX_UID_LENGTH) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t now = now_ms();
+    card_cache_entry_t *slot = find_entry(entry->uid, entry->uid_length);
+
+    if (!slot) {
+        // Take a free slot, otherwise evict the least recently seen card
+        uint32_t oldest_age = 0;
+        for (int i = 0; i < CARD_CACHE_MAX_ENTRIES; i++) {
+            card_cache_entry_t *e = &s_entries[i];
+            if (e->uid_length == 0) {
+                slot = e;
+                break;
+            }
+            uint32_t age = now - e->last_seen_ms;
+            if (!slot || age > oldest_age) {
+                slot = e;
+                oldest_age = age;
+            }
+        }
+        if (slot->uid_length != 0) {
+            ESP_LOGD(TAG, "Evicting card with %d byte UID", slot->uid_length);
+        }
+    }
+
+    *slot = *entry;
+    slot->last_seen_ms = now;
+    return ESP_OK;
+}
+
+void card_cache_invalidate(const uint8_t* uid, uint8_t uid_length)
+{
+    if (!uid || uid_length == 0 || uid_length > CARD_CACHE_MAX_UID_LENGTH) {
+        return;
+    }
+
+    card_cache_entry_t *e = find_entry(uid, uid_length);
+    if (e) {
+        memset(e, 0, sizeof(*e));
+    }
+}
+
+uint32_t card_cache_hash(const uint8_t* data, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void card_cache_get_stats(uint32_t* hits, uint32_t* misses)
+{
+    if (hits) *hits = s_hits;
+    if (misses) *misses = s_misses;
+}
@@ -0,0 +1,90 @@
+#ifndef CARD_CACHE_H
+#define CARD_CACHE_H
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CARD_CACHE_MAX_ENTRIES    8
+#define CARD_CACHE_MAX_UID_LENGTH 10
+#define CARD_CACHE_CLASSIC_SECTORS 16   // Mifare Classic 1K sectors with a remembered key
+
+// sector_keys[] encoding: 0 = unknown, otherwise key dictionary index + 1, bit 7 set for key B
+#define CARD_CACHE_KEY_B          0x80
+#define CARD_CACHE_KEY_INDEX_MASK 0x7F
+
+// How much of a repeat tap may be answered from the cache
+typedef enum {
+    CARD_CACHE_POLICY_DISABLED = 0,   // Always identify the card and read its content
+    CARD_CACHE_POLICY_SKIP_IDENTIFY,  // Reuse the cached model, still read content
+    CARD_CACHE_POLICY_SKIP_ALL,       // Reuse model and content, no card commands at all
+} card_cache_policy_t;
+
+// One cached card. Kept at 48 bytes so the whole table fits in a few cache lines.
+typedef struct {
+    uint8_t uid[CARD_CACHE_MAX_UID_LENGTH];
+    uint8_t uid_length;       // 0 means free slot
+    uint8_t model;            // NTAG2XX_MODEL of the card
+    uint16_t page_count;      // Capacity in 4-byte pages
+    uint16_t ndef_length;     // Length of the NDEF data captured on the last full read
+    uint32_t ndef_hash;       // FNV-1a hash of that NDEF data
+    uint32_t last_seen_ms;    // Monotonic time of the last tap (also the LRU key)
+    uint8_t sak;              // SEL_RES of the card, 0x08/0x18 for Mifare Classic
+    uint8_t sector_keys[CARD_CACHE_CLASSIC_SECTORS]; // Key that opened each Classic sector
+    uint8_t reserved[7];
+} card_cache_entry_t;
+
+/**
+ * @brief Clear all cached cards
+ */
+void card_cache_init(void);
+
+/**
+ * @brief Look up a card by UID and refresh its last-seen time
+ * @param uid Card UID
+ * @param uid_length UID length in bytes
+ * @param max_age_ms Entries not seen for longer than this are treated as misses (0 = no limit)
+ * @param entry Receives a copy of the cached entry on hit (may be NULL)
+ * @return true on a fresh hit
+ */
+bool card_cache_lookup(const uint8_t* uid, uint8_t uid_length, uint32_t max_age_ms, card_cache_entry_t* entry);
+
+/**
+ * @brief Insert or update a card, evicting the least recently seen entry if full
+ * @param entry Card data (last_seen_ms is set by the cache)
+ * @return ESP_OK on success
+ */
+esp_err_t card_cache_store(const card_cache_entry_t* entry);
+
+/**
+ * @brief Drop a card from the cache
+ * @param uid Card UID
+ * @param uid_length UID length in bytes
+ */
+void card_cache_invalidate(const uint8_t* uid, uint8_t uid_length);
+
+/**
+ * @brief Hash NDEF content for change detection (FNV-1a, 32 bit)
+ * @param data Content bytes
+ * @param len Content length
+ * @return Hash value
+ */
+uint32_t card_cache_hash(const uint8_t* data, size_t len);
+
+/**
+ * @brief Get hit/miss counters since boot
+ * @param hits Number of fresh hits (may be NULL)
+ * @param misses Number of misses (may be NULL)
+ */
+void card_cache_get_stats(uint32_t* hits, uint32_t* misses);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CARD_CACHE_H
@@ -0,0 +1,230 @@
+#include "card_enroll.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "string.h"
+
+static const char *TAG = "card_enroll";
+
+// NVS blob: version byte, then per card one byte (state << 4 | uid length) and the UID bytes
+#define BLOB_VERSION  1
+#define BLOB_MAX_SIZE (1 + CARD_ENROLL_MAX_ENTRIES * (1 + CARD_ENROLL_MAX_UID_LENGTH))
+
+// Sorted by length, then UID bytes
+typedef struct {
+    uint8_t length;
+    uint8_t uid[CARD_ENROLL_MAX_UID_LENGTH];
+    uint8_t state;
+} enroll_entry_t;
+
+static enroll_entry_t s_entries[CARD_ENROLL_MAX_ENTRIES];
+static size_t s_count = 0;
+static bool s_dirty = false;
+static int64_t s_last_change_us = 0;
+
+static int compare_key(const enroll_entry_t* e, const uint8_t* uid, uint8_t uid_length)
+{
+    if (e->length != uid_length) {
+        return e->length < uid_length ? -1 : 1;
+    }
+    return memcmp(e->uid, uid, uid_length);
+}
+
+// Index of the card, or of the insertion point when absent
+static size_t find_index(const uint8_t* uid, uint8_t uid_length, bool* found)
+{
+    size_t lo = 0;
+    size_t hi = s_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = compare_key(&s_entries[mid], uid, uid_length);
+        if (cmp == 0) {
+            *found = true;
+            return mid;
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    *found = false;
+    return lo;
+}
+
+// Make room for a revocation by dropping the last enrolled card; keeps *index pointing at
+// the same insertion point
+static esp_err_t evict_allowed(size_t* index)
+{
+    for (size_t i = s_count; i-- > 0; ) {
+        if (s_entries[i].state == CARD_ENROLL_ALLOWED) {
+            ESP_LOGW(TAG, "List full, dropping an enrolled card (%u-byte UID) to store a revocation",
+                     s_entries[i].length);
+            memmove(&s_entries[i], &s_entries[i + 1], (s_count - i - 1) * sizeof(s_entries[0]));
+            s_count--;
+            if (i < *index) {
+                (*index)--;
+            }
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+static esp_err_t set_state(const uint8_t* uid, uint8_t uid_length, card_enroll_state_t state)
+{
+    if (!uid || uid_length == 0 || uid_length > CARD_ENROLL_MAX_UID_LENGTH) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    bool found;
+    size_t index = find_index(uid, uid_length, &found);
+    if (found) {
+        if (s_entries[index].state == state) {
+            return ESP_OK;
+        }
+    } else {
+        if (state == CARD_ENROLL_ALLOWED && s_count >= CARD_ENROLL_MAX_ENTRIES - CARD_ENROLL_REVOKE_RESERVE) {
+            ESP_LOGW(TAG, "Enrollment list full (%d cards)", CARD_ENROLL_MAX_ENTRIES - CARD_ENROLL_REVOKE_RESERVE);
+            return ESP_ERR_NO_MEM;
+        }
+        if (s_count == CARD_ENROLL_MAX_ENTRIES && evict_allowed(&index) != ESP_OK) {
+            ESP_LOGW(TAG, "Enrollment list full of revoked cards (%d)", CARD_ENROLL_MAX_ENTRIES);
+            return ESP_ERR_NO_MEM;
+        }
+        memmove(&s_entries[index + 1], &s_entries[index], (s_count - index) * sizeof(s_entries[0]));
+        memset(&s_entries[index], 0, sizeof(s_entries[0]));
+        s_entries[index].length = uid_length;
+        memcpy(s_entries[index].uid, uid, uid_length);
+        s_count++;
+    }
+
+    s_entries[index].state = state;
+    s_dirty = true;
+    s_last_change_us = esp_timer_get_time();
+    return ESP_OK;
+}
+
+esp_err_t card_enroll_init(void)
+{
+    s_count = 0;
+    s_dirty = false;
+
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(CARD_ENROLL_NVS_NAMESPACE, NVS_READONLY, &nvs);
+    if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        return ESP_OK;   // Namespace is created on the first write
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    static uint8_t blob[BLOB_MAX_SIZE];
+    size_t size = sizeof(blob);
+    ret = nvs_get_blob(nvs, CARD_ENROLL_NVS_KEY, blob, &size);
+    nvs_close(nvs);
+    if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        return ESP_OK;
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to load enrollment list: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    if (size == 0 || blob[0] != BLOB_VERSION) {
+        ESP_LOGW(TAG, "Ignoring enrollment list with unknown format");
+        return ESP_OK;
+    }
+
+    // Stored in index order, so records append without re-sorting
+    for (size_t pos = 1; pos < size && s_count < CARD_ENROLL_MAX_ENTRIES; ) {
+        uint8_t length = blob[pos] & 0x0F;
+        uint8_t state = blob[pos] >> 4;
+        if (length == 0 || length > CARD_ENROLL_MAX_UID_LENGTH || pos + 1 + length > size ||
+            (state != CARD_ENROLL_ALLOWED && state != CARD_ENROLL_REVOKED)) {
+            ESP_LOGW(TAG, "Enrollment list truncated at byte %u", (unsigned)pos);
+            break;
+        }
+        enroll_entry_t* e = &s_entries[s_count++];
+        memset(e, 0, sizeof(*e));
+        e->length = length;
+        e->state = state;
+        memcpy(e->uid, &blob[pos + 1], length);
+        pos += 1 + length;
+    }
+
+    ESP_LOGI(TAG, "Loaded %u enrolled/revoked cards", (unsigned)s_count);
+    return ESP_OK;
+}
+
+card_enroll_state_t card_enroll_lookup(const uint8_t* uid, uint8_t uid_length)
+{
+    if (!uid || uid_length == 0 || uid_length > CARD_ENROLL_MAX_UID_LENGTH) {
+        return CARD_ENROLL_UNKNOWN;
+    }
+
+    bool found;
+    size_t index = find_index(uid, uid_length, &found);
+    return found ? (card_enroll_state_t)s_entries[index].state : CARD_ENROLL_UNKNOWN;
+}
+
+esp_err_t card_enroll_add(const uint8_t* uid, uint8_t uid_length)
+{
+    return set_state(uid, uid_length, CARD_ENROLL_ALLOWED);
+}
+
+esp_err_t card_enroll_revoke(const uint8_t* uid, uint8_t uid_length)
+{
+    esp_err_t ret = set_state(uid, uid_length, CARD_ENROLL_REVOKED);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    // Don't let a reset bring a revoked card back
+    return card_enroll_flush();
+}
+
+esp_err_t card_enroll_flush(void)
+{
+    if (!s_dirty) {
+        return ESP_OK;
+    }
+
+    static uint8_t blob[BLOB_MAX_SIZE];
+    size_t size = 0;
+    blob[size++] = BLOB_VERSION;
+    for (size_t i = 0; i < s_count; i++) {
+        blob[size++] = (uint8_t)(s_entries[i].state << 4) | s_entries[i].length;
+        memcpy(&blob[size], s_entries[i].uid, s_entries[i].length);
+        size += s_entries[i].length;
+    }
+
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(CARD_ENROLL_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = nvs_set_blob(nvs, CARD_ENROLL_NVS_KEY, blob, size);
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save enrollment list: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    s_dirty = false;
+    ESP_LOGI(TAG, "Saved %u enrolled/revoked cards (%u bytes)", (unsigned)s_count, (unsigned)size);
+    return ESP_OK;
+}
+
+void card_enroll_poll(void)
+{
+    if (s_dirty && esp_timer_get_time() - s_last_change_us >= (int64_t)CARD_ENROLL_COMMIT_DELAY_MS * 1000) {
+        card_enroll_flush();
+    }
+}
+
+size_t card_enroll_count(void)
+{
+    return s_count;
+}
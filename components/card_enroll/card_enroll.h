@@ -0,0 +1,90 @@
+#ifndef CARD_ENROLL_H
+#define CARD_ENROLL_H
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CARD_ENROLL_MAX_ENTRIES     128
+#define CARD_ENROLL_REVOKE_RESERVE  16     // Entries only revocations may use
+#define CARD_ENROLL_MAX_UID_LENGTH  10
+#define CARD_ENROLL_COMMIT_DELAY_MS 3000   // Enrollments within this window share one NVS write
+
+#define CARD_ENROLL_NVS_NAMESPACE   "card_enroll"
+#define CARD_ENROLL_NVS_KEY         "cards"
+
+/*
+ * Cards enrolled or revoked at runtime. The list lives in RAM (sorted, binary
+ * searched) and is loaded from NVS once at boot, so lookups never touch flash.
+ * Not thread-safe; use it from the task that reads cards.
+ */
+
+typedef enum {
+    CARD_ENROLL_UNKNOWN = 0,    // Not enrolled or revoked at runtime; fall back to the allowlists
+    CARD_ENROLL_ALLOWED = 1,
+    CARD_ENROLL_REVOKED = 2,    // Denied even if a built-in or partition allowlist has it
+} card_enroll_state_t;
+
+/**
+ * @brief Load the enrollment list from NVS into RAM
+ * @return ESP_OK (also when nothing is stored yet), NVS errors otherwise
+ */
+esp_err_t card_enroll_init(void);
+
+/**
+ * @brief Look up a card in the RAM index
+ * @param uid Card UID
+ * @param uid_length UID length
+ * @return Runtime state of the card
+ */
+card_enroll_state_t card_enroll_lookup(const uint8_t* uid, uint8_t uid_length);
+
+/**
+ * @brief Enroll a card; the NVS write is batched (see card_enroll_poll)
+ * @param uid Card UID
+ * @param uid_length UID length (1..10)
+ * @return ESP_OK, ESP_ERR_NO_MEM if only the revocation reserve is left
+ */
+esp_err_t card_enroll_add(const uint8_t* uid, uint8_t uid_length);
+
+/**
+ * @brief Revoke a card; effective immediately and written through to NVS
+ *
+ * Revocations may use the last CARD_ENROLL_REVOKE_RESERVE entries. Once those are gone too,
+ * an enrolled card is dropped to make room: it has to be enrolled again, but a card from a
+ * built-in or partition allowlist can always be revoked.
+ *
+ * @param uid Card UID
+ * @param uid_length UID length (1..10)
+ * @return ESP_OK, ESP_ERR_NO_MEM if every entry is a revocation, NVS errors otherwise
+ */
+esp_err_t card_enroll_revoke(const uint8_t* uid, uint8_t uid_length);
+
+/**
+ * @brief Write pending changes once CARD_ENROLL_COMMIT_DELAY_MS has passed since the last one
+ *
+ * Call from an idle slot of the card loop.
+ */
+void card_enroll_poll(void);
+
+/**
+ * @brief Write pending changes now
+ * @return ESP_OK, NVS errors otherwise
+ */
+esp_err_t card_enroll_flush(void);
+
+/**
+ * @brief Number of enrolled and revoked cards
+ */
+size_t card_enroll_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CARD_ENROLL_H
@@ -0,0 +1,190 @@
+#include "card_enroll.h"
+#include "esp_private/partition_linux.h"
+#include "nvs_flash.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Like CHECK(), but always evaluated: the checks stay in NDEBUG and release builds
+#define CHECK(cond)                                                                     \
+    do {                                                                                \
+        if (!(cond)) {                                                                  \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond);    \
+            abort();                                                                    \
+        }                                                                               \
+    } while (0)
+
+// Upper bound on flash operations in one flush; the power-loss loop must get past it
+#define MAX_CUT_POINTS 1000
+
+static const uint8_t uid_a[] = {0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+static const uint8_t uid_b[] = {0xDE, 0xAD, 0xBE, 0xEF};
+static const uint8_t uid_c[] = {0x04, 0xA0, 0xB1, 0xC2, 0xD3, 0xE4, 0xF5};
+
+// Power cycle: flash works again, RAM state is gone, the list is reloaded from NVS
+static void reboot(void)
+{
+    esp_partition_fail_after(SIZE_MAX, 0);
+    nvs_flash_deinit();
+    ESP_ERROR_CHECK(nvs_flash_init());
+    ESP_ERROR_CHECK(card_enroll_init());
+}
+
+static void wipe(void)
+{
+    nvs_flash_deinit();
+    ESP_ERROR_CHECK(nvs_flash_erase());
+    reboot();
+}
+
+static void test_lookup(void)
+{
+    wipe();
+    CHECK(card_enroll_add(uid_a, sizeof(uid_a)) == ESP_OK);
+    CHECK(card_enroll_add(uid_b, sizeof(uid_b)) == ESP_OK);
+    CHECK(card_enroll_add(uid_b, sizeof(uid_b)) == ESP_OK);
+    CHECK(card_enroll_revoke(uid_c, sizeof(uid_c)) == ESP_OK);
+
+    CHECK(card_enroll_count() == 3);
+    CHECK(card_enroll_lookup(uid_a, sizeof(uid_a)) == CARD_ENROLL_ALLOWED);
+    CHECK(card_enroll_lookup(uid_b, sizeof(uid_b)) == CARD_ENROLL_ALLOWED);
+    CHECK(card_enroll_lookup(uid_c, sizeof(uid_c)) == CARD_ENROLL_REVOKED);
+
+    // Same leading bytes, different length: another card
+    CHECK(card_enroll_lookup(uid_a, 4) == CARD_ENROLL_UNKNOWN);
+    CHECK(card_enroll_lookup(uid_a, 0) == CARD_ENROLL_UNKNOWN);
+    CHECK(card_enroll_add(uid_a, CARD_ENROLL_MAX_UID_LENGTH + 1) == ESP_ERR_INVALID_ARG);
+
+    // Revoking an enrolled card replaces its entry
+    CHECK(card_enroll_revoke(uid_a, sizeof(uid_a)) == ESP_OK);
+    CHECK(card_enroll_lookup(uid_a, sizeof(uid_a)) == CARD_ENROLL_REVOKED);
+    CHECK(card_enroll_count() == 3);
+
+    // Full list: new cards are refused, known ones still change state
+    for (int i = 0; card_enroll_count() < CARD_ENROLL_MAX_ENTRIES - CARD_ENROLL_REVOKE_RESERVE; i++) {
+        uint8_t uid[4] = {0x08, 0x00, (uint8_t)(i >> 8), (uint8_t)i};
+        CHECK(card_enroll_add(uid, sizeof(uid)) == ESP_OK);
+    }
+    uint8_t extra[4] = {0x08, 0xFF, 0xFF, 0xFF};
+    CHECK(card_enroll_add(extra, sizeof(extra)) == ESP_ERR_NO_MEM);
+    CHECK(card_enroll_add(uid_a, sizeof(uid_a)) == ESP_OK);
+
+    CHECK(card_enroll_flush() == ESP_OK);
+    reboot();
+    CHECK(card_enroll_count() == CARD_ENROLL_MAX_ENTRIES - CARD_ENROLL_REVOKE_RESERVE);
+    CHECK(card_enroll_lookup(uid_a, sizeof(uid_a)) == CARD_ENROLL_ALLOWED);
+    CHECK(card_enroll_lookup(uid_c, sizeof(uid_c)) == CARD_ENROLL_REVOKED);
+    printf("lookup: ok\n");
+}
+
+// Cards from the built-in or partition allowlists are not in the list: revoking one must
+// work however full the list is
+static void test_revoke_full(void)
+{
+    wipe();
+    int enrolled = 0;
+    while (1) {
+        uint8_t uid[4] = {0x08, 0x00, (uint8_t)(enrolled >> 8), (uint8_t)enrolled};
+        if (card_enroll_add(uid, sizeof(uid)) != ESP_OK) {
+            break;
+        }
+        enrolled++;
+    }
+    CHECK(enrolled == CARD_ENROLL_MAX_ENTRIES - CARD_ENROLL_REVOKE_RESERVE);
+
+    // The reserve takes revocations only
+    for (int i = 0; i < CARD_ENROLL_REVOKE_RESERVE; i++) {
+        uint8_t uid[4] = {0x09, 0x00, 0x00, (uint8_t)i};
+        CHECK(card_enroll_revoke(uid, sizeof(uid)) == ESP_OK);
+    }
+    CHECK(card_enroll_count() == CARD_ENROLL_MAX_ENTRIES);
+
+    // Beyond it, an enrolled card makes room
+    CHECK(card_enroll_revoke(uid_c, sizeof(uid_c)) == ESP_OK);
+    CHECK(card_enroll_lookup(uid_c, sizeof(uid_c)) == CARD_ENROLL_REVOKED);
+    CHECK(card_enroll_count() == CARD_ENROLL_MAX_ENTRIES);
+    int still_enrolled = 0;
+    for (int i = 0; i < enrolled; i++) {
+        uint8_t uid[4] = {0x08, 0x00, (uint8_t)(i >> 8), (uint8_t)i};
+        still_enrolled += card_enroll_lookup(uid, sizeof(uid)) == CARD_ENROLL_ALLOWED;
+    }
+    CHECK(still_enrolled == enrolled - 1);
+
+    reboot();
+    CHECK(card_enroll_lookup(uid_c, sizeof(uid_c)) == CARD_ENROLL_REVOKED);
+    CHECK(card_enroll_count() == CARD_ENROLL_MAX_ENTRIES);
+
+    // A list of nothing but revocations has nothing left to give up
+    wipe();
+    for (int i = 0; i < CARD_ENROLL_MAX_ENTRIES; i++) {
+        uint8_t uid[4] = {0x09, 0x00, (uint8_t)(i >> 8), (uint8_t)i};
+        CHECK(card_enroll_revoke(uid, sizeof(uid)) == ESP_OK);
+    }
+    CHECK(card_enroll_revoke(uid_c, sizeof(uid_c)) == ESP_ERR_NO_MEM);
+    printf("revoke on a full list: ok\n");
+}
+
+static void test_batching(void)
+{
+    // Enrollments are batched: lost if the power goes before the commit delay
+    wipe();
+    CHECK(card_enroll_add(uid_a, sizeof(uid_a)) == ESP_OK);
+    card_enroll_poll();
+    reboot();
+    CHECK(card_enroll_lookup(uid_a, sizeof(uid_a)) == CARD_ENROLL_UNKNOWN);
+
+    CHECK(card_enroll_add(uid_a, sizeof(uid_a)) == ESP_OK);
+    usleep((CARD_ENROLL_COMMIT_DELAY_MS + 100) * 1000);
+    card_enroll_poll();
+    reboot();
+    CHECK(card_enroll_lookup(uid_a, sizeof(uid_a)) == CARD_ENROLL_ALLOWED);
+
+    // A revoke is written through at once and takes pending enrollments along
+    CHECK(card_enroll_add(uid_b, sizeof(uid_b)) == ESP_OK);
+    CHECK(card_enroll_revoke(uid_c, sizeof(uid_c)) == ESP_OK);
+    reboot();
+    CHECK(card_enroll_lookup(uid_b, sizeof(uid_b)) == CARD_ENROLL_ALLOWED);
+    CHECK(card_enroll_lookup(uid_c, sizeof(uid_c)) == CARD_ENROLL_REVOKED);
+    printf("batching: ok\n");
+}
+
+// Cut the power after every possible number of flash operations of one flush. After the
+// reboot the list must be either the old one or the new one, never a mix or nothing.
+static void test_power_loss(void)
+{
+    int cut;
+    for (cut = 1; cut < MAX_CUT_POINTS; cut++) {
+        wipe();
+        CHECK(card_enroll_add(uid_a, sizeof(uid_a)) == ESP_OK);
+        CHECK(card_enroll_flush() == ESP_OK);
+
+        esp_partition_fail_after(cut, ESP_PARTITION_FAIL_AFTER_MODE_BOTH);
+        CHECK(card_enroll_add(uid_b, sizeof(uid_b)) == ESP_OK);
+        esp_err_t ret = card_enroll_revoke(uid_c, sizeof(uid_c));
+        reboot();
+
+        card_enroll_state_t b = card_enroll_lookup(uid_b, sizeof(uid_b));
+        card_enroll_state_t c = card_enroll_lookup(uid_c, sizeof(uid_c));
+        CHECK(card_enroll_lookup(uid_a, sizeof(uid_a)) == CARD_ENROLL_ALLOWED);
+        CHECK((b == CARD_ENROLL_UNKNOWN && c == CARD_ENROLL_UNKNOWN) ||
+               (b == CARD_ENROLL_ALLOWED && c == CARD_ENROLL_REVOKED));
+        // A revoke that reported success must have stuck
+        CHECK(ret != ESP_OK || c == CARD_ENROLL_REVOKED);
+        if (ret == ESP_OK) {
+            break;
+        }
+    }
+    CHECK(cut < MAX_CUT_POINTS);
+    printf("power loss: %d cut points, each left the old or the new list\n", cut - 1);
+}
+
+void app_main(void)
+{
+    test_lookup();
+    test_revoke_full();
+    test_batching();
+    test_power_loss();
+    printf("card_enroll host test passed\n");
+    exit(0);
+}
@@ -0,0 +1,329 @@
+#include "card_provision.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "ndef.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "string.h"
+
+static const char *TAG = "card_provision";
+
+#define USER_START_PAGE        4
+#define MAX_USER_BYTES         888    // NTAG216 user memory, the largest supported card
+#define STATION_POLL_MS        500    // Card detection timeout per station poll
+#define STATION_REMOVE_POLL_MS 200    // Delay while the last card is still on the reader
+
+// Static lock bytes live in bytes 2/3 of page 2
+#define STATIC_LOCK_PAGE 2
+#define CC_PAGE          3
+
+// NTAG21x memory layout; everything after the user area is relative to the dynamic lock page
+typedef struct {
+    uint8_t dyn_lock_page;   // CFG0 = +1, CFG1 = +2, PWD = +3, PACK = +4
+    uint8_t cc_size;         // Data area size byte of the capability container
+} ntag_layout_t;
+
+static bool get_layout(NTAG2XX_MODEL model, ntag_layout_t* layout)
+{
+    switch (model) {
+        case NTAG2XX_NTAG213: *layout = (ntag_layout_t){ .dyn_lock_page = 40,  .cc_size = 0x12 }; return true;
+        case NTAG2XX_NTAG215: *layout = (ntag_layout_t){ .dyn_lock_page = 130, .cc_size = 0x3E }; return true;
+        case NTAG2XX_NTAG216: *layout = (ntag_layout_t){ .dyn_lock_page = 226, .cc_size = 0x6D }; return true;
+        default: return false;
+    }
+}
+
+esp_err_t card_provision_build_uri_tlv(const char* uri, uint8_t* buf, size_t buf_len, size_t* out_len)
+{
+    if (!uri || !buf || !out_len) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t plen;
+    uint8_t code = ndef_uri_prefix_match(uri, &plen);
+    uri += plen;
+
+    // Short record: header, type length, payload length, type 'U', identifier code, URI
+    size_t uri_len = strlen(uri);
+    size_t payload_len = 1 + uri_len;
+    if (payload_len > 255) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    size_t record_len = 4 + payload_len;
+    size_t tlv_header = record_len < 0xFF ? 2 : 4;
+    size_t total = tlv_header + record_len + 1;
+    if (total > buf_len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    size_t idx = 0;
+    buf[idx++] = 0x03;                       // NDEF message TLV
+    if (tlv_header == 2) {
+        buf[idx++] = (uint8_t)record_len;
+    } else {
+        buf[idx++] = 0xFF;
+        buf[idx++] = (uint8_t)(record_len >> 8);
+        buf[idx++] = (uint8_t)record_len;
+    }
+    buf[idx++] = 0xD1;                       // MB | ME | SR, TNF well-known
+    buf[idx++] = 0x01;                       // Type length
+    buf[idx++] = (uint8_t)payload_len;
+    buf[idx++] = 'U';
+    buf[idx++] = code;
+    memcpy(buf + idx, uri, uri_len);
+    idx += uri_len;
+    buf[idx++] = 0xFE;                       // Terminator TLV
+
+    *out_len = idx;
+    return ESP_OK;
+}
+
+// Read back [first, last] in FAST_READ sized chunks and compare with expected
+static esp_err_t verify_pages(pn532_io_handle_t io_handle, uint8_t first, uint8_t last, const uint8_t* expected)
+{
+    uint8_t chunk[NTAG2XX_FAST_READ_MAX_PAGES * 4];
+
+    for (int page = first; page <= last; page += NTAG2XX_FAST_READ_MAX_PAGES) {
+        int end = page + NTAG2XX_FAST_READ_MAX_PAGES - 1;
+        if (end > last) end = last;
+        size_t len = (size_t)(end - page + 1) * 4;
+
+        esp_err_t err = ntag2xx_fast_read(io_handle, page, end, chunk, sizeof(chunk));
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Read-back of pages %d..%d failed: %s", page, end, esp_err_to_name(err));
+            return err;
+        }
+        if (memcmp(chunk, expected + (size_t)(page - first) * 4, len) != 0) {
+            ESP_LOGW(TAG, "Verify mismatch in pages %d..%d", page, end);
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t write_protection(pn532_io_handle_t io_handle, const ntag_layout_t* layout, const card_provision_job_t* job)
+{
+    uint8_t page[4] = {0};
+    uint8_t cfg0 = layout->dyn_lock_page + 1;
+
+    // PWD, PACK and ACCESS only; AUTH0 is set by enable_protection() once every other write,
+    // lock bits included, is done, since pages from AUTH0 on then need PWD_AUTH
+    memcpy(page, job->password, 4);
+    esp_err_t err = ntag2xx_write_page(io_handle, cfg0 + 2, page);
+    if (err != ESP_OK) return err;
+
+    memset(page, 0, sizeof(page));
+    if (job->pack) {
+        memcpy(page, job->pack, 2);
+    }
+    err = ntag2xx_write_page(io_handle, cfg0 + 3, page);
+    if (err != ESP_OK) return err;
+
+    // Keep mirror settings, only touch PROT and AUTH0
+    uint8_t cfg[8];
+    err = ntag2xx_fast_read(io_handle, cfg0, cfg0 + 1, cfg, sizeof(cfg));
+    if (err != ESP_OK) return err;
+
+    cfg[4] &= (uint8_t)~0x80;                // ACCESS.PROT = 0: protect writes only
+    return ntag2xx_write_page(io_handle, cfg0 + 1, cfg + 4);
+}
+
+static esp_err_t enable_protection(pn532_io_handle_t io_handle, const ntag_layout_t* layout)
+{
+    uint8_t cfg0 = layout->dyn_lock_page + 1;
+
+    // Keep mirror settings, only touch AUTH0
+    uint8_t cfg[4];
+    esp_err_t err = ntag2xx_fast_read(io_handle, cfg0, cfg0, cfg, sizeof(cfg));
+    if (err != ESP_OK) return err;
+
+    cfg[3] = USER_START_PAGE;                // AUTH0: protect from the first user page on
+    return ntag2xx_write_page(io_handle, cfg0, cfg);
+}
+
+static esp_err_t lock_card(pn532_io_handle_t io_handle, const ntag_layout_t* layout)
+{
+    // Dynamic lock bits first, the static ones also freeze the capability container.
+    // Byte 3 of the dynamic lock page is RFUI and must stay 0.
+    static const uint8_t dyn_lock[4] = { 0xFF, 0xFF, 0xFF, 0x00 };
+    static const uint8_t static_lock[4] = { 0x00, 0x00, 0xFF, 0xFF };
+
+    esp_err_t err = ntag2xx_write_page(io_handle, layout->dyn_lock_page, dyn_lock);
+    if (err != ESP_OK) return err;
+    return ntag2xx_write_page(io_handle, STATIC_LOCK_PAGE, static_lock);
+}
+
+esp_err_t card_provision_card(pn532_io_handle_t io_handle, NTAG2XX_MODEL model,
+                              const card_provision_job_t* job, card_provision_result_t* result)
+{
+    ntag_layout_t layout;
+    if (!io_handle || !job || !job->tlv || job->tlv_length == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!get_layout(model, &layout)) {
+        ESP_LOGW(TAG, "Unsupported card model %d", model);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    int page_count = (int)((job->tlv_length + 3) / 4);
+    int last_page = USER_START_PAGE + page_count - 1;
+    if (last_page >= layout.dyn_lock_page) {
+        ESP_LOGW(TAG, "%d bytes do not fit the user memory of this card", (int)job->tlv_length);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // Zero-padded image of everything we write to the user area. Static: 888 bytes are too
+    // much for the main task stack, and only one card is provisioned at a time.
+    static uint8_t image[MAX_USER_BYTES];
+    if ((size_t)page_count * 4 > sizeof(image)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memset(image, 0, (size_t)page_count * 4);
+    memcpy(image, job->tlv, job->tlv_length);
+
+    int64_t start_us = esp_timer_get_time();
+    uint16_t pages_written = 0;
+
+    // The capability container is OTP; only program it on blank cards
+    uint8_t cc[4];
+    esp_err_t err = ntag2xx_fast_read(io_handle, CC_PAGE, CC_PAGE, cc, sizeof(cc));
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (cc[0] == 0x00 && cc[1] == 0x00 && cc[2] == 0x00 && cc[3] == 0x00) {
+        const uint8_t new_cc[4] = { 0xE1, 0x10, layout.cc_size, 0x00 };
+        err = ntag2xx_write_page(io_handle, CC_PAGE, new_cc);
+        if (err != ESP_OK) return err;
+        pages_written++;
+    } else if (cc[0] != 0xE1) {
+        ESP_LOGW(TAG, "Card has a foreign capability container (0x%02x), not touching it", cc[0]);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Data pages back to back; a single bulk read-back replaces per-page read-after-write
+    for (int i = 0; i < page_count; i++) {
+        err = ntag2xx_write_page(io_handle, USER_START_PAGE + i, image + i * 4);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Write of page %d failed: %s", USER_START_PAGE + i, esp_err_to_name(err));
+            return err;
+        }
+        pages_written++;
+    }
+
+    int64_t write_done_us = esp_timer_get_time();
+    err = verify_pages(io_handle, USER_START_PAGE, last_page, image);
+    int64_t verify_done_us = esp_timer_get_time();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // Protection and locks only after the content is known good
+    if (job->password) {
+        err = write_protection(io_handle, &layout, job);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to set write protection: %s", esp_err_to_name(err));
+            return err;
+        }
+        pages_written += 3;
+    }
+    if (job->make_read_only) {
+        err = lock_card(io_handle, &layout);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to set lock bits: %s", esp_err_to_name(err));
+            return err;
+        }
+        pages_written += 2;
+    }
+    // AUTH0 last: the dynamic lock page lies above it and can't be written without PWD_AUTH
+    if (job->password) {
+        err = enable_protection(io_handle, &layout);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to enable write protection: %s", esp_err_to_name(err));
+            return err;
+        }
+        pages_written++;
+    }
+
+    int64_t end_us = esp_timer_get_time();
+    if (result) {
+        uint32_t total_us = (uint32_t)(end_us - start_us);
+        result->pages_written = pages_written;
+        result->bytes_verified = (uint16_t)(page_count * 4);
+        result->write_us = (uint32_t)((write_done_us - start_us) + (end_us - verify_done_us));
+        result->verify_us = (uint32_t)(verify_done_us - write_done_us);
+        result->bytes_per_sec = total_us > 0 ? (uint32_t)((uint64_t)pages_written * 4 * 1000000 / total_us) : 0;
+    }
+
+    ESP_LOGI(TAG, "Provisioned %d pages in %lu ms (%lu B/s)", pages_written,
+             (unsigned long)((end_us - start_us) / 1000),
+             result ? (unsigned long)result->bytes_per_sec : 0UL);
+    return ESP_OK;
+}
+
+esp_err_t card_provision_station_run(pn532_io_handle_t io_handle, const card_provision_job_t* job,
+                                     uint32_t card_count, card_provision_card_cb_t cb, void* arg,
+                                     card_provision_station_stats_t* stats)
+{
+    if (!io_handle || !job) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    card_provision_station_stats_t local = {0};
+    uint8_t last_uid[10] = {0};
+    uint8_t last_uid_length = 0;
+    int64_t start_us = esp_timer_get_time();
+
+    ESP_LOGI(TAG, "Enrollment station ready, place the first card");
+
+    while (card_count == 0 || local.cards_ok < card_count) {
+        uint8_t uid[10] = {0};
+        uint8_t uid_length = 0;
+
+        esp_err_t err = pn532_read_passive_target_id(io_handle, PN532_BRTY_ISO14443A_106KBPS, uid, &uid_length, STATION_POLL_MS);
+        if (err != ESP_OK) {
+            // Empty field: the next card may legitimately repeat the previous UID
+            last_uid_length = 0;
+            continue;
+        }
+
+        if (uid_length == last_uid_length && memcmp(uid, last_uid, uid_length) == 0) {
+            vTaskDelay(pdMS_TO_TICKS(STATION_REMOVE_POLL_MS));
+            continue;
+        }
+        memcpy(last_uid, uid, uid_length);
+        last_uid_length = uid_length;
+
+        NTAG2XX_MODEL model = NTAG2XX_UNKNOWN;
+        err = ntag2xx_get_model(io_handle, &model);
+
+        card_provision_result_t result = {0};
+        if (err == ESP_OK) {
+            err = card_provision_card(io_handle, model, job, &result);
+        }
+
+        if (err == ESP_OK) {
+            local.cards_ok++;
+            local.bytes_written += result.pages_written * 4;
+        } else {
+            // The UID stays latched: a half-written card is not written again until it
+            // has left the field, so taking it off and putting it back is the retry
+            local.cards_failed++;
+        }
+        local.elapsed_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+
+        ESP_LOGI(TAG, "Card %lu: %s (%lu ok, %lu failed, %lu cards/min)",
+                 (unsigned long)(local.cards_ok + local.cards_failed),
+                 err == ESP_OK ? "OK" : esp_err_to_name(err),
+                 (unsigned long)local.cards_ok, (unsigned long)local.cards_failed,
+                 local.elapsed_ms > 0 ? (unsigned long)((uint64_t)local.cards_ok * 60000 / local.elapsed_ms) : 0UL);
+
+        if (cb) {
+            cb(uid, uid_length, err, arg);
+        }
+        if (stats) {
+            *stats = local;
+        }
+    }
+
+    return ESP_OK;
+}
@@ -0,0 +1,91 @@
+#ifndef CARD_PROVISION_H
+#define CARD_PROVISION_H
+
+#include "esp_err.h"
+#include "pn532.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// What to put on each card
+typedef struct {
+    const uint8_t* tlv;        // TLV area written from page 4 (NDEF TLV + terminator)
+    size_t tlv_length;
+    const uint8_t* password;   // 4-byte PWD; if set, user memory becomes write-protected (NULL = none)
+    const uint8_t* pack;       // 2-byte PACK returned on successful PWD_AUTH (NULL = 0x0000)
+    bool make_read_only;       // Set static and dynamic lock bits. PERMANENT!
+} card_provision_job_t;
+
+typedef struct {
+    uint16_t pages_written;
+    uint16_t bytes_verified;
+    uint32_t write_us;         // Time spent writing data, lock and config pages
+    uint32_t verify_us;        // Time spent on the bulk read-back
+    uint32_t bytes_per_sec;    // Effective write + verify throughput
+} card_provision_result_t;
+
+typedef struct {
+    uint32_t cards_ok;
+    uint32_t cards_failed;
+    uint32_t bytes_written;
+    uint32_t elapsed_ms;
+} card_provision_station_stats_t;
+
+/**
+ * @brief Called after each card processed by the enrollment station
+ * @param uid Card UID
+ * @param uid_length UID length in bytes
+ * @param result ESP_OK if the card was written and verified
+ * @param arg User argument
+ */
+typedef void (*card_provision_card_cb_t)(const uint8_t* uid, uint8_t uid_length, esp_err_t result, void* arg);
+
+/**
+ * @brief Build an NDEF TLV holding a single URI record
+ * @param uri URI text; a known scheme prefix is abbreviated to its URI identifier code
+ * @param buf Output buffer
+ * @param buf_len Size of output buffer
+ * @param out_len Receives the number of bytes written (TLV + terminator)
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if the buffer is too small
+ */
+esp_err_t card_provision_build_uri_tlv(const char* uri, uint8_t* buf, size_t buf_len, size_t* out_len);
+
+/**
+ * @brief Write, lock/configure and verify the currently selected NTAG21x card
+ * @param io_handle PN532 io handle
+ * @param model Card model (from ntag2xx_get_model)
+ * @param job What to write
+ * @param result Receives timing and throughput (may be NULL)
+ * @return ESP_OK if all pages were written and the read-back matched
+ */
+esp_err_t card_provision_card(pn532_io_handle_t io_handle, NTAG2XX_MODEL model,
+                              const card_provision_job_t* job, card_provision_result_t* result);
+
+/**
+ * @brief Enrollment station: provision a stack of cards back to back
+ *
+ * Each new card placed on the reader is identified, written and verified. A card left
+ * on the reader is only processed once, whether it succeeded or failed; remove it and place
+ * the next one (or place a failed card again to retry it).
+ *
+ * @param io_handle PN532 io handle
+ * @param job What to write on every card
+ * @param card_count Stop after this many successful cards (0 = run forever)
+ * @param cb Per-card callback (may be NULL)
+ * @param arg Argument for cb
+ * @param stats Receives batch statistics (may be NULL)
+ * @return ESP_OK when card_count cards were provisioned
+ */
+esp_err_t card_provision_station_run(pn532_io_handle_t io_handle, const card_provision_job_t* job,
+                                     uint32_t card_count, card_provision_card_cb_t cb, void* arg,
+                                     card_provision_station_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CARD_PROVISION_H
@@ -0,0 +1,132 @@
+#include "classic_reader.h"
+#include "card_cache.h"
+#include "esp_log.h"
+#include "string.h"
+
+static const char *TAG = "classic_reader";
+
+bool classic_reader_is_classic(uint8_t sak)
+{
+    return sak == CLASSIC_READER_SAK_MINI || sak == CLASSIC_READER_SAK_1K || sak == CLASSIC_READER_SAK_4K;
+}
+
+uint8_t classic_reader_block_to_sector(uint8_t block)
+{
+    // 4K cards have 32 sectors of 4 blocks followed by 8 sectors of 16 blocks
+    if (block < 128) {
+        return block / 4;
+    }
+    return 32 + (block - 128) / 16;
+}
+
+// Try one key; on rejection the card is halted, so bring it back for the next attempt
+static esp_err_t try_key(pn532_io_handle_t io_handle, const uint8_t* uid, uint8_t uid_length,
+                         uint8_t block, bool key_b, const uint8_t* key)
+{
+    esp_err_t err = mifareclassic_authenticate_block(io_handle, uid, uid_length, block,
+                                                     key_b ? MIFARE_CMD_AUTH_B : MIFARE_CMD_AUTH_A, key);
+    if (err != ESP_OK) {
+        esp_err_t sel = pn532_in_list_passive_target(io_handle);
+        if (sel != ESP_OK) {
+            ESP_LOGW(TAG, "⚠️ Card lost while re-selecting after a rejected key");
+            return sel;
+        }
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+static void remember_key(const uint8_t* uid, uint8_t uid_length, uint8_t sak, uint8_t sector,
+                         uint8_t key_index, bool key_b)
+{
+    if (sector >= CARD_CACHE_CLASSIC_SECTORS || uid_length > CARD_CACHE_MAX_UID_LENGTH) {
+        return;
+    }
+
+    card_cache_entry_t entry;
+    if (!card_cache_lookup(uid, uid_length, 0, &entry)) {
+        memset(&entry, 0, sizeof(entry));
+        memcpy(entry.uid, uid, uid_length);
+        entry.uid_length = uid_length;
+        entry.model = NTAG2XX_UNKNOWN;
+    }
+    entry.sak = sak;
+    entry.sector_keys[sector] = (uint8_t)((key_index + 1) | (key_b ? CARD_CACHE_KEY_B : 0));
+    card_cache_store(&entry);
+}
+
+esp_err_t classic_reader_read_block(pn532_io_handle_t io_handle, const uint8_t* uid, uint8_t uid_length,
+                                    uint8_t sak, uint8_t block,
+                                    const uint8_t (*keys)[CLASSIC_READER_KEY_LENGTH], size_t key_count,
+                                    uint8_t* data, classic_reader_result_t* result)
+{
+    if (!io_handle || !uid || uid_length < 4 || !keys || key_count == 0 ||
+        key_count > CLASSIC_READER_MAX_KEYS || !data) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t sector = classic_reader_block_to_sector(block);
+    classic_reader_result_t res = {0};
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+
+    // First attempt: the key remembered for this card and sector
+    int hint_index = -1;
+    bool hint_b = false;
+    card_cache_entry_t cached;
+    if (sector < CARD_CACHE_CLASSIC_SECTORS && card_cache_lookup(uid, uid_length, 0, &cached)) {
+        uint8_t slot = cached.sector_keys[sector];
+        if (slot != 0 && (size_t)(slot & CARD_CACHE_KEY_INDEX_MASK) <= key_count) {
+            hint_index = (slot & CARD_CACHE_KEY_INDEX_MASK) - 1;
+            hint_b = (slot & CARD_CACHE_KEY_B) != 0;
+            res.attempts++;
+            err = try_key(io_handle, uid, uid_length, block, hint_b, keys[hint_index]);
+            if (err == ESP_OK) {
+                res.key_index = (uint8_t)hint_index;
+                res.key_b = hint_b;
+                res.from_cache = true;
+            } else if (err != ESP_ERR_NOT_FOUND) {
+                return err;
+            } else {
+                ESP_LOGI(TAG, "Cached key for sector %d no longer valid", sector);
+            }
+        }
+    }
+
+    // Walk the dictionary: every key A first, then every key B
+    for (int pass = 0; err == ESP_ERR_NOT_FOUND && pass < 2; pass++) {
+        bool key_b = pass == 1;
+        for (size_t i = 0; i < key_count; i++) {
+            if ((int)i == hint_index && key_b == hint_b) {
+                continue;
+            }
+            res.attempts++;
+            err = try_key(io_handle, uid, uid_length, block, key_b, keys[i]);
+            if (err == ESP_OK) {
+                res.key_index = (uint8_t)i;
+                res.key_b = key_b;
+                break;
+            }
+            if (err != ESP_ERR_NOT_FOUND) {
+                return err;
+            }
+        }
+    }
+
+    if (result) {
+        *result = res;
+    }
+
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "❌ No key in the dictionary opens sector %d (%d attempts)", sector, res.attempts);
+        return err;
+    }
+
+    ESP_LOGI(TAG, "🔑 Sector %d opened with key %c #%d after %d attempt(s)%s", sector,
+             res.key_b ? 'B' : 'A', res.key_index, res.attempts, res.from_cache ? " (cached)" : "");
+
+    if (!res.from_cache) {
+        remember_key(uid, uid_length, sak, sector, res.key_index, res.key_b);
+    }
+
+    return mifareclassic_read_block(io_handle, block, data);
+}
@@ -0,0 +1,72 @@
+#ifndef CLASSIC_READER_H
+#define CLASSIC_READER_H
+
+#include "esp_err.h"
+#include "pn532.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CLASSIC_READER_KEY_LENGTH  6
+#define CLASSIC_READER_BLOCK_SIZE  16
+#define CLASSIC_READER_MAX_KEYS    127   // Limited by the card cache key slot encoding
+
+// SEL_RES values of the Mifare Classic family
+#define CLASSIC_READER_SAK_MINI    0x09
+#define CLASSIC_READER_SAK_1K      0x08
+#define CLASSIC_READER_SAK_4K      0x18
+
+// Outcome of a block read, for logging and tuning the key dictionary
+typedef struct {
+    uint8_t attempts;         // Authentication attempts made (1 = first key worked)
+    uint8_t key_index;        // Dictionary index of the key that opened the sector
+    bool key_b;               // true if key B opened the sector
+    bool from_cache;          // true if the key came from the per-UID cache
+} classic_reader_result_t;
+
+/**
+ * @brief Check whether a SEL_RES belongs to a Mifare Classic card
+ * @param sak SEL_RES reported during anticollision
+ * @return true for Classic Mini/1K/4K
+ */
+bool classic_reader_is_classic(uint8_t sak);
+
+/**
+ * @brief Get the sector that holds a block (handles the 4K large sectors)
+ * @param block Absolute block number
+ * @return Sector number
+ */
+uint8_t classic_reader_block_to_sector(uint8_t block);
+
+/**
+ * @brief Authenticate the sector of a block and read it
+ *
+ * The key that opened the sector on a previous tap is tried first; the dictionary is
+ * only walked (all key A, then all key B) when that fails. The card is re-selected
+ * after each rejected key. The winning key is remembered in the card cache.
+ *
+ * @param io_handle PN532 io handle, card already selected by pn532_read_passive_target_id()
+ * @param uid Card UID
+ * @param uid_length UID length in bytes
+ * @param sak SEL_RES of the card
+ * @param block Absolute block number to read
+ * @param keys Key dictionary
+ * @param key_count Number of keys in the dictionary (at most CLASSIC_READER_MAX_KEYS)
+ * @param data Receives CLASSIC_READER_BLOCK_SIZE bytes
+ * @param result Receives attempt statistics (may be NULL)
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if no key opened the sector
+ */
+esp_err_t classic_reader_read_block(pn532_io_handle_t io_handle, const uint8_t* uid, uint8_t uid_length,
+                                    uint8_t sak, uint8_t block,
+                                    const uint8_t (*keys)[CLASSIC_READER_KEY_LENGTH], size_t key_count,
+                                    uint8_t* data, classic_reader_result_t* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLASSIC_READER_H
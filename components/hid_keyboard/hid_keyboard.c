@@ -33,29 +33,49 @@ static const uint8_t desc_configuration_fs[] = {
 
 // Track USB mount state
 static volatile bool s_usb_mounted = false;
+static volatile uint8_t s_leds = 0;
+static hid_keyboard_usb_cb_t s_usb_cb = NULL;
+static void* s_usb_cb_arg = NULL;
+
+static void notify_usb(hid_keyboard_usb_event_t event)
+{
+    if (s_usb_cb) {
+        s_usb_cb(event, s_usb_cb_arg);
+    }
+}
+
+void hid_keyboard_set_usb_callback(hid_keyboard_usb_cb_t cb, void* arg)
+{
+    s_usb_cb_arg = arg;
+    s_usb_cb = cb;
+}
 
 // TinyUSB device callbacks for connection state
 void tud_mount_cb(void)
 {
     s_usb_mounted = true;
     ESP_LOGI(TAG, "USB mounted");
+    notify_usb(HID_KEYBOARD_USB_MOUNTED);
 }
 
 void tud_umount_cb(void)
 {
     s_usb_mounted = false;
     ESP_LOGW(TAG, "USB unmounted");
+    notify_usb(HID_KEYBOARD_USB_UNMOUNTED);
 }
 
 void tud_suspend_cb(bool remote_wakeup_en)
 {
     (void)remote_wakeup_en;
     ESP_LOGW(TAG, "USB suspended");
+    notify_usb(HID_KEYBOARD_USB_SUSPENDED);
 }
 
 void tud_resume_cb(void)
 {
     ESP_LOGI(TAG, "USB resumed");
+    notify_usb(HID_KEYBOARD_USB_RESUMED);
 }
 
 static bool hid_wait_ready(uint32_t timeout_ms)
@@ -87,13 +107,21 @@ uint16_t tud_hid_get_report_cb(uint8_t instance, uint8_t report_id, hid_report_t
     return 0;
 }
 
+// The host's keyboard driver writes the LED output report once it has taken over the device
 void tud_hid_set_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type, uint8_t const* buffer, uint16_t bufsize)
 {
     (void) instance;
     (void) report_id;
-    (void) report_type;
-    (void) buffer;
-    (void) bufsize;
+    if (report_type == HID_REPORT_TYPE_OUTPUT && bufsize >= 1) {
+        s_leds = buffer[0];
+        ESP_LOGD(TAG, "LED report 0x%02x", s_leds);
+        notify_usb(HID_KEYBOARD_USB_LEDS);
+    }
+}
+
+uint8_t hid_keyboard_get_leds(void)
+{
+    return s_leds;
 }
 
 // TAG moved to top so TinyUSB callbacks can log
@@ -2,11 +2,25 @@
 #define HID_KEYBOARD_H
 
 #include "esp_err.h"
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+typedef enum {
+    HID_KEYBOARD_USB_MOUNTED,
+    HID_KEYBOARD_USB_UNMOUNTED,
+    HID_KEYBOARD_USB_SUSPENDED,
+    HID_KEYBOARD_USB_RESUMED,
+    HID_KEYBOARD_USB_LEDS,      // Host wrote the keyboard LED report (NumLock, CapsLock, ...)
+} hid_keyboard_usb_event_t;
+
+/**
+ * @brief USB state callback, called from the TinyUSB task; keep it short
+ */
+typedef void (*hid_keyboard_usb_cb_t)(hid_keyboard_usb_event_t event, void* arg);
+
 /**
  * @brief Initialize HID keyboard
  * @return ESP_OK on success
@@ -46,6 +60,19 @@ esp_err_t hid_keyboard_press_tab(void);
  */
 esp_err_t hid_keyboard_press_escape(void);
 
+/**
+ * @brief Last keyboard LED state written by the host
+ * @return LED bits (bit 0 NumLock, bit 1 CapsLock, bit 2 ScrollLock)
+ */
+uint8_t hid_keyboard_get_leds(void);
+
+/**
+ * @brief Register a callback for USB mount/suspend changes and LED reports
+ * @param cb Callback, NULL to remove
+ * @param arg User argument
+ */
+void hid_keyboard_set_usb_callback(hid_keyboard_usb_cb_t cb, void* arg);
+
 #ifdef __cplusplus
 }
 #endif
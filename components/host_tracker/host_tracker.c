@@ -0,0 +1,207 @@
+#include "host_tracker.h"
+#include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "string.h"
+
+static const char *TAG = "host_tracker";
+
+// The task wakes this often to look at passive traffic between probes
+#define TRACKER_TICK_MS 1000
+#define ARP_TIMEOUT_MS 200
+#define TCP_TIMEOUT_MS 500
+
+typedef struct {
+    host_tracker_host_t host;
+    host_state_t state;
+    int64_t updated_us;
+    int64_t last_seen_us;       // Passive timestamp already accounted for
+} tracked_host_t;
+
+static tracked_host_t s_hosts[HOST_TRACKER_MAX_HOSTS];
+static size_t s_count = 0;
+static host_tracker_config_t s_config;
+static SemaphoreHandle_t s_lock = NULL;
+static TaskHandle_t s_task = NULL;
+static volatile int64_t s_last_activity_us = 0;
+static int64_t s_next_probe_us = 0;         // Under s_lock; 0 = probe as soon as possible
+
+static void set_state(size_t index, host_state_t state, const char* why)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    tracked_host_t* h = &s_hosts[index];
+    host_state_t old = h->state;
+    h->state = state;
+    h->updated_us = esp_timer_get_time();
+    xSemaphoreGive(s_lock);
+
+    if (old != state) {
+        ESP_LOGI(TAG, "PC %u (%s): %s → %s (%s)", (unsigned)index, h->host.ip, host_state_name(old),
+                 host_state_name(state), why);
+    }
+}
+
+static void schedule_probe(int64_t next_probe_us)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_next_probe_us = next_probe_us;
+    xSemaphoreGive(s_lock);
+}
+
+static bool network_up(void)
+{
+    esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    esp_netif_ip_info_t ip_info;
+    return netif && esp_netif_get_ip_info(netif, &ip_info) == ESP_OK && ip_info.ip.addr != 0;
+}
+
+// ARP first (cheap, local subnet only), TCP ports to tell booting from up
+static host_state_t probe(const tracked_host_t* h)
+{
+    wol_presence_t presence = wol_check_host_arp(h->host.wol, ARP_TIMEOUT_MS);
+    if (presence == WOL_PRESENCE_DOWN) {
+        return HOST_STATE_OFF;
+    }
+    if (wol_check_host_reachable(h->host.ip, TCP_TIMEOUT_MS)) {
+        return HOST_STATE_UP;
+    }
+    return presence == WOL_PRESENCE_UP ? HOST_STATE_BOOTING : HOST_STATE_OFF;
+}
+
+static uint32_t probe_interval_ms(uint32_t current_ms)
+{
+    int64_t idle_ms = (esp_timer_get_time() - s_last_activity_us) / 1000;
+    if (idle_ms < s_config.idle_after_ms) {
+        return s_config.min_interval_ms;
+    }
+    uint32_t next = current_ms * 2;
+    return next > s_config.max_interval_ms ? s_config.max_interval_ms : next;
+}
+
+static void tracker_task(void* arg)
+{
+    uint32_t interval_ms = s_config.min_interval_ms;
+    int64_t next_probe_us = 0;
+
+    while (1) {
+        int64_t now = esp_timer_get_time();
+
+        if (!network_up()) {
+            for (size_t i = 0; i < s_count; i++) {
+                if (s_hosts[i].state != HOST_STATE_UNKNOWN) {
+                    set_state(i, HOST_STATE_UNKNOWN, "no network");
+                }
+            }
+            next_probe_us = 0;
+            schedule_probe(next_probe_us);
+            vTaskDelay(pdMS_TO_TICKS(TRACKER_TICK_MS));
+            continue;
+        }
+
+        // Traffic from a PC we think is off: it is waking up, look closer right away
+        for (size_t i = 0; i < s_count; i++) {
+            int64_t seen = wol_presence_last_seen_us(s_hosts[i].host.wol);
+            if (seen > s_hosts[i].last_seen_us) {
+                s_hosts[i].last_seen_us = seen;
+                if (s_hosts[i].state == HOST_STATE_OFF || s_hosts[i].state == HOST_STATE_UNKNOWN) {
+                    set_state(i, HOST_STATE_BOOTING, "traffic seen");
+                    next_probe_us = 0;
+                    schedule_probe(next_probe_us);
+                } else if (s_hosts[i].state == HOST_STATE_UP) {
+                    set_state(i, HOST_STATE_UP, "traffic seen");
+                }
+            }
+        }
+
+        if (now >= next_probe_us) {
+            for (size_t i = 0; i < s_count; i++) {
+                set_state(i, probe(&s_hosts[i]), "probe");
+            }
+            interval_ms = probe_interval_ms(interval_ms);
+            next_probe_us = esp_timer_get_time() + (int64_t)interval_ms * 1000;
+            schedule_probe(next_probe_us);
+        }
+
+        // host_tracker_poke() cuts the wait short
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(TRACKER_TICK_MS));
+        if (s_last_activity_us > now && interval_ms > s_config.min_interval_ms) {
+            interval_ms = s_config.min_interval_ms;
+            next_probe_us = 0;
+            schedule_probe(next_probe_us);
+        }
+    }
+}
+
+esp_err_t host_tracker_init(const host_tracker_host_t* hosts, size_t count, const host_tracker_config_t* config)
+{
+    if (!hosts || !config || count == 0 || count > HOST_TRACKER_MAX_HOSTS ||
+        config->min_interval_ms == 0 || config->max_interval_ms < config->min_interval_ms) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_lock = xSemaphoreCreateMutex();
+    if (!s_lock) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_config = *config;
+    s_count = count;
+    for (size_t i = 0; i < count; i++) {
+        memset(&s_hosts[i], 0, sizeof(s_hosts[i]));
+        s_hosts[i].host = hosts[i];
+        if (wol_presence_track(hosts[i].wol) != ESP_OK) {
+            ESP_LOGW(TAG, "Passive tracking unavailable for %s", hosts[i].ip);
+        }
+    }
+    s_last_activity_us = esp_timer_get_time();
+
+    if (xTaskCreate(tracker_task, "host_tracker", 3072, NULL, 2, &s_task) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+host_state_t host_tracker_get(size_t index, uint32_t margin_ms)
+{
+    if (!s_lock || index >= s_count) {
+        return HOST_STATE_UNKNOWN;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    host_state_t state = s_hosts[index].state;
+    // A state holds until the probe that would replace it, however far the back-off has
+    // pushed that out; a pending re-probe (0) leaves just the margin after the last update
+    int64_t fresh_until_us = s_hosts[index].updated_us > s_next_probe_us ? s_hosts[index].updated_us : s_next_probe_us;
+    xSemaphoreGive(s_lock);
+    return esp_timer_get_time() > fresh_until_us + (int64_t)margin_ms * 1000 ? HOST_STATE_UNKNOWN : state;
+}
+
+void host_tracker_set(size_t index, host_state_t state)
+{
+    if (s_lock && index < s_count) {
+        set_state(index, state, "login");
+    }
+}
+
+void host_tracker_poke(void)
+{
+    s_last_activity_us = esp_timer_get_time();
+    if (s_task) {
+        xTaskNotifyGive(s_task);
+    }
+}
+
+const char* host_state_name(host_state_t state)
+{
+    switch (state) {
+        case HOST_STATE_UNKNOWN: return "unknown";
+        case HOST_STATE_OFF:     return "off";
+        case HOST_STATE_BOOTING: return "booting";
+        case HOST_STATE_UP:      return "up";
+    }
+    return "?";
+}
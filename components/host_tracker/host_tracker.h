@@ -0,0 +1,73 @@
+#ifndef HOST_TRACKER_H
+#define HOST_TRACKER_H
+
+#include "esp_err.h"
+#include "wol_client.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HOST_TRACKER_MAX_HOSTS WOL_PRESENCE_MAX_TRACKED
+
+typedef enum {
+    HOST_STATE_UNKNOWN,         // Never probed, stale, or no network
+    HOST_STATE_OFF,
+    HOST_STATE_BOOTING,         // NIC is up (ARP or traffic) but no Windows port answers yet
+    HOST_STATE_UP,              // A Windows port answers
+} host_state_t;
+
+typedef struct {
+    wol_context_t* wol;         // MAC and IP; the tracker never sends with it
+    const char* ip;
+} host_tracker_host_t;
+
+typedef struct {
+    uint32_t min_interval_ms;   // Probe period right after activity
+    uint32_t max_interval_ms;   // Probe period once idle; doubles from min to max
+    uint32_t idle_after_ms;     // No activity for this long starts the back-off
+} host_tracker_config_t;
+
+/**
+ * @brief Start the tracker task
+ * @param hosts PCs to track (copied)
+ * @param count Number of PCs (at most HOST_TRACKER_MAX_HOSTS)
+ * @param config Probe timing
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NO_MEM
+ */
+esp_err_t host_tracker_init(const host_tracker_host_t* hosts, size_t count, const host_tracker_config_t* config);
+
+/**
+ * @brief Cached state of a PC, without blocking
+ * @param index Index into the hosts passed to host_tracker_init()
+ * @param margin_ms Grace period after the next scheduled probe is due; a state the tracker
+ *                  has not refreshed by then reads as HOST_STATE_UNKNOWN
+ * @return Host state
+ */
+host_state_t host_tracker_get(size_t index, uint32_t max_age_ms);
+
+/**
+ * @brief Record a state learned elsewhere (e.g. by the login flow)
+ * @param index Host index
+ * @param state New state
+ */
+void host_tracker_set(size_t index, host_state_t state);
+
+/**
+ * @brief Someone is around (card tap, USB activity): probe at the fastest rate again
+ */
+void host_tracker_poke(void);
+
+/**
+ * @brief Short name of a state for logs
+ */
+const char* host_state_name(host_state_t state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_TRACKER_H
@@ -0,0 +1,202 @@
+#include "login_trace.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "string.h"
+#include <stdio.h>
+
+static const char *TAG = "login_trace";
+
+// Reader task and login worker both write records
+static SemaphoreHandle_t s_lock = NULL;
+static login_trace_record_t s_ring[LOGIN_TRACE_RING_LEN];
+static uint32_t s_next_id = 1;
+static uint32_t s_deadline_ms[LOGIN_TRACE_STAGE_COUNT];
+
+static const char* const s_stage_names[LOGIN_TRACE_STAGE_COUNT] = {
+    [LOGIN_TRACE_DETECT]     = "detect",
+    [LOGIN_TRACE_CARD_READ]  = "read",
+    [LOGIN_TRACE_AUTH]       = "auth",
+    [LOGIN_TRACE_QUEUE]      = "queue",
+    [LOGIN_TRACE_WIFI_CHECK] = "wifi",
+    [LOGIN_TRACE_HOST_PROBE] = "probe",
+    [LOGIN_TRACE_WOL_SEND]   = "wol",
+    [LOGIN_TRACE_WAKE_WAIT]  = "wake",
+    [LOGIN_TRACE_BOOT_WAIT]  = "boot_wait",
+    [LOGIN_TRACE_HID_TYPE]   = "hid",
+    [LOGIN_TRACE_TOTAL]      = "total",
+};
+
+static bool lock(void)
+{
+    if (!s_lock) {
+        return false;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    return true;
+}
+
+static void unlock(void)
+{
+    xSemaphoreGive(s_lock);
+}
+
+// Caller holds the lock; NULL for ids whose slot has been reused
+static login_trace_record_t* find(uint32_t id)
+{
+    login_trace_record_t* record = &s_ring[id % LOGIN_TRACE_RING_LEN];
+    return (id != 0 && record->id == id) ? record : NULL;
+}
+
+static void add_stage(login_trace_record_t* record, login_trace_stage_t stage, uint32_t elapsed_us)
+{
+    uint32_t before = record->stage_us[stage];
+    record->stage_us[stage] = before + elapsed_us;
+    record->stage_mask |= 1u << stage;
+
+    // Warn once, when the stage crosses its deadline
+    uint32_t deadline_us = s_deadline_ms[stage] * 1000;
+    if (deadline_us && before <= deadline_us && record->stage_us[stage] > deadline_us) {
+        ESP_LOGW(TAG, "⏱️ Trace #%lu: %s took %lu ms (deadline %lu ms)", (unsigned long)record->id,
+                 s_stage_names[stage], (unsigned long)(record->stage_us[stage] / 1000),
+                 (unsigned long)s_deadline_ms[stage]);
+    }
+}
+
+esp_err_t login_trace_init(void)
+{
+    if (s_lock) {
+        return ESP_OK;
+    }
+    s_lock = xSemaphoreCreateMutex();
+    return s_lock ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+uint32_t login_trace_start(int64_t start_us)
+{
+    if (!lock()) {
+        return 0;
+    }
+    uint32_t id = s_next_id++;
+    if (s_next_id == 0) {
+        s_next_id = 1;
+    }
+    login_trace_record_t* record = &s_ring[id % LOGIN_TRACE_RING_LEN];
+    memset(record, 0, sizeof(*record));
+    record->id = id;
+    record->start_us = start_us ? start_us : esp_timer_get_time();
+    record->last_mark_us = record->start_us;
+    unlock();
+    return id;
+}
+
+void login_trace_mark(uint32_t id, login_trace_stage_t stage)
+{
+    if (stage >= LOGIN_TRACE_TOTAL || !lock()) {
+        return;
+    }
+    login_trace_record_t* record = find(id);
+    if (record && !record->finished) {
+        int64_t now = esp_timer_get_time();
+        add_stage(record, stage, (uint32_t)(now - record->last_mark_us));
+        record->last_mark_us = now;
+    }
+    unlock();
+}
+
+void login_trace_finish(uint32_t id, esp_err_t result)
+{
+    if (!lock()) {
+        return;
+    }
+    login_trace_record_t* record = find(id);
+    if (!record || record->finished) {
+        unlock();
+        return;
+    }
+    add_stage(record, LOGIN_TRACE_TOTAL, (uint32_t)(esp_timer_get_time() - record->start_us));
+    record->finished = true;
+    record->result = result;
+
+    char line[192];
+    int len = 0;
+    for (int stage = 0; stage < LOGIN_TRACE_STAGE_COUNT && len < (int)sizeof(line); stage++) {
+        if (record->stage_mask & (1u << stage)) {
+            len += snprintf(line + len, sizeof(line) - len, " %s=%lu", s_stage_names[stage],
+                            (unsigned long)(record->stage_us[stage] / 1000));
+        }
+    }
+    ESP_LOGI(TAG, "Trace #%lu (%s) ms:%s", (unsigned long)id, esp_err_to_name(result), line);
+    unlock();
+}
+
+void login_trace_set_deadline(login_trace_stage_t stage, uint32_t deadline_ms)
+{
+    if (stage < LOGIN_TRACE_STAGE_COUNT) {
+        s_deadline_ms[stage] = deadline_ms;
+    }
+}
+
+// Nearest-rank percentile of a sorted array
+static uint32_t percentile(const uint32_t* sorted, uint32_t count, uint32_t pct)
+{
+    uint32_t rank = (pct * count + 99) / 100;
+    return sorted[rank ? rank - 1 : 0];
+}
+
+esp_err_t login_trace_get_stats(login_trace_stage_t stage, login_trace_stats_t* stats)
+{
+    if (stage >= LOGIN_TRACE_STAGE_COUNT || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!lock()) {
+        return ESP_ERR_NO_MEM;
+    }
+    uint32_t samples[LOGIN_TRACE_RING_LEN];
+    uint32_t count = 0;
+    for (int i = 0; i < LOGIN_TRACE_RING_LEN; i++) {
+        const login_trace_record_t* record = &s_ring[i];
+        if (record->id && record->finished && (record->stage_mask & (1u << stage))) {
+            // Insertion sort; the ring is small
+            uint32_t value = record->stage_us[stage];
+            uint32_t j = count++;
+            while (j > 0 && samples[j - 1] > value) {
+                samples[j] = samples[j - 1];
+                j--;
+            }
+            samples[j] = value;
+        }
+    }
+    unlock();
+
+    if (count == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    stats->count = count;
+    stats->p50_us = percentile(samples, count, 50);
+    stats->p95_us = percentile(samples, count, 95);
+    stats->p99_us = percentile(samples, count, 99);
+    stats->max_us = samples[count - 1];
+    return ESP_OK;
+}
+
+void login_trace_log_summary(void)
+{
+    ESP_LOGI(TAG, "📊 Stage latency over the last %d taps (ms):", LOGIN_TRACE_RING_LEN);
+    for (int stage = 0; stage < LOGIN_TRACE_STAGE_COUNT; stage++) {
+        login_trace_stats_t stats;
+        if (login_trace_get_stats((login_trace_stage_t)stage, &stats) != ESP_OK) {
+            continue;
+        }
+        ESP_LOGI(TAG, "   %-9s n=%-3lu p50=%-6lu p95=%-6lu p99=%-6lu max=%lu", s_stage_names[stage],
+                 (unsigned long)stats.count, (unsigned long)(stats.p50_us / 1000),
+                 (unsigned long)(stats.p95_us / 1000), (unsigned long)(stats.p99_us / 1000),
+                 (unsigned long)(stats.max_us / 1000));
+    }
+}
+
+const char* login_trace_stage_name(login_trace_stage_t stage)
+{
+    return stage < LOGIN_TRACE_STAGE_COUNT ? s_stage_names[stage] : "?";
+}
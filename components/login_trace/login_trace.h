@@ -0,0 +1,110 @@
+#ifndef LOGIN_TRACE_H
+#define LOGIN_TRACE_H
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOGIN_TRACE_RING_LEN 32
+
+// Stages of one tap, in the order they normally happen
+typedef enum {
+    LOGIN_TRACE_DETECT,         // Reader poll that found the card
+    LOGIN_TRACE_CARD_READ,      // Identification and page/sector reads
+    LOGIN_TRACE_AUTH,           // Allowlist lookups
+    LOGIN_TRACE_QUEUE,          // Tap event to login worker start
+    LOGIN_TRACE_WIFI_CHECK,
+    LOGIN_TRACE_HOST_PROBE,     // wol_check_host_reachable() calls
+    LOGIN_TRACE_WOL_SEND,
+    LOGIN_TRACE_WAKE_WAIT,      // Listening for the PC's first frame after WoL
+    LOGIN_TRACE_BOOT_WAIT,      // Waiting for the readiness classifier to see Windows up
+    LOGIN_TRACE_HID_TYPE,       // Focus key, password and Enter
+    LOGIN_TRACE_TOTAL,          // Start to finish; set by login_trace_finish()
+    LOGIN_TRACE_STAGE_COUNT,
+} login_trace_stage_t;
+
+// One tap. Times are microseconds from esp_timer_get_time(); stages that ran more than
+// once (WoL retries, repeated probes) accumulate.
+typedef struct {
+    uint32_t id;
+    int64_t start_us;
+    int64_t last_mark_us;
+    uint32_t stage_us[LOGIN_TRACE_STAGE_COUNT];
+    uint16_t stage_mask;        // Bit per stage that was marked
+    bool finished;
+    esp_err_t result;
+} login_trace_record_t;
+
+typedef struct {
+    uint32_t count;             // Finished records that include the stage
+    uint32_t p50_us;
+    uint32_t p95_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+} login_trace_stats_t;
+
+/**
+ * @brief Initialize the trace ring; until then all calls are no-ops
+ * @return ESP_OK, ESP_ERR_NO_MEM
+ */
+esp_err_t login_trace_init(void);
+
+/**
+ * @brief Open a trace record for a new tap
+ * @param start_us Start time (esp_timer_get_time()); 0 for now
+ * @return Trace id, 0 if tracing is not initialized
+ */
+uint32_t login_trace_start(int64_t start_us);
+
+/**
+ * @brief End a stage: the time since the previous mark (or the start) is added to it
+ *
+ * Logs a warning when the stage exceeds its deadline. Unknown or recycled ids are ignored,
+ * so callers can pass 0 when there is no trace.
+ *
+ * @param id Trace id
+ * @param stage Stage that just ended
+ */
+void login_trace_mark(uint32_t id, login_trace_stage_t stage);
+
+/**
+ * @brief Close a record, log its breakdown and make it count for the statistics
+ * @param id Trace id
+ * @param result Outcome of the tap
+ */
+void login_trace_finish(uint32_t id, esp_err_t result);
+
+/**
+ * @brief Warn when a stage takes longer than this
+ * @param stage Stage
+ * @param deadline_ms Deadline in milliseconds (0 = none)
+ */
+void login_trace_set_deadline(login_trace_stage_t stage, uint32_t deadline_ms);
+
+/**
+ * @brief Percentiles of one stage over the finished records in the ring
+ * @param stage Stage
+ * @param stats Output statistics
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if no record includes the stage
+ */
+esp_err_t login_trace_get_stats(login_trace_stage_t stage, login_trace_stats_t* stats);
+
+/**
+ * @brief Log p50/p95/p99/max of every stage
+ */
+void login_trace_log_summary(void);
+
+/**
+ * @brief Short name of a stage for logs
+ */
+const char* login_trace_stage_name(login_trace_stage_t stage);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOGIN_TRACE_H
@@ -0,0 +1,196 @@
+#include "login_worker.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "string.h"
+
+static const char *TAG = "login_worker";
+
+#define CANCEL_BIT BIT0
+
+static login_worker_fn_t s_fn = NULL;
+static login_worker_done_cb_t s_done = NULL;
+static void* s_arg = NULL;
+static TaskHandle_t s_task = NULL;
+static SemaphoreHandle_t s_lock = NULL;
+static EventGroupHandle_t s_events = NULL;
+
+// Guarded by s_lock
+static login_job_t s_current;
+static bool s_running = false;
+static login_job_t s_pending[LOGIN_WORKER_QUEUE_LEN];
+static size_t s_pending_count = 0;
+static uint32_t s_next_id = 1;
+
+static bool same_card(const login_job_t* a, const login_job_t* b)
+{
+    return a->uid_length == b->uid_length && memcmp(a->uid, b->uid, a->uid_length) == 0;
+}
+
+static void drop_pending(size_t index)
+{
+    memmove(&s_pending[index], &s_pending[index + 1], (s_pending_count - index - 1) * sizeof(s_pending[0]));
+    s_pending_count--;
+}
+
+// Report queued jobs that will never run. Called without s_lock so the callback may use the worker.
+static void report_dropped(const login_job_t* jobs, size_t count, esp_err_t result)
+{
+    for (size_t i = 0; i < count; i++) {
+        ESP_LOGI(TAG, "Job %lu dropped: %s", (unsigned long)jobs[i].id, esp_err_to_name(result));
+        if (s_done) {
+            s_done(&jobs[i], result, s_arg);
+        }
+    }
+}
+
+static void worker_task(void* arg)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while (1) {
+            xSemaphoreTake(s_lock, portMAX_DELAY);
+            if (s_pending_count == 0) {
+                s_running = false;
+                xSemaphoreGive(s_lock);
+                break;
+            }
+            s_current = s_pending[0];
+            drop_pending(0);
+            s_running = true;
+            xEventGroupClearBits(s_events, CANCEL_BIT);
+            login_job_t job = s_current;
+            xSemaphoreGive(s_lock);
+
+            ESP_LOGI(TAG, "▶️ Job %lu: profile %u", (unsigned long)job.id, job.profile);
+            esp_err_t result = s_fn(&job, s_arg);
+            ESP_LOGI(TAG, "Job %lu finished: %s", (unsigned long)job.id, esp_err_to_name(result));
+            if (s_done) {
+                s_done(&job, result, s_arg);
+            }
+        }
+    }
+}
+
+esp_err_t login_worker_init(login_worker_fn_t fn, login_worker_done_cb_t done, void* arg,
+                            uint32_t stack_size, uint32_t priority)
+{
+    if (!fn) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_lock = xSemaphoreCreateMutex();
+    s_events = xEventGroupCreate();
+    if (!s_lock || !s_events) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_fn = fn;
+    s_done = done;
+    s_arg = arg;
+
+    if (xTaskCreate(worker_task, "login_worker", stack_size, NULL, priority, &s_task) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+login_worker_submit_result_t login_worker_submit(const login_job_t* job)
+{
+    login_worker_submit_result_t result = LOGIN_WORKER_STARTED;
+    login_job_t dropped[LOGIN_WORKER_QUEUE_LEN];
+    size_t dropped_count = 0;
+    esp_err_t dropped_result = ESP_ERR_NOT_FINISHED;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+
+    // Repeat tap of the same card: cancel its job instead of starting another one
+    for (size_t i = 0; i < s_pending_count; i++) {
+        if (same_card(&s_pending[i], job) && s_pending[i].profile == job->profile) {
+            dropped[dropped_count++] = s_pending[i];
+            drop_pending(i);
+            result = LOGIN_WORKER_CANCELLED;
+            goto out;
+        }
+    }
+    if (s_running && same_card(&s_current, job) && s_current.profile == job->profile) {
+        xEventGroupSetBits(s_events, CANCEL_BIT);
+        result = LOGIN_WORKER_CANCELLED;
+        goto out;
+    }
+
+    // Another card for a PC that is already being woken: the running or queued job covers it
+    if (s_running && s_current.profile == job->profile && !login_worker_cancelled()) {
+        result = LOGIN_WORKER_COALESCED;
+        goto out;
+    }
+    for (size_t i = 0; i < s_pending_count; i++) {
+        if (s_pending[i].profile == job->profile) {
+            result = LOGIN_WORKER_COALESCED;
+            goto out;
+        }
+    }
+
+    // Different PC: the newest request wins
+    if (s_running && !login_worker_cancelled()) {
+        xEventGroupSetBits(s_events, CANCEL_BIT);
+        memcpy(dropped, s_pending, s_pending_count * sizeof(s_pending[0]));
+        dropped_count = s_pending_count;
+        dropped_result = ESP_ERR_INVALID_STATE;
+        s_pending_count = 0;
+        result = LOGIN_WORKER_SUPERSEDED;
+    }
+    if (s_pending_count == LOGIN_WORKER_QUEUE_LEN) {
+        result = LOGIN_WORKER_QUEUE_FULL;
+        goto out;
+    }
+
+    s_pending[s_pending_count] = *job;
+    s_pending[s_pending_count].id = s_next_id++;
+    s_pending_count++;
+    xTaskNotifyGive(s_task);
+
+out:
+    xSemaphoreGive(s_lock);
+    report_dropped(dropped, dropped_count, dropped_result);
+    return result;
+}
+
+void login_worker_cancel(void)
+{
+    login_job_t dropped[LOGIN_WORKER_QUEUE_LEN];
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    size_t dropped_count = s_pending_count;
+    memcpy(dropped, s_pending, s_pending_count * sizeof(s_pending[0]));
+    s_pending_count = 0;
+    if (s_running) {
+        xEventGroupSetBits(s_events, CANCEL_BIT);
+    }
+    xSemaphoreGive(s_lock);
+    report_dropped(dropped, dropped_count, ESP_ERR_NOT_FINISHED);
+}
+
+bool login_worker_cancelled(void)
+{
+    return (xEventGroupGetBits(s_events) & CANCEL_BIT) != 0;
+}
+
+bool login_worker_wait_ms(uint32_t ms)
+{
+    EventBits_t bits = xEventGroupWaitBits(s_events, CANCEL_BIT, pdFALSE, pdFALSE, pdMS_TO_TICKS(ms));
+    return (bits & CANCEL_BIT) != 0;
+}
+
+bool login_worker_busy(void)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool busy = s_running || s_pending_count > 0;
+    xSemaphoreGive(s_lock);
+    return busy;
+}
@@ -0,0 +1,100 @@
+#ifndef LOGIN_WORKER_H
+#define LOGIN_WORKER_H
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOGIN_WORKER_MAX_UID_LENGTH 10
+#define LOGIN_WORKER_QUEUE_LEN      4
+
+// One login request: which card asked for which PC profile
+typedef struct {
+    uint8_t uid[LOGIN_WORKER_MAX_UID_LENGTH];
+    uint8_t uid_length;
+    uint8_t profile;
+    uint32_t id;                // Assigned by login_worker_submit()
+    uint32_t tag;               // Caller data, passed through to the job function
+} login_job_t;
+
+typedef enum {
+    LOGIN_WORKER_STARTED,       // Queued; runs as soon as the worker is free
+    LOGIN_WORKER_COALESCED,     // Same profile already running or queued; dropped
+    LOGIN_WORKER_SUPERSEDED,    // Running job for another profile cancelled, this one runs next
+    LOGIN_WORKER_CANCELLED,     // Same card tapped again: its job was cancelled, nothing queued
+    LOGIN_WORKER_QUEUE_FULL,
+} login_worker_submit_result_t;
+
+/**
+ * @brief Runs one job in the worker task
+ *
+ * Long steps should poll login_worker_cancelled() or wait with login_worker_wait_ms()
+ * and return ESP_ERR_NOT_FINISHED once cancelled.
+ */
+typedef esp_err_t (*login_worker_fn_t)(const login_job_t* job, void* arg);
+
+/**
+ * @brief Called once for every accepted job
+ *
+ * Runs in the worker task after a job ran. Queued jobs that never run are reported
+ * from the task that dropped them: ESP_ERR_NOT_FINISHED when cancelled (repeat tap,
+ * login_worker_cancel()), ESP_ERR_INVALID_STATE when superseded by another profile.
+ */
+typedef void (*login_worker_done_cb_t)(const login_job_t* job, esp_err_t result, void* arg);
+
+/**
+ * @brief Start the worker task
+ * @param fn Job function
+ * @param done Completion callback (may be NULL)
+ * @param arg User argument for both
+ * @param stack_size Worker task stack size
+ * @param priority Worker task priority
+ * @return ESP_OK, ESP_ERR_NO_MEM
+ */
+esp_err_t login_worker_init(login_worker_fn_t fn, login_worker_done_cb_t done, void* arg,
+                            uint32_t stack_size, uint32_t priority);
+
+/**
+ * @brief Submit a login request
+ *
+ * Tapping the card of the running (or queued) job again cancels it. A request for
+ * another profile cancels the running job and replaces anything queued. A request
+ * for the profile that is already running or queued is coalesced.
+ *
+ * @param job Request; uid, uid_length and profile are used
+ * @return What happened to the request
+ */
+login_worker_submit_result_t login_worker_submit(const login_job_t* job);
+
+/**
+ * @brief Cancel the running job and drop queued ones
+ */
+void login_worker_cancel(void);
+
+/**
+ * @brief True once the running job has been cancelled (call from the job function)
+ */
+bool login_worker_cancelled(void);
+
+/**
+ * @brief Sleep that ends early on cancellation (call from the job function)
+ * @param ms Delay in milliseconds
+ * @return true if the job was cancelled
+ */
+bool login_worker_wait_ms(uint32_t ms);
+
+/**
+ * @brief True while a job is running or queued
+ */
+bool login_worker_busy(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOGIN_WORKER_H
@@ -0,0 +1,274 @@
+#include "ndef.h"
+#include "string.h"
+
+// URI identifier code expansions (NFC Forum URI RTD), indexed by NDEF_URIPREFIX_*
+static const char* const s_uri_prefixes[] = {
+    [NDEF_URIPREFIX_NONE]         = "",
+    [NDEF_URIPREFIX_HTTP_WWWDOT]  = "http://www.",
+    [NDEF_URIPREFIX_HTTPS_WWWDOT] = "https://www.",
+    [NDEF_URIPREFIX_HTTP]         = "http://",
+    [NDEF_URIPREFIX_HTTPS]        = "https://",
+    [NDEF_URIPREFIX_TEL]          = "tel:",
+    [NDEF_URIPREFIX_MAILTO]       = "mailto:",
+    [NDEF_URIPREFIX_FTP_ANONAT]   = "ftp://anonymous:anonymous@",
+    [NDEF_URIPREFIX_FTP_FTPDOT]   = "ftp://ftp.",
+    [NDEF_URIPREFIX_FTPS]         = "ftps://",
+    [NDEF_URIPREFIX_SFTP]         = "sftp://",
+    [NDEF_URIPREFIX_SMB]          = "smb://",
+    [NDEF_URIPREFIX_NFS]          = "nfs://",
+    [NDEF_URIPREFIX_FTP]          = "ftp://",
+    [NDEF_URIPREFIX_DAV]          = "dav://",
+    [NDEF_URIPREFIX_NEWS]         = "news:",
+    [NDEF_URIPREFIX_TELNET]       = "telnet://",
+    [NDEF_URIPREFIX_IMAP]         = "imap:",
+    [NDEF_URIPREFIX_RTSP]         = "rtsp://",
+    [NDEF_URIPREFIX_URN]          = "urn:",
+    [NDEF_URIPREFIX_POP]          = "pop:",
+    [NDEF_URIPREFIX_SIP]          = "sip:",
+    [NDEF_URIPREFIX_SIPS]         = "sips:",
+    [NDEF_URIPREFIX_TFTP]         = "tftp:",
+    [NDEF_URIPREFIX_BTSPP]        = "btspp://",
+    [NDEF_URIPREFIX_BTL2CAP]      = "btl2cap://",
+    [NDEF_URIPREFIX_BTGOEP]       = "btgoep://",
+    [NDEF_URIPREFIX_TCPOBEX]      = "tcpobex://",
+    [NDEF_URIPREFIX_IRDAOBEX]     = "irdaobex://",
+    [NDEF_URIPREFIX_FILE]         = "file://",
+    [NDEF_URIPREFIX_URN_EPC_ID]   = "urn:epc:id:",
+    [NDEF_URIPREFIX_URN_EPC_TAG]  = "urn:epc:tag:",
+    [NDEF_URIPREFIX_URN_EPC_PAT]  = "urn:epc:pat:",
+    [NDEF_URIPREFIX_URN_EPC_RAW]  = "urn:epc:raw:",
+    [NDEF_URIPREFIX_URN_EPC]      = "urn:epc:",
+    [NDEF_URIPREFIX_URN_NFC]      = "urn:nfc:",
+};
+
+#define URI_PREFIX_COUNT (sizeof(s_uri_prefixes) / sizeof(s_uri_prefixes[0]))
+
+void ndef_tlv_reader_init(ndef_tlv_reader_t* reader, const uint8_t* data, size_t length)
+{
+    reader->data = data;
+    reader->length = length;
+    reader->pos = 0;
+    reader->done = false;
+}
+
+void ndef_tlv_reader_feed(ndef_tlv_reader_t* reader, size_t length)
+{
+    if (length > reader->length) {
+        reader->length = length;
+    }
+}
+
+esp_err_t ndef_tlv_next(ndef_tlv_reader_t* reader, ndef_tlv_t* tlv)
+{
+    if (reader->done) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // NULL TLVs are single padding bytes
+    while (reader->pos < reader->length && reader->data[reader->pos] == NDEF_TLV_NULL) {
+        reader->pos++;
+    }
+
+    size_t avail = reader->length - reader->pos;
+    if (avail == 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const uint8_t* p = reader->data + reader->pos;
+    if (p[0] == NDEF_TLV_TERMINATOR) {
+        reader->pos++;
+        reader->done = true;
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // 1-byte length, or 0xFF followed by a 2-byte big endian length
+    if (avail < 2) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    size_t header = 2;
+    uint16_t length = p[1];
+    if (p[1] == 0xFF) {
+        if (avail < 4) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        header = 4;
+        length = (uint16_t)((p[2] << 8) | p[3]);
+    }
+    if (avail - header < length) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    tlv->type = p[0];
+    tlv->length = length;
+    tlv->value = p + header;
+    reader->pos += header + length;
+    return ESP_OK;
+}
+
+void ndef_record_reader_init(ndef_record_reader_t* reader, const uint8_t* message, size_t length)
+{
+    reader->data = message;
+    reader->length = length;
+    reader->pos = 0;
+    reader->ended = false;
+    reader->in_chunk = false;
+}
+
+esp_err_t ndef_record_next(ndef_record_reader_t* reader, ndef_record_t* record)
+{
+    if (reader->ended) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    size_t avail = reader->length - reader->pos;
+    if (avail == 0) {
+        // An empty TLV is an empty message; otherwise the ME record is missing
+        return reader->pos == 0 ? ESP_ERR_NOT_FOUND : ESP_ERR_INVALID_SIZE;
+    }
+
+    const uint8_t* p = reader->data + reader->pos;
+    uint8_t flags = p[0];
+    bool sr = flags & NDEF_RECORD_SR;
+    bool il = flags & NDEF_RECORD_IL;
+
+    size_t header = 2 + (sr ? 1 : 4) + (il ? 1 : 0);
+    if (avail < header) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    size_t idx = 1;
+    record->type_length = p[idx++];
+    if (sr) {
+        record->payload_length = p[idx++];
+    } else {
+        record->payload_length = ((uint32_t)p[idx] << 24) | ((uint32_t)p[idx + 1] << 16) |
+                                 ((uint32_t)p[idx + 2] << 8) | p[idx + 3];
+        idx += 4;
+    }
+    record->id_length = il ? p[idx++] : 0;
+
+    // Compare against the remaining length piecewise so a 32-bit payload length cannot overflow
+    size_t rest = avail - header;
+    if (rest < (size_t)record->type_length + record->id_length ||
+        rest - record->type_length - record->id_length < record->payload_length) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    record->tnf = flags & NDEF_RECORD_TNF_MASK;
+    record->mb = flags & NDEF_RECORD_MB;
+    record->me = flags & NDEF_RECORD_ME;
+    record->cf = flags & NDEF_RECORD_CF;
+    record->type = p + header;
+    record->id = record->type + record->type_length;
+    record->payload = record->id + record->id_length;
+
+    // MB only on the first record
+    if (record->mb != (reader->pos == 0)) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    // Follow-up chunks carry TNF unchanged, no type and no ID; nothing else may use TNF unchanged
+    if (reader->in_chunk) {
+        if (record->tnf != NDEF_TNF_UNCHANGED || record->type_length != 0 || il) {
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+    } else if (record->tnf == NDEF_TNF_UNCHANGED || record->tnf > NDEF_TNF_UNCHANGED) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    if (record->tnf == NDEF_TNF_EMPTY &&
+        (record->type_length != 0 || record->id_length != 0 || record->payload_length != 0)) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    // The last record of a message cannot announce another chunk
+    if (record->me && record->cf) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    reader->pos += header + record->type_length + record->id_length + record->payload_length;
+    reader->in_chunk = record->cf;
+    reader->ended = record->me;
+    return ESP_OK;
+}
+
+bool ndef_record_is_uri(const ndef_record_t* record)
+{
+    return record->tnf == NDEF_TNF_WELL_KNOWN &&
+           record->type_length == 1 && record->type[0] == 'U' &&
+           !record->cf && record->payload_length >= 1;
+}
+
+const char* ndef_uri_prefix(uint8_t code)
+{
+    return code < URI_PREFIX_COUNT ? s_uri_prefixes[code] : "";
+}
+
+uint8_t ndef_uri_prefix_match(const char* uri, size_t* prefix_length)
+{
+    uint8_t best = NDEF_URIPREFIX_NONE;
+    size_t best_len = 0;
+    for (uint8_t code = NDEF_URIPREFIX_NONE + 1; code < URI_PREFIX_COUNT; code++) {
+        size_t len = strlen(s_uri_prefixes[code]);
+        if (len > best_len && strncmp(uri, s_uri_prefixes[code], len) == 0) {
+            best = code;
+            best_len = len;
+        }
+    }
+    if (prefix_length) {
+        *prefix_length = best_len;
+    }
+    return best;
+}
+
+esp_err_t ndef_uri_view(const ndef_record_t* record, const char** prefix, const uint8_t** rest, size_t* rest_length)
+{
+    if (!ndef_record_is_uri(record)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *prefix = ndef_uri_prefix(record->payload[0]);
+    *rest = record->payload + 1;
+    *rest_length = record->payload_length - 1;
+    return ESP_OK;
+}
+
+esp_err_t ndef_uri_to_string(const ndef_record_t* record, char* buf, size_t buf_len)
+{
+    const char* prefix;
+    const uint8_t* rest;
+    size_t rest_len;
+    esp_err_t ret = ndef_uri_view(record, &prefix, &rest, &rest_len);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    size_t prefix_len = strlen(prefix);
+    if (buf_len == 0 || prefix_len + rest_len > buf_len - 1) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(buf, prefix, prefix_len);
+    memcpy(buf + prefix_len, rest, rest_len);
+    buf[prefix_len + rest_len] = '\0';
+    return ESP_OK;
+}
+
+esp_err_t ndef_find_uri(const uint8_t* data, size_t length, ndef_record_t* record)
+{
+    ndef_tlv_reader_t tlvs;
+    ndef_tlv_t tlv;
+    ndef_tlv_reader_init(&tlvs, data, length);
+
+    esp_err_t ret;
+    while ((ret = ndef_tlv_next(&tlvs, &tlv)) == ESP_OK) {
+        if (tlv.type != NDEF_TLV_NDEF_MESSAGE) {
+            continue;
+        }
+        ndef_record_reader_t records;
+        ndef_record_reader_init(&records, tlv.value, tlv.length);
+        while ((ret = ndef_record_next(&records, record)) == ESP_OK) {
+            if (ndef_record_is_uri(record)) {
+                return ESP_OK;
+            }
+        }
+        // Only the first NDEF message is meaningful on a Type 2 tag
+        return ret;
+    }
+    return ret;
+}
@@ -0,0 +1,213 @@
+#ifndef NDEF_H
+#define NDEF_H
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// TLV block types found in Type 2 tag memory
+#define NDEF_TLV_NULL            0x00
+#define NDEF_TLV_LOCK_CONTROL    0x01
+#define NDEF_TLV_MEMORY_CONTROL  0x02
+#define NDEF_TLV_NDEF_MESSAGE    0x03
+#define NDEF_TLV_PROPRIETARY     0xFD
+#define NDEF_TLV_TERMINATOR      0xFE
+
+// Record header flags and type name formats
+#define NDEF_RECORD_MB           0x80
+#define NDEF_RECORD_ME           0x40
+#define NDEF_RECORD_CF           0x20
+#define NDEF_RECORD_SR           0x10
+#define NDEF_RECORD_IL           0x08
+#define NDEF_RECORD_TNF_MASK     0x07
+
+#define NDEF_TNF_EMPTY           0x00
+#define NDEF_TNF_WELL_KNOWN      0x01
+#define NDEF_TNF_MIME            0x02
+#define NDEF_TNF_ABSOLUTE_URI    0x03
+#define NDEF_TNF_EXTERNAL        0x04
+#define NDEF_TNF_UNKNOWN         0x05
+#define NDEF_TNF_UNCHANGED       0x06
+
+// URI identifier codes (NFC Forum URI RTD). Identical to the pn532.h definitions, so both
+// headers can be included together and ndef builds without the PN532 driver.
+#define NDEF_URIPREFIX_NONE                 (0x00)
+#define NDEF_URIPREFIX_HTTP_WWWDOT          (0x01)
+#define NDEF_URIPREFIX_HTTPS_WWWDOT         (0x02)
+#define NDEF_URIPREFIX_HTTP                 (0x03)
+#define NDEF_URIPREFIX_HTTPS                (0x04)
+#define NDEF_URIPREFIX_TEL                  (0x05)
+#define NDEF_URIPREFIX_MAILTO               (0x06)
+#define NDEF_URIPREFIX_FTP_ANONAT           (0x07)
+#define NDEF_URIPREFIX_FTP_FTPDOT           (0x08)
+#define NDEF_URIPREFIX_FTPS                 (0x09)
+#define NDEF_URIPREFIX_SFTP                 (0x0A)
+#define NDEF_URIPREFIX_SMB                  (0x0B)
+#define NDEF_URIPREFIX_NFS                  (0x0C)
+#define NDEF_URIPREFIX_FTP                  (0x0D)
+#define NDEF_URIPREFIX_DAV                  (0x0E)
+#define NDEF_URIPREFIX_NEWS                 (0x0F)
+#define NDEF_URIPREFIX_TELNET               (0x10)
+#define NDEF_URIPREFIX_IMAP                 (0x11)
+#define NDEF_URIPREFIX_RTSP                 (0x12)
+#define NDEF_URIPREFIX_URN                  (0x13)
+#define NDEF_URIPREFIX_POP                  (0x14)
+#define NDEF_URIPREFIX_SIP                  (0x15)
+#define NDEF_URIPREFIX_SIPS                 (0x16)
+#define NDEF_URIPREFIX_TFTP                 (0x17)
+#define NDEF_URIPREFIX_BTSPP                (0x18)
+#define NDEF_URIPREFIX_BTL2CAP              (0x19)
+#define NDEF_URIPREFIX_BTGOEP               (0x1A)
+#define NDEF_URIPREFIX_TCPOBEX              (0x1B)
+#define NDEF_URIPREFIX_IRDAOBEX             (0x1C)
+#define NDEF_URIPREFIX_FILE                 (0x1D)
+#define NDEF_URIPREFIX_URN_EPC_ID           (0x1E)
+#define NDEF_URIPREFIX_URN_EPC_TAG          (0x1F)
+#define NDEF_URIPREFIX_URN_EPC_PAT          (0x20)
+#define NDEF_URIPREFIX_URN_EPC_RAW          (0x21)
+#define NDEF_URIPREFIX_URN_EPC              (0x22)
+#define NDEF_URIPREFIX_URN_NFC              (0x23)
+
+/*
+ * All views below point into the caller's buffer; nothing is copied or allocated.
+ * The buffer must stay untouched while views are in use.
+ */
+
+// One TLV block
+typedef struct {
+    uint8_t type;
+    uint16_t length;
+    const uint8_t* value;
+} ndef_tlv_t;
+
+// Cursor over tag memory. The available length can grow while pages are still being read.
+typedef struct {
+    const uint8_t* data;
+    size_t length;
+    size_t pos;
+    bool done;                // Terminator TLV seen
+} ndef_tlv_reader_t;
+
+// One record (or one chunk of a chunked record)
+typedef struct {
+    uint8_t tnf;
+    bool mb;                  // First record of the message
+    bool me;                  // Last record of the message
+    bool cf;                  // More chunks follow
+    uint8_t type_length;
+    const uint8_t* type;
+    uint8_t id_length;
+    const uint8_t* id;
+    uint32_t payload_length;
+    const uint8_t* payload;
+} ndef_record_t;
+
+// Cursor over the records of one NDEF message
+typedef struct {
+    const uint8_t* data;
+    size_t length;
+    size_t pos;
+    bool ended;               // ME record seen
+    bool in_chunk;            // Previous record had CF set
+} ndef_record_reader_t;
+
+/**
+ * @brief Start reading TLVs (user memory of the tag, page 4 onwards)
+ * @param reader Cursor to initialise
+ * @param data Tag memory
+ * @param length Bytes of tag memory available so far
+ */
+void ndef_tlv_reader_init(ndef_tlv_reader_t* reader, const uint8_t* data, size_t length);
+
+/**
+ * @brief Tell the reader that more of the buffer has been filled
+ * @param reader Cursor
+ * @param length New number of valid bytes (same buffer)
+ */
+void ndef_tlv_reader_feed(ndef_tlv_reader_t* reader, size_t length);
+
+/**
+ * @brief Get the next TLV; NULL TLVs are skipped
+ * @param reader Cursor
+ * @param tlv Receives the TLV view
+ * @return ESP_OK, ESP_ERR_NOT_FOUND after the terminator,
+ *         ESP_ERR_INVALID_SIZE if the TLV is not complete yet (feed more data and call again)
+ */
+esp_err_t ndef_tlv_next(ndef_tlv_reader_t* reader, ndef_tlv_t* tlv);
+
+/**
+ * @brief Start reading the records of an NDEF message
+ * @param reader Cursor to initialise
+ * @param message Value of an NDEF message TLV
+ * @param length Message length
+ */
+void ndef_record_reader_init(ndef_record_reader_t* reader, const uint8_t* message, size_t length);
+
+/**
+ * @brief Get the next record
+ * @param reader Cursor
+ * @param record Receives the record view
+ * @return ESP_OK, ESP_ERR_NOT_FOUND after the last record,
+ *         ESP_ERR_INVALID_SIZE if a record runs past the message,
+ *         ESP_ERR_INVALID_RESPONSE if the message is malformed (flags, TNF or chunking)
+ */
+esp_err_t ndef_record_next(ndef_record_reader_t* reader, ndef_record_t* record);
+
+/**
+ * @brief Check for a well-known URI record ("U")
+ */
+bool ndef_record_is_uri(const ndef_record_t* record);
+
+/**
+ * @brief Expand a URI identifier code
+ * @param code NDEF_URIPREFIX_* value
+ * @return Prefix string, "" for NDEF_URIPREFIX_NONE and unknown codes
+ */
+const char* ndef_uri_prefix(uint8_t code);
+
+/**
+ * @brief Find the identifier code that abbreviates the start of a URI
+ * @param uri URI string
+ * @param prefix_length Receives the number of characters the code replaces
+ * @return NDEF_URIPREFIX_* value, NDEF_URIPREFIX_NONE if nothing matches
+ */
+uint8_t ndef_uri_prefix_match(const char* uri, size_t* prefix_length);
+
+/**
+ * @brief Split a URI record into expanded prefix and remainder without copying
+ * @param record URI record
+ * @param prefix Receives the expanded prefix
+ * @param rest Receives the URI bytes after the identifier code
+ * @param rest_length Receives their count
+ * @return ESP_OK, ESP_ERR_INVALID_ARG if the record is not a URI record
+ */
+esp_err_t ndef_uri_view(const ndef_record_t* record, const char** prefix, const uint8_t** rest, size_t* rest_length);
+
+/**
+ * @brief Write the full URI of a URI record as a C string
+ * @param record URI record
+ * @param buf Output buffer
+ * @param buf_len Output buffer size
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE if the URI does not fit
+ */
+esp_err_t ndef_uri_to_string(const ndef_record_t* record, char* buf, size_t buf_len);
+
+/**
+ * @brief Find the first URI record in the first NDEF message TLV of tag memory
+ * @param data Tag memory (page 4 onwards)
+ * @param length Bytes available
+ * @param record Receives the record view
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if there is none, parser errors otherwise
+ */
+esp_err_t ndef_find_uri(const uint8_t* data, size_t length, ndef_record_t* record);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NDEF_H
@@ -0,0 +1,68 @@
+#include "ndef_fuzz.h"
+#include "ndef.h"
+#include <string.h>
+
+/*
+ * Fuzz entry point, also driven by ndef_host_test.c. Builds with libFuzzer as well:
+ *   clang -fsanitize=fuzzer,address -I. -I../../.. -I$IDF_PATH/components/esp_common/include \
+ *         ndef_fuzz.c ../../../ndef.c -o ndef_fuzz
+ * Every view the parser hands out must lie inside the input.
+ */
+
+static bool inside(const uint8_t* data, size_t size, const uint8_t* p, size_t len)
+{
+    return len == 0 || (p >= data && len <= size && (size_t)(p - data) <= size - len);
+}
+
+static void walk_records(const uint8_t* data, size_t size, const uint8_t* message, size_t length)
+{
+    ndef_record_reader_t records;
+    ndef_record_t record;
+    char uri[256];
+
+    ndef_record_reader_init(&records, message, length);
+    while (ndef_record_next(&records, &record) == ESP_OK) {
+        CHECK(inside(data, size, record.type, record.type_length));
+        CHECK(inside(data, size, record.id, record.id_length));
+        CHECK(inside(data, size, record.payload, record.payload_length));
+        if (ndef_record_is_uri(&record) && ndef_uri_to_string(&record, uri, sizeof(uri)) == ESP_OK) {
+            CHECK(strlen(uri) < sizeof(uri));
+        }
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    // Whole buffer at once
+    ndef_tlv_reader_t reader;
+    ndef_tlv_t tlv;
+    ndef_tlv_reader_init(&reader, data, size);
+    while (ndef_tlv_next(&reader, &tlv) == ESP_OK) {
+        CHECK(inside(data, size, tlv.value, tlv.length));
+        if (tlv.type == NDEF_TLV_NDEF_MESSAGE) {
+            walk_records(data, size, tlv.value, tlv.length);
+        }
+    }
+
+    // Fed one 16-byte read at a time, like the reader task does
+    size_t fed = size < 16 ? size : 16;
+    ndef_tlv_reader_init(&reader, data, fed);
+    while (1) {
+        esp_err_t err = ndef_tlv_next(&reader, &tlv);
+        if (err == ESP_OK) {
+            CHECK(inside(data, fed, tlv.value, tlv.length));
+        } else if (err == ESP_ERR_INVALID_SIZE && fed < size) {
+            fed = size - fed < 16 ? size : fed + 16;
+            ndef_tlv_reader_feed(&reader, fed);
+        } else {
+            break;
+        }
+    }
+
+    ndef_record_t record;
+    if (ndef_find_uri(data, size, &record) == ESP_OK) {
+        CHECK(ndef_record_is_uri(&record));
+        CHECK(inside(data, size, record.payload, record.payload_length));
+    }
+    return 0;
+}
@@ -0,0 +1,24 @@
+#ifndef NDEF_FUZZ_H
+#define NDEF_FUZZ_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Like assert(), but always evaluated: the checks stay in NDEBUG and release builds
+#define CHECK(cond)                                                                     \
+    do {                                                                                \
+        if (!(cond)) {                                                                  \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond);    \
+            abort();                                                                    \
+        }                                                                               \
+    } while (0)
+
+/**
+ * @brief Run every parser entry point over one input (libFuzzer signature)
+ * @return Always 0; violated invariants abort through CHECK()
+ */
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+#endif // NDEF_FUZZ_H
@@ -0,0 +1,291 @@
+#include "ndef.h"
+#include "ndef_fuzz.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FUZZ_ITERATIONS 1000000
+#define FUZZ_MAX_LEN 256
+#define BENCH_ITERATIONS 2000000
+
+// Lock control TLV, then an NDEF message with one short URI record and the terminator
+static const uint8_t uri_tag[] = {
+    0x01, 0x03, 0xA0, 0x10, 0x44,
+    0x03, 0x13, 0xD1, 0x01, 0x0F, 0x55, 0x04,
+    'e', 'x', 'a', 'm', 'p', 'l', 'e', '.', 'c', 'o', 'm', '/', 'a', 'b',
+    0xFE,
+};
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void test_known_answers(void)
+{
+    ndef_record_t record;
+    char uri[64];
+
+    CHECK(ndef_find_uri(uri_tag, sizeof(uri_tag), &record) == ESP_OK);
+    CHECK(ndef_uri_to_string(&record, uri, sizeof(uri)) == ESP_OK);
+    CHECK(strcmp(uri, "https://example.com/ab") == 0);
+    CHECK(ndef_uri_to_string(&record, uri, 8) == ESP_ERR_INVALID_SIZE);
+
+    // Cut inside the message: the record runs past what was read
+    CHECK(ndef_find_uri(uri_tag, 12, &record) != ESP_OK);
+
+    size_t prefix_length;
+    CHECK(ndef_uri_prefix_match("https://www.example.com", &prefix_length) == 0x02);
+    CHECK(prefix_length == strlen("https://www."));
+    CHECK(ndef_uri_prefix_match("gopher://x", &prefix_length) == 0x00);
+    printf("known answers: ok\n");
+}
+
+// NDEF TLV with the 0xFF three-byte length holding one long (non-SR) URI record
+static void test_long_record(void)
+{
+    enum { URI_CHARS = 249, RECORD_LEN = 1 + 1 + 4 + 1 + 1 + URI_CHARS };
+    uint8_t tag[4 + RECORD_LEN + 1];
+    size_t n = 0;
+
+    tag[n++] = NDEF_TLV_NDEF_MESSAGE;
+    tag[n++] = 0xFF;
+    tag[n++] = RECORD_LEN >> 8;
+    tag[n++] = RECORD_LEN & 0xFF;
+    tag[n++] = NDEF_RECORD_MB | NDEF_RECORD_ME | NDEF_TNF_WELL_KNOWN;
+    tag[n++] = 1;
+    tag[n++] = 0x00;
+    tag[n++] = 0x00;
+    tag[n++] = 0x00;
+    tag[n++] = 1 + URI_CHARS;
+    tag[n++] = 'U';
+    tag[n++] = NDEF_URIPREFIX_HTTPS;
+    memset(tag + n, 'a', URI_CHARS);
+    n += URI_CHARS;
+    tag[n++] = NDEF_TLV_TERMINATOR;
+    CHECK(n == sizeof(tag));
+
+    ndef_tlv_reader_t reader;
+    ndef_tlv_t tlv;
+    ndef_tlv_reader_init(&reader, tag, sizeof(tag));
+    CHECK(ndef_tlv_next(&reader, &tlv) == ESP_OK);
+    CHECK(tlv.type == NDEF_TLV_NDEF_MESSAGE);
+    CHECK(tlv.length == RECORD_LEN);
+    CHECK(tlv.value == tag + 4);
+    CHECK(ndef_tlv_next(&reader, &tlv) == ESP_ERR_NOT_FOUND);
+
+    ndef_record_t record;
+    char uri[8 + URI_CHARS + 1];
+    CHECK(ndef_find_uri(tag, sizeof(tag), &record) == ESP_OK);
+    CHECK(record.payload_length == 1 + URI_CHARS);
+    CHECK(record.payload == tag + 11);
+    CHECK(ndef_uri_to_string(&record, uri, sizeof(uri)) == ESP_OK);
+    CHECK(strncmp(uri, "https://aaa", 11) == 0 && strlen(uri) == 8 + URI_CHARS);
+
+    // Three-byte length cut short, then a length past the end of the data
+    ndef_tlv_reader_init(&reader, tag, 3);
+    CHECK(ndef_tlv_next(&reader, &tlv) == ESP_ERR_INVALID_SIZE);
+    ndef_tlv_reader_init(&reader, tag, sizeof(tag) - 2);
+    CHECK(ndef_tlv_next(&reader, &tlv) == ESP_ERR_INVALID_SIZE);
+
+    // Long payload length that claims more than the message holds
+    ndef_record_reader_t records;
+    tag[9] = 0xFF;
+    ndef_record_reader_init(&records, tag + 4, RECORD_LEN);
+    CHECK(ndef_record_next(&records, &record) == ESP_ERR_INVALID_SIZE);
+    tag[6] = 0xFF;
+    ndef_record_reader_init(&records, tag + 4, RECORD_LEN);
+    CHECK(ndef_record_next(&records, &record) == ESP_ERR_INVALID_SIZE);
+    printf("long record: ok\n");
+}
+
+// Short record with an ID field (IL set)
+static void test_id_field(void)
+{
+    static const uint8_t message[] = {
+        NDEF_RECORD_MB | NDEF_RECORD_ME | NDEF_RECORD_SR | NDEF_RECORD_IL | NDEF_TNF_WELL_KNOWN,
+        0x01, 0x03, 0x02, 'U', 'i', 'd', NDEF_URIPREFIX_HTTP, 'a', 'b',
+    };
+    ndef_record_reader_t records;
+    ndef_record_t record;
+    char uri[16];
+
+    ndef_record_reader_init(&records, message, sizeof(message));
+    CHECK(ndef_record_next(&records, &record) == ESP_OK);
+    CHECK(record.mb && record.me && !record.cf);
+    CHECK(record.type_length == 1 && record.type == message + 4);
+    CHECK(record.id_length == 2 && record.id == message + 5 && memcmp(record.id, "id", 2) == 0);
+    CHECK(record.payload_length == 3 && record.payload == message + 7);
+    CHECK(ndef_uri_to_string(&record, uri, sizeof(uri)) == ESP_OK);
+    CHECK(strcmp(uri, "http://ab") == 0);
+    CHECK(ndef_record_next(&records, &record) == ESP_ERR_NOT_FOUND);
+
+    // The ID length byte is part of the header: a record cut right after it is incomplete
+    ndef_record_reader_init(&records, message, 4);
+    CHECK(ndef_record_next(&records, &record) == ESP_ERR_INVALID_SIZE);
+    ndef_record_reader_init(&records, message, 3);
+    CHECK(ndef_record_next(&records, &record) == ESP_ERR_INVALID_SIZE);
+    printf("id field: ok\n");
+}
+
+static esp_err_t walk_message(const uint8_t* message, size_t length, size_t* count)
+{
+    ndef_record_reader_t records;
+    ndef_record_t record;
+    esp_err_t ret;
+
+    *count = 0;
+    ndef_record_reader_init(&records, message, length);
+    while ((ret = ndef_record_next(&records, &record)) == ESP_OK) {
+        (*count)++;
+    }
+    return ret;
+}
+
+// A MIME record split into three chunks, and the ways a chunk sequence can be broken
+static void test_chunks(void)
+{
+    uint8_t message[] = {
+        NDEF_RECORD_MB | NDEF_RECORD_CF | NDEF_RECORD_SR | NDEF_TNF_MIME, 0x01, 0x02, 'x', 'a', 'b',
+        NDEF_RECORD_CF | NDEF_RECORD_SR | NDEF_TNF_UNCHANGED, 0x00, 0x02, 'c', 'd',
+        NDEF_RECORD_ME | NDEF_RECORD_SR | NDEF_TNF_UNCHANGED, 0x00, 0x01, 'e',
+    };
+    const size_t second = 6, third = 11;
+    ndef_record_reader_t records;
+    ndef_record_t record;
+    size_t count;
+
+    ndef_record_reader_init(&records, message, sizeof(message));
+    CHECK(ndef_record_next(&records, &record) == ESP_OK);
+    CHECK(record.mb && record.cf && !record.me && record.tnf == NDEF_TNF_MIME);
+    CHECK(record.payload_length == 2 && memcmp(record.payload, "ab", 2) == 0);
+    CHECK(ndef_record_next(&records, &record) == ESP_OK);
+    CHECK(!record.mb && record.cf && record.tnf == NDEF_TNF_UNCHANGED && record.type_length == 0);
+    CHECK(record.payload_length == 2 && memcmp(record.payload, "cd", 2) == 0);
+    CHECK(ndef_record_next(&records, &record) == ESP_OK);
+    CHECK(record.me && !record.cf && record.payload_length == 1 && record.payload[0] == 'e');
+    CHECK(ndef_record_next(&records, &record) == ESP_ERR_NOT_FOUND);
+
+    // Message ends while a chunk is still announced
+    CHECK(walk_message(message, third, &count) == ESP_ERR_INVALID_SIZE && count == 2);
+
+    // Follow-up chunk with a type, an ID or its own TNF
+    message[second + 1] = 0x01;
+    CHECK(walk_message(message, sizeof(message), &count) == ESP_ERR_INVALID_RESPONSE && count == 1);
+    message[second + 1] = 0x00;
+    static const uint8_t chunk_with_id[] = {
+        NDEF_RECORD_MB | NDEF_RECORD_CF | NDEF_RECORD_SR | NDEF_TNF_MIME, 0x01, 0x01, 'x', 'a',
+        NDEF_RECORD_ME | NDEF_RECORD_SR | NDEF_RECORD_IL | NDEF_TNF_UNCHANGED, 0x00, 0x01, 0x00, 'b',
+    };
+    CHECK(walk_message(chunk_with_id, sizeof(chunk_with_id), &count) == ESP_ERR_INVALID_RESPONSE && count == 1);
+    message[second] = NDEF_RECORD_CF | NDEF_RECORD_SR | NDEF_TNF_MIME;
+    CHECK(walk_message(message, sizeof(message), &count) == ESP_ERR_INVALID_RESPONSE && count == 1);
+    message[second] = NDEF_RECORD_CF | NDEF_RECORD_SR | NDEF_TNF_UNCHANGED;
+    CHECK(walk_message(message, sizeof(message), &count) == ESP_ERR_NOT_FOUND && count == 3);
+
+    // Last record still announcing a chunk, and TNF unchanged outside a chunk
+    message[third] |= NDEF_RECORD_CF;
+    CHECK(walk_message(message, sizeof(message), &count) == ESP_ERR_INVALID_RESPONSE && count == 2);
+    message[third] &= ~NDEF_RECORD_CF;
+    message[0] = NDEF_RECORD_MB | NDEF_RECORD_SR | NDEF_TNF_UNCHANGED;
+    CHECK(walk_message(message, sizeof(message), &count) == ESP_ERR_INVALID_RESPONSE && count == 0);
+
+    // A chunked URI record is not a URI record until reassembled
+    static const uint8_t chunked_uri[] = {
+        NDEF_RECORD_MB | NDEF_RECORD_CF | NDEF_RECORD_SR | NDEF_TNF_WELL_KNOWN, 0x01, 0x02, 'U', NDEF_URIPREFIX_HTTP, 'a',
+        NDEF_RECORD_ME | NDEF_RECORD_SR | NDEF_TNF_UNCHANGED, 0x00, 0x01, 'b',
+    };
+    ndef_record_reader_init(&records, chunked_uri, sizeof(chunked_uri));
+    CHECK(ndef_record_next(&records, &record) == ESP_OK);
+    CHECK(!ndef_record_is_uri(&record));
+    printf("chunks: ok\n");
+}
+
+// Tag memory arriving one 4-byte page at a time, as it is read off the card
+static void test_feed(void)
+{
+    ndef_tlv_reader_t reader;
+    ndef_tlv_t tlv;
+    size_t fed = 4;
+    size_t incomplete = 0;
+
+    ndef_tlv_reader_init(&reader, uri_tag, fed);
+    CHECK(ndef_tlv_next(&reader, &tlv) == ESP_ERR_INVALID_SIZE);
+    ndef_tlv_reader_feed(&reader, 2);   // Never shrinks
+    CHECK(reader.length == fed);
+
+    // Lock control TLV completes with the second page
+    fed += 4;
+    ndef_tlv_reader_feed(&reader, fed);
+    CHECK(ndef_tlv_next(&reader, &tlv) == ESP_OK);
+    CHECK(tlv.type == NDEF_TLV_LOCK_CONTROL && tlv.length == 3 && tlv.value == uri_tag + 2);
+
+    // The NDEF TLV (bytes 5..25) is reported incomplete until the page holding byte 25
+    while (ndef_tlv_next(&reader, &tlv) == ESP_ERR_INVALID_SIZE) {
+        incomplete++;
+        fed = fed + 4 > sizeof(uri_tag) ? sizeof(uri_tag) : fed + 4;
+        ndef_tlv_reader_feed(&reader, fed);
+    }
+    CHECK(incomplete == 5 && fed == sizeof(uri_tag) && reader.pos == 26);
+    CHECK(tlv.type == NDEF_TLV_NDEF_MESSAGE && tlv.length == 0x13 && tlv.value == uri_tag + 7);
+    CHECK(ndef_tlv_next(&reader, &tlv) == ESP_ERR_NOT_FOUND);
+    CHECK(ndef_tlv_next(&reader, &tlv) == ESP_ERR_NOT_FOUND);
+    printf("feed: ok\n");
+}
+
+// Mutations of a valid tag hit the parser's edge cases far more often than pure noise
+static void test_fuzz(void)
+{
+    uint8_t buf[FUZZ_MAX_LEN];
+
+    srand(1);
+    for (int i = 0; i < FUZZ_ITERATIONS; i++) {
+        size_t len = (size_t)rand() % (FUZZ_MAX_LEN + 1);
+        if (i % 2 && len >= sizeof(uri_tag)) {
+            memcpy(buf, uri_tag, sizeof(uri_tag));
+            for (size_t j = sizeof(uri_tag); j < len; j++) {
+                buf[j] = (uint8_t)rand();
+            }
+            for (int flips = rand() % 4; flips >= 0; flips--) {
+                buf[(size_t)rand() % len] ^= (uint8_t)(1u << (rand() % 8));
+            }
+        } else {
+            for (size_t j = 0; j < len; j++) {
+                buf[j] = (uint8_t)rand();
+            }
+        }
+        LLVMFuzzerTestOneInput(buf, len);
+    }
+    printf("fuzz: %d inputs ok\n", FUZZ_ITERATIONS);
+}
+
+static void bench_find_uri(void)
+{
+    ndef_record_t record;
+    size_t found = 0;
+
+    double start = now_s();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        found += ndef_find_uri(uri_tag, sizeof(uri_tag), &record) == ESP_OK;
+    }
+    double elapsed = now_s() - start;
+    CHECK(found == BENCH_ITERATIONS);
+
+    printf("ndef_find_uri: %.0f tags/s, %.1f MB/s (%u-byte tag)\n", BENCH_ITERATIONS / elapsed,
+           BENCH_ITERATIONS * sizeof(uri_tag) / elapsed / 1e6, (unsigned)sizeof(uri_tag));
+}
+
+void app_main(void)
+{
+    test_known_answers();
+    test_long_record();
+    test_id_field();
+    test_chunks();
+    test_feed();
+    test_fuzz();
+    bench_find_uri();
+    exit(0);
+}
@@ -98,6 +98,10 @@ extern "C"
 #define MIFARE_CMD_INCREMENT                (0xC1)
 #define MIFARE_CMD_STORE                    (0xC2)
 #define MIFARE_ULTRALIGHT_CMD_WRITE         (0xA2)
+#define NTAG2XX_CMD_FAST_READ               (0x3A)
+
+// Largest FAST_READ that fits the driver's 64 byte packet buffer
+#define NTAG2XX_FAST_READ_MAX_PAGES         (12)
 
 // Prefixes for NDEF Records (to identify record type)
 #define NDEF_URIPREFIX_NONE                 (0x00)
@@ -173,7 +177,7 @@ esp_err_t pn532_set_passive_activation_retries(pn532_io_handle_t io_handle, uint
  * @param uid buffer to receive the UID bytes (UIDs can be 4 bytes, 7 bytes or 10 bytes long)
  * @param uid_length length of the received UID
  * @param timeout timeout in milliseconds. If 0, wait forever
- * @return ESP_OK if successful
+ * @return ESP_OK if successful, ESP_ERR_TIMEOUT if no card showed up (the search is aborted)
  */
 esp_err_t pn532_read_passive_target_id(pn532_io_handle_t io_handle,
                                        uint8_t baud_rate_and_card_type,
@@ -193,6 +197,16 @@ esp_err_t pn532_read_passive_target_id(pn532_io_handle_t io_handle,
 esp_err_t pn532_in_data_exchange(pn532_io_handle_t io_handle, const uint8_t *send_buffer, uint8_t send_buffer_length, uint8_t *response,
                                  uint8_t *response_length);
 
+/**
+ * Get ATQA and SAK of the target found by the last successful pn532_read_passive_target_id().
+ * SAK 0x08 is a Mifare Classic 1K, 0x18 a Classic 4K, 0x00 an Ultralight/NTAG.
+ * @param io_handle PN532 io handle
+ * @param atqa receives the ATQA (SENS_RES), may be NULL
+ * @param sak receives the SAK (SEL_RES), may be NULL
+ * @return ESP_OK if successful
+ */
+esp_err_t pn532_get_passive_target_info(pn532_io_handle_t io_handle, uint16_t *atqa, uint8_t *sak);
+
 /**
  * InLists a passive target.
  * PN532 acting as reader/initiator, peer acting as card/responder.
@@ -212,8 +226,34 @@ esp_err_t pn532_in_list_passive_target(pn532_io_handle_t io_handle);
  */
 esp_err_t ntag2xx_get_model(pn532_io_handle_t io_handle, NTAG2XX_MODEL *model);
 
+// Mifare Classic functions
+
+/**
+ * Authenticate a Mifare Classic block (and with it the whole sector).
+ * A failed authentication halts the card; re-select it before the next attempt.
+ * @param io_handle PN532 io handle
+ * @param uid buffer containing the UID bytes
+ * @param uid_length length of the UID (4 or 7)
+ * @param block absolute block number
+ * @param key_type MIFARE_CMD_AUTH_A or MIFARE_CMD_AUTH_B
+ * @param key buffer containing the 6 byte key
+ * @return ESP_OK if successful, ESP_ERR_INVALID_RESPONSE if the card rejected the key
+ */
+esp_err_t mifareclassic_authenticate_block(pn532_io_handle_t io_handle, const uint8_t *uid, uint8_t uid_length,
+                                           uint8_t block, uint8_t key_type, const uint8_t *key);
+
 /**
- * Authenticate a page.
+ * Read a 16 byte block from an authenticated Mifare Classic sector.
+ * @param io_handle PN532 io handle
+ * @param block absolute block number
+ * @param data buffer receiving 16 bytes
+ * @return ESP_OK if successful
+ */
+esp_err_t mifareclassic_read_block(pn532_io_handle_t io_handle, uint8_t block, uint8_t *data);
+
+/**
+ * Authenticate a page with Mifare Classic key A.
+ * Kept for compatibility, use mifareclassic_authenticate_block().
  * @param io_handle PN532 io handle
  * @param page page to authenticate
  * @param key buffer containing the 6 byte key for authentication
@@ -235,12 +275,23 @@ esp_err_t ntag2xx_read_page(pn532_io_handle_t io_handle, uint8_t page, uint8_t *
 /**
  * Write a 4 byte page.
  * @param io_handle PN532 io handle
- * @param page page to write
+ * @param page page to write (2..230; pages 2/3 hold lock bits and the OTP capability container)
  * @param data pointer to data to write
- * @return ESP_OK if successful
+ * @return ESP_OK if the tag acknowledged the write, ESP_ERR_INVALID_ARG for pages out of range
  */
 esp_err_t ntag2xx_write_page(pn532_io_handle_t io_handle, uint8_t page, const uint8_t *data);
 
+/**
+ * Read a range of pages with a single FAST_READ command (NTAG21x only).
+ * @param io_handle PN532 io handle
+ * @param start_page first page to read
+ * @param end_page last page to read (inclusive, at most NTAG2XX_FAST_READ_MAX_PAGES pages in total)
+ * @param buffer buffer to receive data
+ * @param buffer_len size of buffer, must hold (end_page - start_page + 1) * 4 bytes
+ * @return ESP_OK if successful
+ */
+esp_err_t ntag2xx_fast_read(pn532_io_handle_t io_handle, uint8_t start_page, uint8_t end_page, uint8_t *buffer, size_t buffer_len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,136 @@
+/**
+ * @file     pn532_diag.h
+ * @license  MIT (see license.txt)
+ * Antenna self-test and RF diagnostics for the PN532, built on Diagnose,
+ * GetGeneralStatus and ReadRegister.
+ */
+
+#ifndef PN532_DIAG_H
+#define PN532_DIAG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "pn532_driver.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Diagnose test numbers (UM0701-02 7.2.1)
+#define PN532_DIAG_TEST_COMM_LINE           (0x00)
+#define PN532_DIAG_TEST_ANTENNA             (0x07)
+
+/*
+ * Antenna self-test parameter: b7 must be set, b6..b4 high current threshold,
+ * b2..b1 low current threshold, b0 enables the antenna level detector.
+ */
+#define PN532_DIAG_ANTENNA_PARAM(high, low) (0x80 | (((high) & 0x07) << 4) | (((low) & 0x03) << 1) | 0x01)
+#define PN532_DIAG_ANTENNA_DEFAULT_PARAM    PN532_DIAG_ANTENNA_PARAM(2, 2)
+
+// CIU (contactless interface unit) registers in the PN532 XRAM map
+#define PN532_REG_CIU_TXCONTROL             (0x6304)
+#define PN532_REG_CIU_RFCFG                 (0x6316)
+#define PN532_REG_CIU_GSNON                 (0x6317)
+#define PN532_REG_CIU_CWGSP                 (0x6318)
+#define PN532_REG_CIU_ERROR                 (0x6336)
+#define PN532_REG_CIU_STATUS1               (0x6337)
+#define PN532_REG_CIU_STATUS2               (0x6338)
+#define PN532_REG_CIU_COLL                  (0x633E)
+
+// Bits of interest in the CIU registers above
+#define PN532_CIU_TXCONTROL_TX1RFEN         (0x01)
+#define PN532_CIU_TXCONTROL_TX2RFEN         (0x02)
+#define PN532_CIU_STATUS1_RFON              (0x04)
+#define PN532_CIU_ERROR_PROTOCOL            (0x01)
+#define PN532_CIU_ERROR_PARITY              (0x02)
+#define PN532_CIU_ERROR_CRC                 (0x04)
+#define PN532_CIU_ERROR_COLL                (0x08)
+#define PN532_CIU_ERROR_TEMP                (0x40)
+#define PN532_CIU_COLL_POS_NOT_VALID        (0x20)
+
+#define PN532_DIAG_MAX_REGISTERS            24
+
+typedef struct {
+    bool antenna_ok;            // Antenna self-test passed
+    uint8_t antenna_status;     // Raw Diagnose status (0x00 = OK)
+    uint8_t last_error;         // GetGeneralStatus error code of the last command
+    bool external_field;        // Another reader's RF field is present
+    uint8_t targets;            // Targets currently activated
+    uint8_t tx_control;         // CIU_TxControl: TX1/TX2 drivers enabled
+    uint8_t rf_cfg;             // CIU_RFCfg: receiver gain and RF level detector
+    uint8_t gs_n_on;            // CIU_GsNOn: N-driver conductance
+    uint8_t cw_gs_p;            // CIU_CWGsP: P-driver conductance for the carrier
+    uint8_t ciu_error;          // CIU_Error: protocol, parity, CRC, collision, temperature
+    uint8_t ciu_status1;        // CIU_Status1: RF on, CRC state
+    uint8_t ciu_status2;        // CIU_Status2: modem state, Crypto1 on
+    uint8_t ciu_coll;           // CIU_Coll: collision position
+} pn532_diag_report_t;
+
+/**
+ * Run the PN532 antenna self-test.
+ * @param io_handle PN532 io handle
+ * @param param threshold parameter, see PN532_DIAG_ANTENNA_PARAM()
+ * @param status receives the raw test status, 0x00 if the antenna is within limits (may be NULL)
+ * @return ESP_OK if the test passed, ESP_ERR_INVALID_RESPONSE if the antenna is out of limits
+ */
+esp_err_t pn532_diag_antenna_test(pn532_io_handle_t io_handle, uint8_t param, uint8_t *status);
+
+/**
+ * Read several PN532 registers with a single ReadRegister command.
+ * @param io_handle PN532 io handle
+ * @param addresses register addresses
+ * @param values receives one byte per address
+ * @param count number of registers (at most PN532_DIAG_MAX_REGISTERS)
+ * @return ESP_OK if successful
+ */
+esp_err_t pn532_read_registers(pn532_io_handle_t io_handle, const uint16_t *addresses, uint8_t *values, size_t count);
+
+/**
+ * Write several PN532 registers with a single WriteRegister command.
+ * @param io_handle PN532 io handle
+ * @param addresses register addresses
+ * @param values one byte per address
+ * @param count number of registers (at most PN532_DIAG_MAX_REGISTERS)
+ * @return ESP_OK if successful
+ */
+esp_err_t pn532_write_registers(pn532_io_handle_t io_handle, const uint16_t *addresses, const uint8_t *values, size_t count);
+
+/**
+ * Get the PN532 general status.
+ * @param io_handle PN532 io handle
+ * @param last_error receives the error code of the last command (may be NULL)
+ * @param external_field receives whether an external RF field is detected (may be NULL)
+ * @param targets receives the number of activated targets (may be NULL)
+ * @return ESP_OK if successful
+ */
+esp_err_t pn532_get_general_status(pn532_io_handle_t io_handle, uint8_t *last_error, bool *external_field, uint8_t *targets);
+
+/**
+ * Collect a full health report: antenna self-test, general status and CIU registers.
+ * Do not call while a target is being exchanged with; the self-test switches the RF field.
+ * @param io_handle PN532 io handle
+ * @param report receives the report
+ * @return ESP_OK if all commands succeeded (the report itself may still show a fault)
+ */
+esp_err_t pn532_diag_run(pn532_io_handle_t io_handle, pn532_diag_report_t *report);
+
+/**
+ * Check a report for conditions that make reads unreliable.
+ * @param report report from pn532_diag_run()
+ * @return true if the antenna and RF front end look healthy
+ */
+bool pn532_diag_is_healthy(const pn532_diag_report_t *report);
+
+/**
+ * Log a report at info level (warning level if unhealthy).
+ * @param report report from pn532_diag_run()
+ */
+void pn532_diag_log(const pn532_diag_report_t *report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PN532_DIAG_H
@@ -126,6 +126,14 @@ esp_err_t pn532_send_command_wait_ack(pn532_io_handle_t io_handle, const uint8_t
  */
 esp_err_t pn532_read_ack(pn532_io_handle_t io_handle);
 
+/**
+ * Abort the command the PN532 is currently processing (e.g. a pending
+ * InListPassiveTarget after a timeout), so the next command starts clean.
+ * @param io_handle PN532 io handle
+ * @return ESP_OK if successful
+ */
+esp_err_t pn532_abort_command(pn532_io_handle_t io_handle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,45 @@
+#ifndef PN532_DRIVER_HSU_H
+#define PN532_DRIVER_HSU_H
+
+#include "driver/uart.h"
+#include "driver/gpio.h"
+
+#include "pn532_driver.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Pass as baudrate to probe for the fastest stable rate and remember it in NVS
+#define PN532_HSU_BAUD_AUTO 0
+
+/**
+ * Create a PN532 driver for the HSU (UART) interface.
+ * The link starts at 115200 baud and pn532_init() switches to @p baudrate. If that rate
+ * does not survive a few round trips the driver falls back one step at a time.
+ * With PN532_HSU_BAUD_AUTO the search starts at 1288000 baud (or the rate stored in NVS
+ * by a previous boot) and the rate found is stored in NVS namespace "pn532"; NVS must be
+ * initialized before pn532_init(). Storing needs CONFIG_PN532_HSU_BAUD_NVS.
+ * @return ESP_OK if successful
+ */
+esp_err_t pn532_new_driver_hsu(gpio_num_t uart_rx,
+                               gpio_num_t uart_tx,
+                               gpio_num_t reset,
+                               gpio_num_t irq,
+                               uart_port_t uart_port,
+                               int32_t baudrate,
+                               pn532_io_handle_t io_handle);
+
+/**
+ * Get the baud rate the HSU link currently runs at
+ * @param io_handle PN532 io handle created by pn532_new_driver_hsu()
+ * @return baud rate, 0 if the handle is not an HSU driver
+ */
+int32_t pn532_hsu_get_baudrate(pn532_io_handle_t io_handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PN532_DRIVER_HSU_H
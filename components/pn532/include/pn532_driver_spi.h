@@ -0,0 +1,59 @@
+//
+// Created by dirki on 04.07.25.
+//
+
+#ifndef PN532_DRIVER_SPI_H
+#define PN532_DRIVER_SPI_H
+
+#include "driver/gpio.h"
+#include "driver/spi_common.h"
+#include "pn532_driver.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * SPI bus counters, for comparing transports and modes.
+ * Throughput is (bytes_rx + bytes_tx) / bus_busy_us; occupancy is bus_busy_us over wall time.
+ */
+typedef struct {
+    uint32_t transactions;      // Completed SPI transactions (status polls included)
+    uint32_t status_polls;      // STATREAD transactions issued to find out if a frame is ready
+    uint32_t irq_waits;         // Reads that blocked on the IRQ interrupt because no frame was pending yet
+    uint32_t bytes_tx;          // Payload bytes sent, excluding the opcode
+    uint32_t bytes_rx;          // Payload bytes received, excluding the opcode
+    uint64_t bus_busy_us;       // Time spent inside SPI transactions
+} pn532_spi_stats_t;
+
+esp_err_t pn532_new_driver_spi(gpio_num_t miso,
+                               gpio_num_t mosi,
+                               gpio_num_t sck,
+                               gpio_num_t cs,
+                               gpio_num_t reset,
+                               gpio_num_t irq,
+                               spi_host_device_t spi_host,
+                               int32_t clock_frequency,
+                               pn532_io_handle_t io_handle);
+
+/**
+ * Get the bus counters of an SPI driver
+ * @param io_handle PN532 io handle created by pn532_new_driver_spi()
+ * @param stats receives the counters
+ * @return ESP_OK if successful, ESP_ERR_INVALID_ARG if the handle is not an SPI driver
+ */
+esp_err_t pn532_spi_get_stats(pn532_io_handle_t io_handle, pn532_spi_stats_t *stats);
+
+/**
+ * Clear the bus counters of an SPI driver
+ * @param io_handle PN532 io handle created by pn532_new_driver_spi()
+ * @return ESP_OK if successful
+ */
+esp_err_t pn532_spi_reset_stats(pn532_io_handle_t io_handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //PN532_DRIVER_SPI_H
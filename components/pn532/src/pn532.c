@@ -17,6 +17,8 @@ static const char TAG[] = "PN532";
 const uint8_t pn532response_firmwarevers[] = {0x00, 0xFF, 0x06, 0xFA, 0xD5, 0x03};
 
 static uint8_t pn532_inListedTag;  // Tg number of inlisted tag.
+static uint16_t pn532_lastSensRes; // ATQA of the last target found by pn532_read_passive_target_id()
+static uint8_t pn532_lastSelRes;   // SAK of the last target found by pn532_read_passive_target_id()
 
 #define PN532_COMMAND_BUFFER_LEN 64
 uint8_t pn532_packetbuffer[PN532_COMMAND_BUFFER_LEN];
@@ -109,6 +111,9 @@ esp_err_t pn532_read_passive_target_id(pn532_io_handle_t io_handle,
 #ifdef CONFIG_PN532DEBUG
         ESP_LOGD(TAG, "PN532 not ready, timeout or error occurred");
 #endif
+        // No card within the timeout: stop the PN532 from searching
+        if (ESP_ERR_TIMEOUT == err)
+            pn532_abort_command(io_handle);
         return err;
     }
     err = pn532_read_data(io_handle, pn532_packetbuffer, 32, timeout);
@@ -133,11 +138,12 @@ esp_err_t pn532_read_passive_target_id(pn532_io_handle_t io_handle,
     if (pn532_packetbuffer[7] != 1)
         return ESP_FAIL;
 
-#ifdef CONFIG_MIFAREDEBUG
-    uint16_t sens_res = pn532_packetbuffer[9] << 8 | pn532_packetbuffer[10];
+    pn532_lastSensRes = pn532_packetbuffer[9] << 8 | pn532_packetbuffer[10];
+    pn532_lastSelRes = pn532_packetbuffer[11];
 
-    ESP_LOGD(TAG, "ATQA: 0x%.2X", sens_res);
-    ESP_LOGD(TAG, "SAK: 0x%.2X", pn532_packetbuffer[11]);
+#ifdef CONFIG_MIFAREDEBUG
+    ESP_LOGD(TAG, "ATQA: 0x%.2X", pn532_lastSensRes);
+    ESP_LOGD(TAG, "SAK: 0x%.2X", pn532_lastSelRes);
 #endif
 
     /* Card appears to be Mifare Classic */
@@ -299,6 +305,101 @@ esp_err_t pn532_in_list_passive_target(pn532_io_handle_t io_handle) {
     return ESP_FAIL;
 }
 
+esp_err_t pn532_get_passive_target_info(pn532_io_handle_t io_handle, uint16_t *atqa, uint8_t *sak)
+{
+    if (io_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (atqa != NULL)
+        *atqa = pn532_lastSensRes;
+    if (sak != NULL)
+        *sak = pn532_lastSelRes;
+
+    return ESP_OK;
+}
+
+esp_err_t mifareclassic_authenticate_block(pn532_io_handle_t io_handle, const uint8_t *uid, uint8_t uid_length,
+                                           uint8_t block, uint8_t key_type, const uint8_t *key)
+{
+    if (io_handle == NULL || uid == NULL || key == NULL || uid_length < 4 ||
+        (key_type != MIFARE_CMD_AUTH_A && key_type != MIFARE_CMD_AUTH_B)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pn532_packetbuffer[0] = PN532_COMMAND_INDATAEXCHANGE;
+    pn532_packetbuffer[1] = 1; /* Card number */
+    pn532_packetbuffer[2] = key_type;
+    pn532_packetbuffer[3] = block;
+    memcpy(&pn532_packetbuffer[4], key, 6);
+    /* Crypto1 is keyed with the last 4 UID bytes (UID3..UID6 for 7 byte UIDs) */
+    memcpy(&pn532_packetbuffer[10], uid + uid_length - 4, 4);
+
+#ifdef CONFIG_MIFAREDEBUG
+    ESP_LOGD(TAG, "Authenticating block %d with key %c", block, key_type == MIFARE_CMD_AUTH_A ? 'A' : 'B');
+#endif
+
+    esp_err_t err = pn532_send_command_wait_ack(io_handle, pn532_packetbuffer, 14, PN532_WRITE_TIMEOUT);
+    if (err != ESP_OK)
+        return err;
+
+    err = pn532_wait_ready(io_handle, 100);
+    if (err != ESP_OK)
+        return err;
+
+    err = pn532_read_data(io_handle, pn532_packetbuffer, 10, PN532_READ_TIMEOUT);
+    if (err != ESP_OK)
+        return err;
+
+    if (pn532_packetbuffer[6] != PN532_RESPONSE_INDATAEXCHANGE) {
+        return ESP_FAIL;
+    }
+
+    /* 0x14 is a Mifare authentication error; the card is halted and must be re-selected */
+    if ((pn532_packetbuffer[7] & 0x3F) != 0x00) {
+#ifdef CONFIG_MIFAREDEBUG
+        ESP_LOGD(TAG, "Authentication failed, status 0x%02x", pn532_packetbuffer[7]);
+#endif
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t mifareclassic_read_block(pn532_io_handle_t io_handle, uint8_t block, uint8_t *data)
+{
+    if (io_handle == NULL || data == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pn532_packetbuffer[0] = PN532_COMMAND_INDATAEXCHANGE;
+    pn532_packetbuffer[1] = 1; /* Card number */
+    pn532_packetbuffer[2] = MIFARE_CMD_READ;
+    pn532_packetbuffer[3] = block;
+
+    esp_err_t err = pn532_send_command_wait_ack(io_handle, pn532_packetbuffer, 4, PN532_WRITE_TIMEOUT);
+    if (err != ESP_OK)
+        return err;
+
+    err = pn532_wait_ready(io_handle, 100);
+    if (err != ESP_OK)
+        return err;
+
+    err = pn532_read_data(io_handle, pn532_packetbuffer, 26, PN532_READ_TIMEOUT);
+    if (err != ESP_OK)
+        return err;
+
+    if (pn532_packetbuffer[6] != PN532_RESPONSE_INDATAEXCHANGE || (pn532_packetbuffer[7] & 0x3F) != 0x00) {
+#ifdef CONFIG_MIFAREDEBUG
+        ESP_LOGD(TAG, "Read of block %d failed, status 0x%02x", block, pn532_packetbuffer[7]);
+#endif
+        return ESP_FAIL;
+    }
+
+    memcpy(data, pn532_packetbuffer + 8, 16);
+    return ESP_OK;
+}
+
 esp_err_t ntag2xx_get_model(pn532_io_handle_t io_handle, NTAG2XX_MODEL *model)
 {
     if (io_handle == NULL || model == NULL) {
@@ -336,20 +437,7 @@ esp_err_t ntag2xx_get_model(pn532_io_handle_t io_handle, NTAG2XX_MODEL *model)
 }
 
 esp_err_t ntag2xx_authenticate(pn532_io_handle_t io_handle, uint8_t page, uint8_t *key, uint8_t *uid, uint8_t uid_length) {
-    pn532_packetbuffer[0] = PN532_COMMAND_INDATAEXCHANGE;
-    pn532_packetbuffer[1] = 1;
-    pn532_packetbuffer[2] = MIFARE_CMD_AUTH_A;
-    pn532_packetbuffer[3] = page;
-
-    memcpy(&pn532_packetbuffer[4], key, 6);
-    if (uid_length > 10) {
-        uid_length = 10;
-    }
-    memcpy(&pn532_packetbuffer[10], uid, uid_length);
-
-    esp_err_t err = pn532_send_command_wait_ack(io_handle, pn532_packetbuffer, 10 + uid_length, PN532_WRITE_TIMEOUT);
-
-    return err;
+    return mifareclassic_authenticate_block(io_handle, uid, uid_length, page, MIFARE_CMD_AUTH_A, key);
 }
 
 esp_err_t ntag2xx_read_page(pn532_io_handle_t io_handle, uint8_t page, uint8_t *buffer, size_t read_len)
@@ -435,21 +523,25 @@ esp_err_t ntag2xx_read_page(pn532_io_handle_t io_handle, uint8_t page, uint8_t *
 
 esp_err_t ntag2xx_write_page(pn532_io_handle_t io_handle, uint8_t page, const uint8_t * data)
 {
-    // TAG Type       PAGES   USER START    USER STOP
-    // --------       -----   ----------    ---------
+    // TAG Type       PAGES   USER START    USER STOP   LOCK/CONFIG
+    // --------       -----   ----------    ---------   -----------
     // NTAG 203       42      4             39
-    // NTAG 213       45      4             39
-    // NTAG 215       135     4             129
-    // NTAG 216       231     4             225
+    // NTAG 213       45      4             39          40..44
+    // NTAG 215       135     4             129         130..134
+    // NTAG 216       231     4             225         226..230
 
-    if ((page < 4) || (page > 225)) {
+    // Pages 0/1 hold the UID. Pages 2/3 carry the static lock bytes and the
+    // one-time-programmable capability container: writes there OR bits in for good.
+    if ((page < 2) || (page > 230)) {
 #ifdef CONFIG_MIFAREDEBUG
         ESP_LOGD(TAG, "Page value out of range");
 #endif
-        // Return Failed Signal
-        return 0;
+        return ESP_ERR_INVALID_ARG;
     }
 
+    if (data == NULL)
+        return ESP_ERR_INVALID_ARG;
+
 #ifdef CONFIG_MIFAREDEBUG
     ESP_LOGD(TAG, "Trying to write 4 byte page %d", page);
 #endif
@@ -482,7 +574,67 @@ esp_err_t ntag2xx_write_page(pn532_io_handle_t io_handle, uint8_t page, const ui
     }
 
     /* Read the response packet */
-    err = pn532_read_data(io_handle, pn532_packetbuffer, 26, PN532_READ_TIMEOUT);
-    return err;
+    err = pn532_read_data(io_handle, pn532_packetbuffer, 10, PN532_READ_TIMEOUT);
+    if (err != ESP_OK)
+        return err;
+
+    /* The tag's 4 bit ACK/NAK is reported through the InDataExchange status byte */
+    if (pn532_packetbuffer[6] != PN532_RESPONSE_INDATAEXCHANGE || (pn532_packetbuffer[7] & 0x3F) != 0x00) {
+#ifdef CONFIG_MIFAREDEBUG
+        ESP_LOGD(TAG, "Write of page %d rejected, status 0x%02x", page, pn532_packetbuffer[7]);
+#endif
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
 }
 
+esp_err_t ntag2xx_fast_read(pn532_io_handle_t io_handle, uint8_t start_page, uint8_t end_page, uint8_t *buffer, size_t buffer_len)
+{
+    if (io_handle == NULL || buffer == NULL || end_page < start_page || end_page >= 231) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t data_len = ((size_t)end_page - start_page + 1) * 4;
+    if (end_page - start_page + 1 > NTAG2XX_FAST_READ_MAX_PAGES || buffer_len < data_len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+#ifdef CONFIG_MIFAREDEBUG
+    ESP_LOGD(TAG, "Fast reading pages %d..%d", start_page, end_page);
+#endif
+
+    pn532_packetbuffer[0] = PN532_COMMAND_INDATAEXCHANGE;
+    pn532_packetbuffer[1] = 1; /* Card number */
+    pn532_packetbuffer[2] = NTAG2XX_CMD_FAST_READ;
+    pn532_packetbuffer[3] = start_page;
+    pn532_packetbuffer[4] = end_page;
+
+    esp_err_t err = pn532_send_command_wait_ack(io_handle, pn532_packetbuffer, 5, PN532_WRITE_TIMEOUT);
+    if (err != ESP_OK)
+        return err;
+
+    err = pn532_wait_ready(io_handle, 100);
+    if (err != ESP_OK)
+        return err;
+
+    /* Frame header (7), status (1), data, DCS and postamble (2) */
+    err = pn532_read_data(io_handle, pn532_packetbuffer, (uint8_t)(data_len + 10), PN532_READ_TIMEOUT);
+    if (err != ESP_OK)
+        return err;
+
+    if (pn532_packetbuffer[6] != PN532_RESPONSE_INDATAEXCHANGE || (pn532_packetbuffer[7] & 0x3F) != 0x00) {
+#ifdef CONFIG_MIFAREDEBUG
+        ESP_LOGD(TAG, "Status byte indicates an error: 0x%02x", pn532_packetbuffer[7]);
+#endif
+        return ESP_FAIL;
+    }
+
+    /* LEN covers TFI, command code and status, anything shorter means the tag cut the read short */
+    if (pn532_packetbuffer[3] < data_len + 3) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    memcpy(buffer, pn532_packetbuffer + 8, data_len);
+    return ESP_OK;
+}
@@ -0,0 +1,222 @@
+/**
+ * @file     pn532_diag.c
+ * @license  MIT (see license.txt)
+ * Antenna self-test and RF diagnostics for the PN532.
+ */
+
+#include <string.h>
+#include "esp_log.h"
+#include "esp_err.h"
+
+#include <pn532.h>
+#include <pn532_diag.h>
+
+static const char TAG[] = "PN532_DIAG";
+
+// 00 00 FF LEN LCS D5 CMD+1 data... DCS 00
+#define PN532_DIAG_FRAME_OVERHEAD           9
+#define PN532_DIAG_DATA_OFFSET              7
+
+static const uint16_t report_registers[] = {
+    PN532_REG_CIU_TXCONTROL,
+    PN532_REG_CIU_RFCFG,
+    PN532_REG_CIU_GSNON,
+    PN532_REG_CIU_CWGSP,
+    PN532_REG_CIU_ERROR,
+    PN532_REG_CIU_STATUS1,
+    PN532_REG_CIU_STATUS2,
+    PN532_REG_CIU_COLL,
+};
+
+/**
+ * Send a command, wait for the response and check its command code.
+ */
+static esp_err_t diag_exchange(pn532_io_handle_t io_handle, uint8_t *buffer, uint8_t cmd_length,
+                               uint8_t response_length, int32_t ready_timeout)
+{
+    uint8_t command = buffer[0];
+
+    esp_err_t err = pn532_send_command_wait_ack(io_handle, buffer, cmd_length, PN532_WRITE_TIMEOUT);
+    if (err != ESP_OK)
+        return err;
+
+    err = pn532_wait_ready(io_handle, ready_timeout);
+    if (err != ESP_OK)
+        return err;
+
+    err = pn532_read_data(io_handle, buffer, response_length, PN532_READ_TIMEOUT);
+    if (err != ESP_OK)
+        return err;
+
+    if (buffer[5] != PN532_PN532TOHOST || buffer[6] != command + 1) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t pn532_diag_antenna_test(pn532_io_handle_t io_handle, uint8_t param, uint8_t *status)
+{
+    uint8_t buffer[16];
+
+    if (io_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    buffer[0] = PN532_COMMAND_DIAGNOSE;
+    buffer[1] = PN532_DIAG_TEST_ANTENNA;
+    buffer[2] = param;
+
+    esp_err_t err = diag_exchange(io_handle, buffer, 3, 10, 1000);
+    if (err != ESP_OK)
+        return err;
+
+    if (status != NULL)
+        *status = buffer[PN532_DIAG_DATA_OFFSET];
+
+    return buffer[PN532_DIAG_DATA_OFFSET] == 0x00 ? ESP_OK : ESP_ERR_INVALID_RESPONSE;
+}
+
+esp_err_t pn532_read_registers(pn532_io_handle_t io_handle, const uint16_t *addresses, uint8_t *values, size_t count)
+{
+    uint8_t buffer[1 + 2 * PN532_DIAG_MAX_REGISTERS + PN532_DIAG_FRAME_OVERHEAD];
+
+    if (io_handle == NULL || addresses == NULL || values == NULL || count == 0 || count > PN532_DIAG_MAX_REGISTERS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    buffer[0] = PN532_COMMAND_READREGISTER;
+    for (size_t n = 0; n < count; ++n) {
+        buffer[1 + 2 * n] = addresses[n] >> 8;
+        buffer[2 + 2 * n] = addresses[n] & 0xFF;
+    }
+
+    esp_err_t err = diag_exchange(io_handle, buffer, 1 + 2 * count, count + PN532_DIAG_FRAME_OVERHEAD, 100);
+    if (err != ESP_OK)
+        return err;
+
+    memcpy(values, buffer + PN532_DIAG_DATA_OFFSET, count);
+    return ESP_OK;
+}
+
+esp_err_t pn532_write_registers(pn532_io_handle_t io_handle, const uint16_t *addresses, const uint8_t *values, size_t count)
+{
+    uint8_t buffer[1 + 3 * PN532_DIAG_MAX_REGISTERS];
+
+    if (io_handle == NULL || addresses == NULL || values == NULL || count == 0 || count > PN532_DIAG_MAX_REGISTERS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    buffer[0] = PN532_COMMAND_WRITEREGISTER;
+    for (size_t n = 0; n < count; ++n) {
+        buffer[1 + 3 * n] = addresses[n] >> 8;
+        buffer[2 + 3 * n] = addresses[n] & 0xFF;
+        buffer[3 + 3 * n] = values[n];
+    }
+
+    return diag_exchange(io_handle, buffer, 1 + 3 * count, PN532_DIAG_FRAME_OVERHEAD, 100);
+}
+
+esp_err_t pn532_get_general_status(pn532_io_handle_t io_handle, uint8_t *last_error, bool *external_field, uint8_t *targets)
+{
+    // Err Field NbTg, up to two targets of 4 bytes, SAM status
+    uint8_t buffer[3 + 2 * 4 + 1 + PN532_DIAG_FRAME_OVERHEAD];
+
+    if (io_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    buffer[0] = PN532_COMMAND_GETGENERALSTATUS;
+
+    esp_err_t err = diag_exchange(io_handle, buffer, 1, sizeof(buffer), 100);
+    if (err != ESP_OK)
+        return err;
+
+    if (last_error != NULL)
+        *last_error = buffer[PN532_DIAG_DATA_OFFSET];
+    if (external_field != NULL)
+        *external_field = buffer[PN532_DIAG_DATA_OFFSET + 1] != 0;
+    if (targets != NULL)
+        *targets = buffer[PN532_DIAG_DATA_OFFSET + 2];
+
+    return ESP_OK;
+}
+
+esp_err_t pn532_diag_run(pn532_io_handle_t io_handle, pn532_diag_report_t *report)
+{
+    uint8_t values[sizeof(report_registers) / sizeof(report_registers[0])];
+
+    if (io_handle == NULL || report == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(report, 0, sizeof(*report));
+
+    // Registers and status first: the self-test changes the RF front end state
+    esp_err_t err = pn532_read_registers(io_handle, report_registers, values, sizeof(values));
+    if (err != ESP_OK)
+        return err;
+
+    report->tx_control = values[0];
+    report->rf_cfg = values[1];
+    report->gs_n_on = values[2];
+    report->cw_gs_p = values[3];
+    report->ciu_error = values[4];
+    report->ciu_status1 = values[5];
+    report->ciu_status2 = values[6];
+    report->ciu_coll = values[7];
+
+    err = pn532_get_general_status(io_handle, &report->last_error, &report->external_field, &report->targets);
+    if (err != ESP_OK)
+        return err;
+
+    err = pn532_diag_antenna_test(io_handle, PN532_DIAG_ANTENNA_DEFAULT_PARAM, &report->antenna_status);
+    report->antenna_ok = (err == ESP_OK);
+    if (err == ESP_ERR_INVALID_RESPONSE)
+        err = ESP_OK;
+
+    return err;
+}
+
+bool pn532_diag_is_healthy(const pn532_diag_report_t *report)
+{
+    if (report == NULL)
+        return false;
+
+    if (!report->antenna_ok)
+        return false;
+
+    // Overheated drivers shut the field down
+    if (report->ciu_error & PN532_CIU_ERROR_TEMP)
+        return false;
+
+    // A foreign field swamps our receiver
+    if (report->external_field)
+        return false;
+
+    return true;
+}
+
+void pn532_diag_log(const pn532_diag_report_t *report)
+{
+    if (report == NULL)
+        return;
+
+    esp_log_level_t level = pn532_diag_is_healthy(report) ? ESP_LOG_INFO : ESP_LOG_WARN;
+
+    ESP_LOG_LEVEL(level, TAG, "Antenna: %s (status 0x%02x), external field: %s, last error: 0x%02x",
+                  report->antenna_ok ? "OK" : "OUT OF LIMITS", report->antenna_status,
+                  report->external_field ? "yes" : "no", report->last_error);
+    ESP_LOG_LEVEL(level, TAG, "TX drivers: %s/%s, RF on: %s, RFCfg 0x%02x, GsNOn 0x%02x, CWGsP 0x%02x",
+                  (report->tx_control & PN532_CIU_TXCONTROL_TX1RFEN) ? "on" : "off",
+                  (report->tx_control & PN532_CIU_TXCONTROL_TX2RFEN) ? "on" : "off",
+                  (report->ciu_status1 & PN532_CIU_STATUS1_RFON) ? "yes" : "no",
+                  report->rf_cfg, report->gs_n_on, report->cw_gs_p);
+    ESP_LOG_LEVEL(level, TAG, "CIU error 0x%02x (crc %d, parity %d, protocol %d, collision %d, temp %d), coll 0x%02x",
+                  report->ciu_error,
+                  (report->ciu_error & PN532_CIU_ERROR_CRC) != 0,
+                  (report->ciu_error & PN532_CIU_ERROR_PARITY) != 0,
+                  (report->ciu_error & PN532_CIU_ERROR_PROTOCOL) != 0,
+                  (report->ciu_error & PN532_CIU_ERROR_COLL) != 0,
+                  (report->ciu_error & PN532_CIU_ERROR_TEMP) != 0,
+                  report->ciu_coll);
+}
@@ -6,6 +6,7 @@
 #include "esp_log.h"
 #include "esp_rom_sys.h"
 #include "pn532_driver.h"
+#include "pn532_transport.h"
 
 static const char TAG[] = "pn532_driver";
 
@@ -86,7 +87,7 @@ esp_err_t pn532_init(pn532_io_handle_t io_handle)
 
     ESP_LOGD(TAG, "pn532_init(): call pn532_init_io() ...");
     io_handle->isSAMConfigDone = false;
-    esp_err_t err = io_handle->pn532_init_io(io_handle);
+    esp_err_t err = PN532_IO_INIT_IO(io_handle);
     if (err != ESP_OK)
         return err;
 
@@ -105,8 +106,8 @@ esp_err_t pn532_init(pn532_io_handle_t io_handle)
     io_handle->isSAMConfigDone = true;
 
     ESP_LOGD(TAG, "pn532_init(): call pn532_init_extra() ...");
-    if (io_handle->pn532_init_extra != NULL) {
-        err = io_handle->pn532_init_extra(io_handle);
+    if (PN532_IO_HAS_INIT_EXTRA(io_handle)) {
+        err = PN532_IO_INIT_EXTRA(io_handle);
         if (err != ESP_OK)
             return err;
     }
@@ -121,9 +122,7 @@ void pn532_release(pn532_io_handle_t io_handle)
         return;
 
     ESP_LOGD(TAG, "call pn532_release_io() ...");
-    if (io_handle->pn532_release_io != NULL) {
-        io_handle->pn532_release_io(io_handle);
-    }
+    PN532_IO_RELEASE_IO(io_handle);
 
 #ifdef CONFIG_ENABLE_IRQ_ISR
     if (io_handle->irq != GPIO_NUM_NC) {
@@ -155,8 +154,7 @@ void pn532_delete_driver(pn532_io_handle_t io_handle)
     if (io_handle == NULL)
         return;
 
-    if (io_handle->pn532_release_driver != NULL)
-        io_handle->pn532_release_driver(io_handle);
+    PN532_IO_RELEASE_DRIVER(io_handle);
 }
 
 void pn532_reset(pn532_io_handle_t io_handle)
@@ -200,7 +198,7 @@ esp_err_t pn532_write_command(pn532_io_handle_t io_handle, const uint8_t *cmd, u
 //    vTaskDelay(pdMS_TO_TICKS(100));
 
 //    ESP_LOGI(TAG, "going to send command ...");
-    esp_err_t result = io_handle->pn532_write(io_handle, command, idx, timeout);
+    esp_err_t result = PN532_IO_WRITE(io_handle, command, idx, timeout);
 
     if (result != ESP_OK) {
         char *resultText = NULL;
@@ -236,7 +234,7 @@ esp_err_t pn532_read_data(pn532_io_handle_t io_handle, uint8_t *buffer, uint8_t
         timeout = -1;
     }
 
-    esp_err_t res = io_handle->pn532_read(io_handle, local_buffer, length, timeout);
+    esp_err_t res = PN532_IO_READ(io_handle, local_buffer, length, timeout);
     if (res != ESP_OK) {
         return res;
     }
@@ -278,7 +276,7 @@ static esp_err_t pn532_poll_ready(pn532_io_handle_t io_handle, int32_t timeout)
     bool is_ready = false;
     while (!is_ready && elapsed_ticks <= timeout_ticks)
     {
-        is_ready = ESP_OK == io_handle->pn532_is_ready(io_handle);
+        is_ready = ESP_OK == PN532_IO_IS_READY(io_handle);
         if (!is_ready) {
             vTaskDelay(pdMS_TO_TICKS(10));
             elapsed_ticks = xTaskGetTickCount() - start_ticks;
@@ -292,7 +290,7 @@ esp_err_t pn532_wait_ready(pn532_io_handle_t io_handle, int32_t timeout)
 {
     if (io_handle->irq == GPIO_NUM_NC) {
         esp_err_t err = ESP_OK;
-        if (io_handle->pn532_is_ready != NULL) {
+        if (PN532_IO_HAS_IS_READY(io_handle)) {
             err = pn532_poll_ready(io_handle, timeout);
         }
         return err;
@@ -313,7 +311,7 @@ esp_err_t pn532_wait_ready(pn532_io_handle_t io_handle, int32_t timeout)
         return ESP_OK;
     }
 
-    return ESP_FAIL;
+    return ESP_ERR_TIMEOUT;
 #else
     uint16_t timer = 0;
     while (!pn532_is_ready(io_handle))
@@ -411,6 +409,16 @@ esp_err_t pn532_send_command_wait_ack(pn532_io_handle_t io_handle, const uint8_t
     return result;
 }
 
+esp_err_t pn532_abort_command(pn532_io_handle_t io_handle)
+{
+    if (io_handle == NULL || io_handle->driver_data == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // An ACK frame from the host aborts the command in progress; the transport adds pre- and postamble
+    return PN532_IO_WRITE(io_handle, ACK_FRAME + 1, sizeof(ACK_FRAME) - 2, PN532_WRITE_TIMEOUT);
+}
+
 esp_err_t pn532_read_ack(pn532_io_handle_t io_handle) {
     uint8_t ack_buffer[6];
     esp_err_t result;
@@ -0,0 +1,568 @@
+#include <string.h>
+#include "pn532_driver.h"
+#include "pn532_transport.h"
+#include "pn532_driver_hsu.h"
+#include "esp_log.h"
+#ifdef CONFIG_PN532_HSU_BAUD_NVS
+#include "nvs.h"
+#endif
+
+static const char TAG[] = "pn532_driver_hsu";
+
+#define PN532_HSU_BAUD_DEFAULT              0x04 // 115200 baud, the rate after power-on/reset
+#define PN532_HSU_BAUD_MAX                  0x08 // 1288000 baud
+#define PN532_HSU_VERIFY_ROUNDS             3    // GetFirmwareVersion round trips a new rate must survive
+#define PN532_HSU_MAX_CONSECUTIVE_ERRORS    3    // Bad frames in a row before the next boot starts lower
+#define PN532_HSU_NVS_NAMESPACE             "pn532"
+#define PN532_HSU_NVS_KEY                   "hsu_baud"
+
+#define PN532_HSU_WAKEUP_LEN                10
+#define PN532_HSU_FRAME_BUFFER_LEN          (PN532_HSU_WAKEUP_LEN + 1 + 256 + 1)
+
+typedef struct {
+    gpio_num_t uart_rx;
+    gpio_num_t uart_tx;
+    uart_port_t uart_port;
+    uint8_t uart_baud_wanted;
+    uint8_t uart_baud_used;
+    bool auto_baud;
+    uint8_t consecutive_errors;
+    uint8_t frame_buffer[PN532_HSU_FRAME_BUFFER_LEN];
+} pn532_hsu_driver_config;
+
+const int32_t baud_config_table[] = {
+        9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600, 1288000
+};
+
+static const uint8_t get_firmware_frame[] = { 0x00, 0xFF, 0x02, 0xFE, 0xD4, 0x02, 0x2A };
+static const uint8_t set_serial_baud_rate_resp_frame[] = { 0x00, 0x00, 0xFF, 0x02, 0xFE, 0xD5, 0x11, 0x1A, 0x00 };
+static const uint8_t wakeup_frame[PN532_HSU_WAKEUP_LEN] = { 0x55, 0x55, 0x55, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+#ifdef CONFIG_PN532_TRANSPORT_MULTI
+const pn532_transport_ops_t pn532_transport_ops_hsu = {
+    .init_io = pn532_hsu_init_io,
+    .release_io = pn532_hsu_release_io,
+    .release_driver = pn532_hsu_release_driver,
+    .read = pn532_hsu_read,
+    .write = pn532_hsu_write,
+    .init_extra = pn532_hsu_init_extra,
+    .is_ready = NULL,
+};
+#endif
+
+esp_err_t pn532_new_driver_hsu(gpio_num_t uart_rx,
+                               gpio_num_t uart_tx,
+                               gpio_num_t reset,
+                               gpio_num_t irq,
+                               uart_port_t uart_port,
+                               int32_t baudrate,
+                               pn532_io_handle_t io_handle)
+{
+    if (io_handle == NULL)
+        return ESP_ERR_INVALID_ARG;
+
+    if (uart_rx == GPIO_NUM_NC
+        || uart_tx == GPIO_NUM_NC
+        || uart_port >= UART_NUM_MAX)
+        return ESP_ERR_INVALID_ARG;
+
+    pn532_hsu_driver_config *dev_config = heap_caps_calloc(1, sizeof(pn532_hsu_driver_config), MALLOC_CAP_DEFAULT);
+    if (dev_config == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    io_handle->reset = reset;
+    io_handle->irq = irq;
+
+    dev_config->uart_port = uart_port;
+    dev_config->uart_rx = uart_rx;
+    dev_config->uart_tx = uart_tx;
+    dev_config->uart_baud_wanted = PN532_HSU_BAUD_DEFAULT;
+    dev_config->auto_baud = (baudrate == PN532_HSU_BAUD_AUTO);
+    if (dev_config->auto_baud) {
+        dev_config->uart_baud_wanted = PN532_HSU_BAUD_MAX;
+    }
+    for (int n=0; n < (sizeof(baud_config_table)/ sizeof(baud_config_table[0])); ++n) {
+        if (baud_config_table[n] == baudrate) {
+            dev_config->uart_baud_wanted = n;
+            break;
+        }
+    }
+    io_handle->driver_data = dev_config;
+
+    if (!dev_config->auto_baud && baud_config_table[dev_config->uart_baud_wanted] != baudrate) {
+        ESP_LOGW(TAG, "pn532_new_driver_hsu(): Unsupported baud rate %ld -> using standard baud rate 115200", baudrate);
+    }
+
+#ifdef CONFIG_PN532_TRANSPORT_MULTI
+    pn532_transport_install(io_handle, &pn532_transport_ops_hsu);
+#endif
+
+#ifdef CONFIG_ENABLE_IRQ_ISR
+    io_handle->IRQQueue = NULL;
+#endif
+
+    return ESP_OK;
+}
+
+void pn532_hsu_release_driver(pn532_io_handle_t io_handle)
+{
+    if (io_handle == NULL || io_handle->driver_data == NULL)
+        return;
+
+    pn532_hsu_driver_config *driver_config = (pn532_hsu_driver_config *)io_handle->driver_data;
+    pn532_hsu_release_io(io_handle);
+    io_handle->driver_data = NULL;
+    free(driver_config);
+}
+
+#ifdef CONFIG_PN532_HSU_BAUD_NVS
+static bool hsu_load_baud(uint8_t *index)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(PN532_HSU_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK)
+        return false;
+
+    esp_err_t err = nvs_get_u8(nvs, PN532_HSU_NVS_KEY, index);
+    nvs_close(nvs);
+    return err == ESP_OK && *index > PN532_HSU_BAUD_DEFAULT && *index <= PN532_HSU_BAUD_MAX;
+}
+
+static void hsu_store_baud(uint8_t index)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(PN532_HSU_NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK)
+        return;
+
+    uint8_t stored = 0;
+    if (nvs_get_u8(nvs, PN532_HSU_NVS_KEY, &stored) != ESP_OK || stored != index) {
+        if (nvs_set_u8(nvs, PN532_HSU_NVS_KEY, index) == ESP_OK)
+            nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+}
+#else
+static bool hsu_load_baud(uint8_t *index)
+{
+    return false;
+}
+
+static void hsu_store_baud(uint8_t index)
+{
+}
+#endif
+
+/**
+ * Round-trip GetFirmwareVersion at the current rate. Any timeout, framing or
+ * checksum problem shows up as a failed pn532_hsu_read().
+ */
+static esp_err_t hsu_verify_link(pn532_io_handle_t io_handle, int rounds)
+{
+    uint8_t buf[16];
+
+    for (int n = 0; n < rounds; ++n) {
+        esp_err_t err = pn532_hsu_write(io_handle, get_firmware_frame, sizeof(get_firmware_frame), 100);
+        if (err != ESP_OK)
+            return err;
+
+        err = pn532_hsu_read(io_handle, buf, sizeof(ACK_FRAME), 100);
+        if (err != ESP_OK)
+            return err;
+        if (0 != memcmp(buf, ACK_FRAME, sizeof(ACK_FRAME)))
+            return ESP_FAIL;
+
+        err = pn532_hsu_read(io_handle, buf, sizeof(buf), 100);
+        if (err != ESP_OK)
+            return err;
+        if (buf[5] != PN532_PN532TOHOST || buf[6] != 0x03)
+            return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t pn532_hsu_init_io(pn532_io_handle_t io_handle)
+{
+    if (io_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (io_handle->driver_data == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pn532_hsu_driver_config *driver_config = (pn532_hsu_driver_config *)io_handle->driver_data;
+
+    driver_config->uart_baud_used = PN532_HSU_BAUD_DEFAULT;
+    driver_config->consecutive_errors = 0;
+    uart_config_t uart_config = {
+            .baud_rate = baud_config_table[driver_config->uart_baud_used],
+            .data_bits = UART_DATA_8_BITS,
+            .parity    = UART_PARITY_DISABLE,
+            .stop_bits = UART_STOP_BITS_1,
+            .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+            .source_clk = UART_SCLK_DEFAULT,
+    };
+
+    if(ESP_OK != uart_driver_install(driver_config->uart_port, 512, 0, 0, NULL, 0)) {
+        ESP_LOGE(TAG, "uart_driver_install() failed");
+        return ESP_FAIL;
+    }
+
+    if (ESP_OK != uart_param_config(driver_config->uart_port, &uart_config)) {
+        ESP_LOGE(TAG, "uart_param_config() failed");
+        return ESP_FAIL;
+    }
+    if (ESP_OK != uart_set_pin(driver_config->uart_port, driver_config->uart_tx,
+                               driver_config->uart_rx, GPIO_NUM_NC, GPIO_NUM_NC)) {
+        ESP_LOGE(TAG, "uart_set_pin() failed");
+        return ESP_FAIL;
+    }
+
+    ESP_LOGD(TAG, "pn532_hsu_init_io(): check baud rate %ld ...", baud_config_table[driver_config->uart_baud_used]);
+    if (hsu_verify_link(io_handle, 1) == ESP_OK) {
+        return ESP_OK;
+    }
+
+    // Without a reset line the PN532 may still run at the rate of the previous session
+    uint8_t previous = driver_config->uart_baud_wanted;
+    if (driver_config->auto_baud && !hsu_load_baud(&previous))
+        return ESP_FAIL;
+    if (previous == driver_config->uart_baud_used)
+        return ESP_FAIL;
+
+    ESP_LOGD(TAG, "pn532_hsu_init_io(): try previous baud rate %ld ...", baud_config_table[previous]);
+    uart_flush_input(driver_config->uart_port);
+    esp_err_t err = uart_set_baudrate(driver_config->uart_port, baud_config_table[previous]);
+    if (err != ESP_OK)
+        return err;
+    driver_config->uart_baud_used = previous;
+
+    return hsu_verify_link(io_handle, 1);
+}
+
+void pn532_hsu_release_io(pn532_io_handle_t io_handle)
+{
+    if (io_handle == NULL || io_handle->driver_data == NULL)
+        return;
+
+    pn532_hsu_driver_config *driver_config = (pn532_hsu_driver_config *)io_handle->driver_data;
+
+    if (uart_is_driver_installed(driver_config->uart_port))
+        uart_driver_delete(driver_config->uart_port);
+}
+
+/**
+ * Ask the PN532 to switch to another rate and follow it on the ESP side.
+ */
+static esp_err_t hsu_set_serial_baud_rate(pn532_io_handle_t io_handle, uint8_t baud_index)
+{
+    pn532_hsu_driver_config *driver_config = (pn532_hsu_driver_config *)io_handle->driver_data;
+    uint8_t buf[16];
+
+    // SetSerialBaudRate Frame
+    buf[0] = 0x00;
+    buf[1] = 0xFF;
+    buf[2] = 0x03;
+    buf[3] = 0xFD;
+    buf[4] = 0xD4;
+    buf[5] = 0x10;
+    buf[6] = baud_index;
+    buf[7] = ~(buf[4] + buf[5] + buf[6]) + 1;
+
+    ESP_LOGD(TAG, "hsu_set_serial_baud_rate() write set serial frame");
+    // write SetSerialBaudRate command
+    esp_err_t err = pn532_hsu_write(io_handle, buf, 8, 100);
+    if (err != ESP_OK)
+        return err;
+
+    ESP_LOGD(TAG, "hsu_set_serial_baud_rate() try to read ACK ...");
+    // read ACK
+    err = pn532_hsu_read(io_handle, buf, sizeof(ACK_FRAME), 100);
+    if (err != ESP_OK)
+        return err;
+
+    ESP_LOGD(TAG, "hsu_set_serial_baud_rate() received ACK or NACK:");
+    ESP_LOG_BUFFER_HEXDUMP(TAG, buf, 6, ESP_LOG_DEBUG);
+    if (0 != memcmp(buf, ACK_FRAME, sizeof(ACK_FRAME)))
+        return ESP_FAIL;
+
+    ESP_LOGD(TAG, "hsu_set_serial_baud_rate() try to read response frame ...");
+    // read response
+    err = pn532_hsu_read(io_handle, buf, sizeof(set_serial_baud_rate_resp_frame), 100);
+    if (err != ESP_OK)
+        return err;
+
+    ESP_LOGD(TAG, "hsu_set_serial_baud_rate() received response frame:");
+    ESP_LOG_BUFFER_HEXDUMP(TAG, buf, sizeof(set_serial_baud_rate_resp_frame), ESP_LOG_DEBUG);
+    if (0 != memcmp(buf, set_serial_baud_rate_resp_frame, sizeof(set_serial_baud_rate_resp_frame)))
+        return ESP_FAIL;
+
+    ESP_LOGD(TAG, "hsu_set_serial_baud_rate() write ACK frame");
+    err = pn532_hsu_write(io_handle, ACK_FRAME + 1, sizeof(ACK_FRAME) - 2, 100);
+    if (err != ESP_OK)
+        return err;
+
+    // wait a little bit before changing UART baud rate
+    vTaskDelay(2);
+
+    ESP_LOGD(TAG, "hsu_set_serial_baud_rate() change UART baud rate");
+    // change baud rate
+    err = uart_set_baudrate(driver_config->uart_port, baud_config_table[baud_index]);
+    if (err != ESP_OK)
+        return err;
+    driver_config->uart_baud_used = baud_index;
+    uart_flush_input(driver_config->uart_port);
+
+    return ESP_OK;
+}
+
+/**
+ * Get back to 115200 baud after a rate did not work out: first by asking the
+ * PN532 at the failed rate, then with a hardware reset if a reset line exists.
+ */
+static esp_err_t hsu_recover(pn532_io_handle_t io_handle)
+{
+    pn532_hsu_driver_config *driver_config = (pn532_hsu_driver_config *)io_handle->driver_data;
+
+    uart_flush_input(driver_config->uart_port);
+    if (hsu_set_serial_baud_rate(io_handle, PN532_HSU_BAUD_DEFAULT) == ESP_OK &&
+        hsu_verify_link(io_handle, 1) == ESP_OK) {
+        return ESP_OK;
+    }
+
+    if (io_handle->reset == GPIO_NUM_NC)
+        return ESP_FAIL;
+
+    ESP_LOGD(TAG, "hsu_recover(): reset PN532 to get back to %ld baud", baud_config_table[PN532_HSU_BAUD_DEFAULT]);
+    pn532_reset(io_handle);
+    esp_err_t err = uart_set_baudrate(driver_config->uart_port, baud_config_table[PN532_HSU_BAUD_DEFAULT]);
+    if (err != ESP_OK)
+        return err;
+    driver_config->uart_baud_used = PN532_HSU_BAUD_DEFAULT;
+    uart_flush_input(driver_config->uart_port);
+
+    err = pn532_SAM_config(io_handle);
+    if (err != ESP_OK)
+        return err;
+    io_handle->isSAMConfigDone = true;
+    return ESP_OK;
+}
+
+esp_err_t pn532_hsu_init_extra(pn532_io_handle_t io_handle)
+{
+    if (io_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (io_handle->driver_data == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pn532_hsu_driver_config *driver_config = (pn532_hsu_driver_config *)io_handle->driver_data;
+
+    // Start at the rate that worked last time, otherwise at the highest allowed one
+    uint8_t baud_index = driver_config->uart_baud_wanted;
+    if (driver_config->auto_baud) {
+        uint8_t stored;
+        if (hsu_load_baud(&stored) && stored <= driver_config->uart_baud_wanted)
+            baud_index = stored;
+    }
+
+    for (; baud_index > PN532_HSU_BAUD_DEFAULT; --baud_index) {
+        if (driver_config->uart_baud_used == baud_index)
+            break;
+
+        ESP_LOGD(TAG, "pn532_hsu_init_extra() try %ld baud", baud_config_table[baud_index]);
+        esp_err_t err = hsu_set_serial_baud_rate(io_handle, baud_index);
+        if (err == ESP_OK)
+            err = hsu_verify_link(io_handle, PN532_HSU_VERIFY_ROUNDS);
+        if (err == ESP_OK)
+            break;
+
+        ESP_LOGW(TAG, "%ld baud not stable, falling back", baud_config_table[baud_index]);
+        err = hsu_recover(io_handle);
+        if (err != ESP_OK)
+            return err;
+    }
+
+    if (baud_index < PN532_HSU_BAUD_DEFAULT) {
+        // Slower than the default was explicitly requested
+        esp_err_t err = hsu_set_serial_baud_rate(io_handle, baud_index);
+        if (err != ESP_OK)
+            return err;
+    }
+
+    if (driver_config->auto_baud)
+        hsu_store_baud(driver_config->uart_baud_used);
+
+    ESP_LOGI(TAG, "HSU link at %ld baud", baud_config_table[driver_config->uart_baud_used]);
+    return ESP_OK;
+}
+
+int32_t pn532_hsu_get_baudrate(pn532_io_handle_t io_handle)
+{
+    if (io_handle == NULL || io_handle->driver_data == NULL || !PN532_IO_IS(io_handle, hsu))
+        return 0;
+
+    pn532_hsu_driver_config *driver_config = (pn532_hsu_driver_config *)io_handle->driver_data;
+    return baud_config_table[driver_config->uart_baud_used];
+}
+
+/**
+ * Count a bad frame. The stream is resynchronised by dropping whatever is left in
+ * the receive buffer; a link that keeps failing is remembered one rate lower so the
+ * next pn532_init() does not start at a rate that is known to be marginal.
+ */
+static esp_err_t hsu_frame_error(pn532_hsu_driver_config *driver_config, esp_err_t err)
+{
+    uart_flush_input(driver_config->uart_port);
+
+    if (++driver_config->consecutive_errors == PN532_HSU_MAX_CONSECUTIVE_ERRORS &&
+        driver_config->auto_baud && driver_config->uart_baud_used > PN532_HSU_BAUD_DEFAULT) {
+        ESP_LOGW(TAG, "Repeated frame errors at %ld baud, next init starts at %ld",
+                 baud_config_table[driver_config->uart_baud_used],
+                 baud_config_table[driver_config->uart_baud_used - 1]);
+        hsu_store_baud(driver_config->uart_baud_used - 1);
+    }
+    return err;
+}
+
+esp_err_t pn532_hsu_read(pn532_io_handle_t io_handle, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms)
+{
+    if (io_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (io_handle->driver_data == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (read_buffer == NULL || read_size < 6) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pn532_hsu_driver_config *driver_config = (pn532_hsu_driver_config *)io_handle->driver_data;
+    TickType_t start_ticks = xTaskGetTickCount();
+    TickType_t timeout_ticks = (xfer_timeout_ms > 0) ? pdMS_TO_TICKS(xfer_timeout_ms) + 1 : portMAX_DELAY;
+
+    int rx_bytes = 0;
+    TickType_t elapsed_ticks = 0;
+
+    // Every frame starts with 00 FF; skip line noise in front of it
+    rx_bytes = uart_read_bytes(driver_config->uart_port, read_buffer, 3, timeout_ticks);
+    if (rx_bytes != 3) {
+        if (rx_bytes < 0)
+            return ESP_FAIL;
+        return ESP_ERR_TIMEOUT;
+    }
+    int skipped = 0;
+    while (!(read_buffer[1] == PN532_STARTCODE1 && read_buffer[2] == PN532_STARTCODE2)) {
+        if (++skipped > PN532_HSU_WAKEUP_LEN)
+            return hsu_frame_error(driver_config, ESP_FAIL);
+        read_buffer[0] = read_buffer[1];
+        read_buffer[1] = read_buffer[2];
+        elapsed_ticks = xTaskGetTickCount() - start_ticks;
+        if (elapsed_ticks >= timeout_ticks ||
+            uart_read_bytes(driver_config->uart_port, read_buffer + 2, 1, timeout_ticks - elapsed_ticks) != 1)
+            return ESP_ERR_TIMEOUT;
+    }
+    read_buffer[0] = PN532_PREAMBLE;
+
+    elapsed_ticks = xTaskGetTickCount() - start_ticks;
+    if (elapsed_ticks >= timeout_ticks)
+        return ESP_ERR_TIMEOUT;
+
+    rx_bytes = uart_read_bytes(driver_config->uart_port, read_buffer + 3, 3, timeout_ticks - elapsed_ticks);
+    if (rx_bytes != 3) {
+        if (rx_bytes < 0)
+            return ESP_FAIL;
+        return ESP_ERR_TIMEOUT;
+    }
+
+    if (0 == memcmp(read_buffer, ACK_FRAME, sizeof(ACK_FRAME))) {
+        driver_config->consecutive_errors = 0;
+        return ESP_OK;
+    }
+
+    if (0 == memcmp(read_buffer, NACK_FRAME, sizeof(NACK_FRAME))) {
+        return ESP_OK;
+    }
+
+    uint8_t len = read_buffer[3];
+    uint8_t lcs = read_buffer[4];
+    if (0 != ((len + lcs) & 0xFF)) {
+        return hsu_frame_error(driver_config, ESP_FAIL);
+    }
+
+    elapsed_ticks = xTaskGetTickCount() - start_ticks;
+    if (elapsed_ticks >= timeout_ticks)
+        return ESP_ERR_TIMEOUT;
+
+    // Rest of the frame by length: data, DCS and postamble
+    int bytes_to_read = len + 1;
+    bool frame_truncated = false;
+    if (bytes_to_read > (read_size - 6)) {
+        bytes_to_read = (int)read_size - 6;
+        frame_truncated = true;
+    }
+    rx_bytes = uart_read_bytes(driver_config->uart_port, read_buffer + 6, bytes_to_read, timeout_ticks - elapsed_ticks);
+    if (rx_bytes != bytes_to_read) {
+        if (rx_bytes < 0)
+            return ESP_FAIL;
+        return hsu_frame_error(driver_config, ESP_ERR_TIMEOUT);
+    }
+
+    if (frame_truncated) {
+        // Drop the tail so the next frame starts clean
+        uart_flush_input(driver_config->uart_port);
+    }
+    else {
+        uint8_t csum = 0;
+        uint8_t *data_ptr = read_buffer + 5;
+        for (int n=0; n < len; ++n) {
+            csum += *data_ptr++;
+        }
+        csum += *data_ptr; // add DCS
+        if (csum != 0) {
+            ESP_LOGD(TAG, "pn532_hsu_read(): data checksum mismatch!");
+            return hsu_frame_error(driver_config, ESP_FAIL);
+        }
+    }
+
+    driver_config->consecutive_errors = 0;
+    return ESP_OK;
+}
+
+esp_err_t pn532_hsu_write(pn532_io_handle_t io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms)
+{
+    if (io_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (io_handle->driver_data == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (write_size > 256) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    pn532_hsu_driver_config *driver_config = (pn532_hsu_driver_config *)io_handle->driver_data;
+
+    // Wakeup (if needed), preamble, frame and postamble go out as one write
+    size_t idx = 0;
+    if (!io_handle->isSAMConfigDone) {
+        memcpy(driver_config->frame_buffer, wakeup_frame, sizeof(wakeup_frame));
+        idx += sizeof(wakeup_frame);
+    }
+    driver_config->frame_buffer[idx++] = PN532_PREAMBLE;
+    memcpy(driver_config->frame_buffer + idx, write_buffer, write_size);
+    idx += write_size;
+    driver_config->frame_buffer[idx++] = PN532_POSTAMBLE;
+
+    int result = uart_write_bytes(driver_config->uart_port, driver_config->frame_buffer, idx);
+    if (result != (int)idx) return ESP_FAIL;
+
+    TickType_t timeout_ticks = (xfer_timeout_ms > 0) ? pdMS_TO_TICKS(xfer_timeout_ms) + 1 : portMAX_DELAY;
+    return uart_wait_tx_done(driver_config->uart_port, timeout_ticks);
+}
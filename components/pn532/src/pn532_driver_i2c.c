@@ -1,5 +1,6 @@
 #include <string.h>
 #include "pn532_driver.h"
+#include "pn532_transport.h"
 #include "pn532_driver_i2c.h"
 #include "esp_log.h"
 
@@ -17,12 +18,17 @@ typedef struct {
     uint8_t frame_buffer[256];
 } pn532_i2c_driver_config;
 
-static esp_err_t pn532_init_io(pn532_io_handle_t io_handle);
-static void pn532_release_driver(pn532_io_handle_t io_handle);
-static void pn532_release_io(pn532_io_handle_t io_handle);
-static esp_err_t pn532_read(pn532_io_handle_t io_handle, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms);
-static esp_err_t pn532_write(pn532_io_handle_t io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms);
-static esp_err_t pn532_is_ready(pn532_io_handle_t io_handle);
+#ifdef CONFIG_PN532_TRANSPORT_MULTI
+const pn532_transport_ops_t pn532_transport_ops_i2c = {
+    .init_io = pn532_i2c_init_io,
+    .release_io = pn532_i2c_release_io,
+    .release_driver = pn532_i2c_release_driver,
+    .read = pn532_i2c_read,
+    .write = pn532_i2c_write,
+    .init_extra = NULL,
+    .is_ready = pn532_i2c_is_ready,
+};
+#endif
 
 esp_err_t pn532_new_driver_i2c(gpio_num_t sda,
                                gpio_num_t scl,
@@ -53,13 +59,9 @@ esp_err_t pn532_new_driver_i2c(gpio_num_t sda,
     dev_config->bus_created = false;
     io_handle->driver_data = dev_config;
 
-    io_handle->pn532_init_io = pn532_init_io;
-    io_handle->pn532_release_io = pn532_release_io;
-    io_handle->pn532_release_driver = pn532_release_driver;
-    io_handle->pn532_read = pn532_read;
-    io_handle->pn532_write = pn532_write;
-    io_handle->pn532_init_extra = NULL;
-    io_handle->pn532_is_ready = pn532_is_ready;
+#ifdef CONFIG_PN532_TRANSPORT_MULTI
+    pn532_transport_install(io_handle, &pn532_transport_ops_i2c);
+#endif
 
 #ifdef CONFIG_ENABLE_IRQ_ISR
     io_handle->IRQQueue = NULL;
@@ -68,18 +70,18 @@ esp_err_t pn532_new_driver_i2c(gpio_num_t sda,
     return ESP_OK;
 }
 
-void pn532_release_driver(pn532_io_handle_t io_handle)
+void pn532_i2c_release_driver(pn532_io_handle_t io_handle)
 {
     if (io_handle == NULL || io_handle->driver_data == NULL)
         return;
 
-    pn532_release_io(io_handle);
+    pn532_i2c_release_io(io_handle);
 
     free(io_handle->driver_data);
     io_handle->driver_data = NULL;
 }
 
-esp_err_t pn532_init_io(pn532_io_handle_t io_handle)
+esp_err_t pn532_i2c_init_io(pn532_io_handle_t io_handle)
 {
     if (io_handle == NULL || io_handle->driver_data == NULL) {
         return ESP_ERR_INVALID_ARG;
@@ -88,7 +90,7 @@ esp_err_t pn532_init_io(pn532_io_handle_t io_handle)
     pn532_i2c_driver_config *driver_config = (pn532_i2c_driver_config *)io_handle->driver_data;
 
     if (driver_config->i2c_bus_handle != NULL && driver_config->bus_created) {
-        pn532_release_io(io_handle);
+        pn532_i2c_release_io(io_handle);
     }
 
     driver_config->bus_created = false;
@@ -131,7 +133,7 @@ esp_err_t pn532_init_io(pn532_io_handle_t io_handle)
     return ESP_OK;
 }
 
-void pn532_release_io(pn532_io_handle_t io_handle)
+void pn532_i2c_release_io(pn532_io_handle_t io_handle)
 {
     if (io_handle == NULL || io_handle->driver_data == NULL) {
         return;
@@ -155,7 +157,7 @@ void pn532_release_io(pn532_io_handle_t io_handle)
     }
 }
 
-esp_err_t pn532_is_ready(pn532_io_handle_t io_handle)
+esp_err_t pn532_i2c_is_ready(pn532_io_handle_t io_handle)
 {
     uint8_t status;
     if (io_handle == NULL || io_handle->driver_data == NULL) {
@@ -171,7 +173,7 @@ esp_err_t pn532_is_ready(pn532_io_handle_t io_handle)
     return (status == 0x01) ? ESP_OK : ESP_FAIL;
 }
 
-esp_err_t pn532_read(pn532_io_handle_t io_handle, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms)
+esp_err_t pn532_i2c_read(pn532_io_handle_t io_handle, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms)
 {
     static uint8_t rx_buffer[256];
 
@@ -212,7 +214,7 @@ esp_err_t pn532_read(pn532_io_handle_t io_handle, uint8_t *read_buffer, size_t r
     return result;
 }
 
-esp_err_t pn532_write(pn532_io_handle_t io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms)
+esp_err_t pn532_i2c_write(pn532_io_handle_t io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms)
 {
     if (io_handle == NULL || io_handle->driver_data == NULL) {
         return ESP_ERR_INVALID_ARG;
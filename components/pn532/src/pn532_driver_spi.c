@@ -2,12 +2,14 @@
 // Created by dirki on 04.07.25.
 //
 #include "pn532_driver.h"
+#include "pn532_transport.h"
 #include "pn532_driver_spi.h"
 
 #include <string.h>
 #include "driver/spi_master.h"
 #include "esp_rom_sys.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 static const char TAG[] = "pn532_driver_spi";
 
@@ -15,6 +17,18 @@ static const char TAG[] = "pn532_driver_spi";
 #define OP_WRITE_DATA 0x01
 #define OP_READ_DATA 0x03
 
+#define PN532_SPI_FRAME_BUFFER_LEN 256
+
+// NSS low to first clock edge. The peripheral's cs_ena_pretrans tops out at 16 bit clocks
+// (4us at 4MHz), so CS stays a GPIO in every mode.
+#define PN532_SPI_CS_SETUP_US 100
+
+#ifdef CONFIG_PN532_SPI_PERFORMANCE_MODE
+#define PN532_SPI_QUEUE_SIZE 2
+#else
+#define PN532_SPI_QUEUE_SIZE 1
+#endif
+
 typedef struct {
     gpio_num_t miso;
     gpio_num_t mosi;
@@ -25,15 +39,23 @@ typedef struct {
     spi_device_handle_t spi_handle;
     int32_t clock_frequency;
     bool bus_initialized;
-    uint8_t frame_buffer[256];
+    pn532_spi_stats_t stats;
+    // Both buffers are used for DMA; the whole struct lives in DMA capable memory
+    uint8_t frame_buffer[PN532_SPI_FRAME_BUFFER_LEN] __attribute__((aligned(4)));
+    uint8_t rx_buffer[PN532_SPI_FRAME_BUFFER_LEN] __attribute__((aligned(4)));
 } pn532_spi_driver_config;
 
-static esp_err_t pn532_init_io(pn532_io_handle_t io_handle);
-static void pn532_release_driver(pn532_io_handle_t io_handle);
-static void pn532_release_io(pn532_io_handle_t io_handle);
-static esp_err_t pn532_read(pn532_io_handle_t io_handle, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms);
-static esp_err_t pn532_write(pn532_io_handle_t io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms);
-static esp_err_t pn532_is_ready(pn532_io_handle_t io_handle);
+#ifdef CONFIG_PN532_TRANSPORT_MULTI
+const pn532_transport_ops_t pn532_transport_ops_spi = {
+    .init_io = pn532_spi_init_io,
+    .release_io = pn532_spi_release_io,
+    .release_driver = pn532_spi_release_driver,
+    .read = pn532_spi_read,
+    .write = pn532_spi_write,
+    .init_extra = NULL,
+    .is_ready = pn532_spi_is_ready,
+};
+#endif
 
 esp_err_t pn532_new_driver_spi(gpio_num_t miso,
                                gpio_num_t mosi,
@@ -53,7 +75,15 @@ esp_err_t pn532_new_driver_spi(gpio_num_t miso,
         return ESP_ERR_INVALID_ARG;
     }
 
-    pn532_spi_driver_config *dev_config = heap_caps_calloc(1, sizeof(pn532_spi_driver_config), MALLOC_CAP_DEFAULT);
+#ifdef CONFIG_PN532_SPI_PERFORMANCE_MODE
+    // Without IRQ every status poll would busy-wait the CS setup time
+    if (irq == GPIO_NUM_NC) {
+        ESP_LOGE(TAG, "SPI performance mode needs the IRQ pin");
+        return ESP_ERR_INVALID_ARG;
+    }
+#endif
+
+    pn532_spi_driver_config *dev_config = heap_caps_calloc(1, sizeof(pn532_spi_driver_config), MALLOC_CAP_DMA);
     if (dev_config == NULL) {
         return ESP_ERR_NO_MEM;
     }
@@ -74,13 +104,9 @@ esp_err_t pn532_new_driver_spi(gpio_num_t miso,
     dev_config->spi_handle = NULL;
     io_handle->driver_data = dev_config;
 
-    io_handle->pn532_init_io = pn532_init_io;
-    io_handle->pn532_release_io = pn532_release_io;
-    io_handle->pn532_release_driver = pn532_release_driver;
-    io_handle->pn532_read = pn532_read;
-    io_handle->pn532_write = pn532_write;
-    io_handle->pn532_init_extra = NULL;
-    io_handle->pn532_is_ready = pn532_is_ready;
+#ifdef CONFIG_PN532_TRANSPORT_MULTI
+    pn532_transport_install(io_handle, &pn532_transport_ops_spi);
+#endif
 
 #ifdef CONFIG_ENABLE_IRQ_ISR
     io_handle->IRQQueue = NULL;
@@ -90,39 +116,80 @@ esp_err_t pn532_new_driver_spi(gpio_num_t miso,
     return ESP_OK;
 }
 
-void pn532_release_driver(pn532_io_handle_t io_handle)
+void pn532_spi_release_driver(pn532_io_handle_t io_handle)
 {
     if (io_handle == NULL || io_handle->driver_data == NULL)
         return;
 
-    pn532_release_io(io_handle);
+    pn532_spi_release_io(io_handle);
 
     free(io_handle->driver_data);
     io_handle->driver_data = NULL;
 }
 
+#ifndef CONFIG_PN532_SPI_PERFORMANCE_MODE
 void spi_pre_cb(spi_transaction_t *trans) {
     pn532_spi_driver_config *driver_config = (pn532_spi_driver_config *)trans->user;
     gpio_set_level(driver_config->cs, 0);
-    esp_rom_delay_us(100);
+    esp_rom_delay_us(PN532_SPI_CS_SETUP_US);
 }
 
 void spi_post_cb(spi_transaction_t *trans) {
     pn532_spi_driver_config *driver_config = (pn532_spi_driver_config *)trans->user;
     gpio_set_level(driver_config->cs, 1);
 }
+#endif
+
+/**
+ * Run one transaction and account for it in the driver statistics.
+ * In performance mode the transaction is queued and the task blocks until the
+ * SPI interrupt completes it; otherwise the CPU polls the peripheral.
+ * CS is driven here rather than from pre_cb, which would run the setup delay in the SPI ISR.
+ */
+static esp_err_t spi_transfer(pn532_spi_driver_config *driver_config, spi_transaction_t *trans, int xfer_timeout_ms)
+{
+    int64_t start_us = esp_timer_get_time();
+
+#ifdef CONFIG_PN532_SPI_PERFORMANCE_MODE
+    TickType_t timeout_ticks = (xfer_timeout_ms > 0) ? pdMS_TO_TICKS(xfer_timeout_ms) : portMAX_DELAY;
+    spi_transaction_t *done = NULL;
+
+    gpio_set_level(driver_config->cs, 0);
+    esp_rom_delay_us(PN532_SPI_CS_SETUP_US);
+    esp_err_t result = spi_device_queue_trans(driver_config->spi_handle, trans, timeout_ticks);
+    if (result == ESP_OK) {
+        result = spi_device_get_trans_result(driver_config->spi_handle, &done, timeout_ticks);
+        if (result != ESP_OK) {
+            // Still queued: the driver holds trans (which lives on the caller's stack) and
+            // CS has to stay low until it is on the wire, so wait it out
+            spi_device_get_trans_result(driver_config->spi_handle, &done, portMAX_DELAY);
+        }
+    }
+    gpio_set_level(driver_config->cs, 1);
+#else
+    esp_err_t result = spi_device_polling_transmit(driver_config->spi_handle, trans);
+#endif
+
+    if (result == ESP_OK) {
+        driver_config->stats.transactions++;
+        driver_config->stats.bytes_tx += trans->length / 8;
+        driver_config->stats.bytes_rx += trans->rxlength / 8;
+        driver_config->stats.bus_busy_us += (uint64_t)(esp_timer_get_time() - start_us);
+    }
+    return result;
+}
 
-esp_err_t pn532_init_io(pn532_io_handle_t io_handle)
+esp_err_t pn532_spi_init_io(pn532_io_handle_t io_handle)
 {
     if (io_handle == NULL || io_handle->driver_data == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    ESP_LOGD(TAG, "pn532_init_io() ...");
+    ESP_LOGD(TAG, "pn532_spi_init_io() ...");
     pn532_spi_driver_config *driver_config = (pn532_spi_driver_config *)io_handle->driver_data;
 
     if (driver_config->spi_handle != NULL || driver_config->bus_initialized) {
-        pn532_release_io(io_handle);
+        pn532_spi_release_io(io_handle);
     }
 
     if (driver_config->cs == GPIO_NUM_NC) {
@@ -142,7 +209,7 @@ esp_err_t pn532_init_io(pn532_io_handle_t io_handle)
             .quadhd_io_num = -1,
         };
         err = spi_bus_initialize(driver_config->spi_host, &bus_config, SPI_DMA_CH_AUTO);
-        ESP_LOGD(TAG, "pn532_init_io() spi_bus_initialize -> %d", err);
+        ESP_LOGD(TAG, "pn532_spi_init_io() spi_bus_initialize -> %d", err);
         if (err != ESP_OK) {
             if (err == ESP_ERR_INVALID_STATE) {
                 ESP_LOGW(TAG, "Failed to initialize SPI bus, maybe already initialzed");
@@ -177,14 +244,16 @@ esp_err_t pn532_init_io(pn532_io_handle_t io_handle)
         .mode = 0,
         .clock_source = SPI_CLK_SRC_DEFAULT,
         .clock_speed_hz = (int)driver_config->clock_frequency,
-        .spics_io_num = -1,
         .flags = SPI_DEVICE_HALFDUPLEX | SPI_DEVICE_BIT_LSBFIRST,
-        .queue_size = 1,
+        .queue_size = PN532_SPI_QUEUE_SIZE,
+        .spics_io_num = -1,
+#ifndef CONFIG_PN532_SPI_PERFORMANCE_MODE
         .pre_cb = spi_pre_cb,
         .post_cb = spi_post_cb,
+#endif
     };
     err = spi_bus_add_device(driver_config->spi_host, &dev_config, &driver_config->spi_handle);
-    ESP_LOGD(TAG, "pn532_init_io() spi_bus_add_device -> %d", err);
+    ESP_LOGD(TAG, "pn532_spi_init_io() spi_bus_add_device -> %d", err);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to add SPI device");
         return err;
@@ -193,7 +262,7 @@ esp_err_t pn532_init_io(pn532_io_handle_t io_handle)
     return ESP_OK;
 }
 
-void pn532_release_io(pn532_io_handle_t io_handle)
+void pn532_spi_release_io(pn532_io_handle_t io_handle)
 {
     if (io_handle == NULL || io_handle->driver_data == NULL) {
         return;
@@ -215,7 +284,7 @@ void pn532_release_io(pn532_io_handle_t io_handle)
     }
 }
 
-esp_err_t pn532_is_ready(pn532_io_handle_t io_handle)
+esp_err_t pn532_spi_is_ready(pn532_io_handle_t io_handle)
 {
     uint8_t status;
     if (io_handle == NULL || io_handle->driver_data == NULL) {
@@ -223,24 +292,24 @@ esp_err_t pn532_is_ready(pn532_io_handle_t io_handle)
     }
 
     pn532_spi_driver_config *driver_config = (pn532_spi_driver_config *)io_handle->driver_data;
-    esp_err_t result = spi_device_polling_transmit(driver_config->spi_handle,
+    esp_err_t result = spi_transfer(driver_config,
         &(spi_transaction_t) {
             .cmd = OP_READ_STATUS,
             .rxlength = 8,
-            .rx_buffer = &status,
+            .rx_buffer = driver_config->rx_buffer,
             .user = io_handle->driver_data,
-        });
+        }, PN532_READ_TIMEOUT);
 
     if (result != ESP_OK)
         return result;
 
+    driver_config->stats.status_polls++;
+    status = driver_config->rx_buffer[0];
     return ((status & 0x01) == 0x01) ? ESP_OK : ESP_FAIL;
 }
 
-esp_err_t pn532_read(pn532_io_handle_t io_handle, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms)
+esp_err_t pn532_spi_read(pn532_io_handle_t io_handle, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms)
 {
-    static uint8_t rx_buffer[1];
-
     TickType_t start_ticks = xTaskGetTickCount();
     TickType_t timeout_ticks = (xfer_timeout_ms > 0) ? pdMS_TO_TICKS(xfer_timeout_ms) : portMAX_DELAY;
     TickType_t elapsed_ticks = 0;
@@ -249,39 +318,66 @@ esp_err_t pn532_read(pn532_io_handle_t io_handle, uint8_t *read_buffer, size_t r
         return ESP_ERR_INVALID_ARG;
     }
 
+    if (read_size > PN532_SPI_FRAME_BUFFER_LEN) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
     pn532_spi_driver_config *driver_config = (pn532_spi_driver_config *)io_handle->driver_data;
 
-    esp_err_t result = ESP_FAIL;
     bool is_ready = false;
+#ifdef CONFIG_PN532_SPI_PERFORMANCE_MODE
+    // The PN532 holds IRQ low while a frame is pending; no bus traffic needed to find out
+    if (io_handle->irq != GPIO_NUM_NC && gpio_get_level(io_handle->irq) == 0) {
+        is_ready = true;
+    }
+#ifdef CONFIG_ENABLE_IRQ_ISR
+    else if (io_handle->irq != GPIO_NUM_NC && io_handle->IRQQueue != NULL) {
+        // Block on the falling edge queued by the IRQ ISR. An event left over from an
+        // earlier frame wakes us with the line still high; then wait for the next one.
+        driver_config->stats.irq_waits++;
+        gpio_num_t io_num;
+        while (!is_ready && elapsed_ticks < timeout_ticks) {
+            xQueueReceive(io_handle->IRQQueue, &io_num, timeout_ticks - elapsed_ticks);
+            is_ready = gpio_get_level(io_handle->irq) == 0;
+            elapsed_ticks = xTaskGetTickCount() - start_ticks;
+        }
+        if (!is_ready)
+            return ESP_ERR_TIMEOUT;
+    }
+#endif
+#endif
+
+    esp_err_t result = ESP_OK;
     while (!is_ready && elapsed_ticks < timeout_ticks) {
-        result = spi_device_polling_transmit(driver_config->spi_handle,
-            &(spi_transaction_t) {
-                .cmd = OP_READ_STATUS,
-                .rxlength = 8,
-                .rx_buffer = rx_buffer,
-                .user = io_handle->driver_data,
-            });
-        if (result == ESP_OK && (rx_buffer[0] & 0x01) == 0x01) {
+        result = pn532_spi_is_ready(io_handle);
+        if (result == ESP_OK) {
             is_ready = true;
         }
+        else if (result != ESP_FAIL) {
+            return result;
+        }
         elapsed_ticks = xTaskGetTickCount() - start_ticks;
     }
 
-    if (result != ESP_OK)
-        return result;
+    if (!is_ready)
+        return ESP_ERR_TIMEOUT;
 
-    result = spi_device_polling_transmit(driver_config->spi_handle,
+    // DATAREAD opcode and the whole frame in a single transfer
+    result = spi_transfer(driver_config,
         &(spi_transaction_t) {
             .cmd = OP_READ_DATA,
             .rxlength = read_size * 8,
-            .rx_buffer = read_buffer,
+            .rx_buffer = driver_config->rx_buffer,
             .user = io_handle->driver_data,
-        });
+        }, xfer_timeout_ms);
 
+    if (result == ESP_OK) {
+        memcpy(read_buffer, driver_config->rx_buffer, read_size);
+    }
     return result;
 }
 
-esp_err_t pn532_write(pn532_io_handle_t io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms)
+esp_err_t pn532_spi_write(pn532_io_handle_t io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms)
 {
     if (io_handle == NULL || io_handle->driver_data == NULL) {
         return ESP_ERR_INVALID_ARG;
@@ -297,11 +393,34 @@ esp_err_t pn532_write(pn532_io_handle_t io_handle, const uint8_t *write_buffer,
     memcpy(driver_config->frame_buffer + 1, write_buffer, write_size);
     driver_config->frame_buffer[write_size + 1] = 0;
 
-    return spi_device_polling_transmit(driver_config->spi_handle,
+    return spi_transfer(driver_config,
         &(spi_transaction_t) {
             .cmd = OP_WRITE_DATA,
             .length = (write_size + 2) * 8,
             .tx_buffer = driver_config->frame_buffer,
             .user = io_handle->driver_data,
-        });
+        }, xfer_timeout_ms);
+}
+
+esp_err_t pn532_spi_get_stats(pn532_io_handle_t io_handle, pn532_spi_stats_t *stats)
+{
+    if (io_handle == NULL || io_handle->driver_data == NULL || stats == NULL ||
+        !PN532_IO_IS(io_handle, spi)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pn532_spi_driver_config *driver_config = (pn532_spi_driver_config *)io_handle->driver_data;
+    *stats = driver_config->stats;
+    return ESP_OK;
+}
+
+esp_err_t pn532_spi_reset_stats(pn532_io_handle_t io_handle)
+{
+    if (io_handle == NULL || io_handle->driver_data == NULL || !PN532_IO_IS(io_handle, spi)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pn532_spi_driver_config *driver_config = (pn532_spi_driver_config *)io_handle->driver_data;
+    memset(&driver_config->stats, 0, sizeof(driver_config->stats));
+    return ESP_OK;
 }
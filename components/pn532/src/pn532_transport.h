@@ -0,0 +1,113 @@
+#ifndef PN532_TRANSPORT_H
+#define PN532_TRANSPORT_H
+
+#include "sdkconfig.h"
+#include "pn532_driver.h"
+
+/*
+ * Transport dispatch used by pn532_driver.c.
+ *
+ * Every driver implements the pn532_<transport>_*() functions below. With
+ * CONFIG_PN532_TRANSPORT_MULTI the constructor installs the driver's pn532_transport_ops_t
+ * table into the function pointers of struct pn532_io_t and every call goes through the
+ * io handle. When a single transport is selected, the PN532_IO_*() macros name that
+ * driver's functions directly, there is no table, and the unused drivers are not compiled.
+ */
+
+esp_err_t pn532_i2c_init_io(pn532_io_handle_t io_handle);
+void pn532_i2c_release_io(pn532_io_handle_t io_handle);
+void pn532_i2c_release_driver(pn532_io_handle_t io_handle);
+esp_err_t pn532_i2c_read(pn532_io_handle_t io_handle, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms);
+esp_err_t pn532_i2c_write(pn532_io_handle_t io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms);
+esp_err_t pn532_i2c_is_ready(pn532_io_handle_t io_handle);
+
+esp_err_t pn532_spi_init_io(pn532_io_handle_t io_handle);
+void pn532_spi_release_io(pn532_io_handle_t io_handle);
+void pn532_spi_release_driver(pn532_io_handle_t io_handle);
+esp_err_t pn532_spi_read(pn532_io_handle_t io_handle, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms);
+esp_err_t pn532_spi_write(pn532_io_handle_t io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms);
+esp_err_t pn532_spi_is_ready(pn532_io_handle_t io_handle);
+
+esp_err_t pn532_hsu_init_io(pn532_io_handle_t io_handle);
+void pn532_hsu_release_io(pn532_io_handle_t io_handle);
+void pn532_hsu_release_driver(pn532_io_handle_t io_handle);
+esp_err_t pn532_hsu_read(pn532_io_handle_t io_handle, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms);
+esp_err_t pn532_hsu_write(pn532_io_handle_t io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms);
+esp_err_t pn532_hsu_init_extra(pn532_io_handle_t io_handle);
+
+#ifdef CONFIG_PN532_TRANSPORT_MULTI
+
+// Operations of one transport driver
+typedef struct {
+    esp_err_t (*init_io)(pn532_io_handle_t io_handle);
+    void (*release_io)(pn532_io_handle_t io_handle);
+    void (*release_driver)(pn532_io_handle_t io_handle);
+    esp_err_t (*read)(pn532_io_handle_t io_handle, uint8_t *read_buffer, size_t read_size, int xfer_timeout_ms);
+    esp_err_t (*write)(pn532_io_handle_t io_handle, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms);
+    esp_err_t (*init_extra)(pn532_io_handle_t io_handle);  // NULL if not needed
+    esp_err_t (*is_ready)(pn532_io_handle_t io_handle);    // NULL if the status can't be polled
+} pn532_transport_ops_t;
+
+extern const pn532_transport_ops_t pn532_transport_ops_i2c;
+extern const pn532_transport_ops_t pn532_transport_ops_spi;
+extern const pn532_transport_ops_t pn532_transport_ops_hsu;
+
+/**
+ * Point the io handle at a driver's operations
+ * @param io_handle PN532 io handle
+ * @param ops Operations of the driver creating the handle
+ */
+static inline void pn532_transport_install(pn532_io_handle_t io_handle, const pn532_transport_ops_t *ops)
+{
+    io_handle->pn532_init_io = ops->init_io;
+    io_handle->pn532_release_io = ops->release_io;
+    io_handle->pn532_release_driver = ops->release_driver;
+    io_handle->pn532_read = ops->read;
+    io_handle->pn532_write = ops->write;
+    io_handle->pn532_init_extra = ops->init_extra;
+    io_handle->pn532_is_ready = ops->is_ready;
+}
+
+#define PN532_IO_INIT_IO(h)             (h)->pn532_init_io(h)
+#define PN532_IO_RELEASE_IO(h)          do { if ((h)->pn532_release_io != NULL) (h)->pn532_release_io(h); } while (0)
+#define PN532_IO_RELEASE_DRIVER(h)      do { if ((h)->pn532_release_driver != NULL) (h)->pn532_release_driver(h); } while (0)
+#define PN532_IO_READ(h, b, n, t)       (h)->pn532_read(h, b, n, t)
+#define PN532_IO_WRITE(h, b, n, t)      (h)->pn532_write(h, b, n, t)
+#define PN532_IO_HAS_INIT_EXTRA(h)      ((h)->pn532_init_extra != NULL)
+#define PN532_IO_INIT_EXTRA(h)          (h)->pn532_init_extra(h)
+#define PN532_IO_HAS_IS_READY(h)        ((h)->pn532_is_ready != NULL)
+#define PN532_IO_IS_READY(h)            (h)->pn532_is_ready(h)
+#define PN532_IO_IS(h, transport)       ((h)->pn532_read == pn532_##transport##_read)
+
+#else
+
+#if defined(CONFIG_PN532_TRANSPORT_I2C)
+#define PN532_IO_FN(op)                 pn532_i2c_##op
+#elif defined(CONFIG_PN532_TRANSPORT_SPI)
+#define PN532_IO_FN(op)                 pn532_spi_##op
+#else
+#define PN532_IO_FN(op)                 pn532_hsu_##op
+#endif
+
+#define PN532_IO_INIT_IO(h)             PN532_IO_FN(init_io)(h)
+#define PN532_IO_RELEASE_IO(h)          PN532_IO_FN(release_io)(h)
+#define PN532_IO_RELEASE_DRIVER(h)      PN532_IO_FN(release_driver)(h)
+#define PN532_IO_READ(h, b, n, t)       PN532_IO_FN(read)(h, b, n, t)
+#define PN532_IO_WRITE(h, b, n, t)      PN532_IO_FN(write)(h, b, n, t)
+#define PN532_IO_IS(h, transport)       (true)  // Only one driver is compiled in
+
+#ifdef CONFIG_PN532_TRANSPORT_HSU
+#define PN532_IO_HAS_INIT_EXTRA(h)      (true)
+#define PN532_IO_INIT_EXTRA(h)          pn532_hsu_init_extra(h)
+#define PN532_IO_HAS_IS_READY(h)        (false)
+#define PN532_IO_IS_READY(h)            (ESP_ERR_NOT_SUPPORTED)
+#else
+#define PN532_IO_HAS_INIT_EXTRA(h)      (false)
+#define PN532_IO_INIT_EXTRA(h)          (ESP_OK)
+#define PN532_IO_HAS_IS_READY(h)        (true)
+#define PN532_IO_IS_READY(h)            PN532_IO_FN(is_ready)(h)
+#endif
+
+#endif
+
+#endif // PN532_TRANSPORT_H
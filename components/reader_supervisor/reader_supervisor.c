@@ -0,0 +1,133 @@
+#include "reader_supervisor.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "string.h"
+
+static const char *TAG = "reader_supervisor";
+
+static reader_supervisor_stats_t s_stats;
+static int64_t s_reader_up_us = 0;
+static int64_t s_last_check_us = 0;
+static uint32_t s_consecutive_errors = 0;
+
+static uint32_t elapsed_ms(int64_t since_us)
+{
+    return (uint32_t)((esp_timer_get_time() - since_us) / 1000);
+}
+
+void reader_supervisor_init(void)
+{
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_reader_up_us = esp_timer_get_time();
+    s_last_check_us = s_reader_up_us;
+    s_consecutive_errors = 0;
+}
+
+esp_err_t reader_supervisor_reinit(pn532_io_handle_t io_handle)
+{
+    int64_t start_us = esp_timer_get_time();
+    uint32_t backoff_ms = READER_SUPERVISOR_REINIT_BACKOFF_MS;
+    esp_err_t err = ESP_FAIL;
+
+    ESP_LOGW(TAG, "🔄 Re-initialising PN532...");
+    while (elapsed_ms(start_us) < READER_SUPERVISOR_REINIT_BUDGET_MS) {
+        // Tear down the bus driver, IRQ handler and queue first: pn532_init() installs them
+        // again, and an installed UART driver or a live ISR would make it fail or race
+        pn532_release(io_handle);
+        err = pn532_init(io_handle);
+        if (err == ESP_OK) {
+            uint32_t version = 0;
+            err = pn532_get_firmware_version(io_handle, &version);
+            if (err == ESP_OK) {
+                break;
+            }
+        }
+        vTaskDelay(pdMS_TO_TICKS(backoff_ms));
+        backoff_ms *= 2;
+    }
+
+    uint32_t duration_ms = elapsed_ms(start_us);
+    if (err != ESP_OK) {
+        s_stats.reinit_failures++;
+        ESP_LOGE(TAG, "❌ PN532 re-init failed after %lu ms", (unsigned long)duration_ms);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    s_stats.reinits++;
+    s_stats.last_reinit_ms = duration_ms;
+    if (duration_ms > s_stats.max_reinit_ms) {
+        s_stats.max_reinit_ms = duration_ms;
+    }
+    s_reader_up_us = esp_timer_get_time();
+    s_consecutive_errors = 0;
+    ESP_LOGI(TAG, "✅ PN532 back after %lu ms (re-init #%lu)", (unsigned long)duration_ms, (unsigned long)s_stats.reinits);
+    return ESP_OK;
+}
+
+static esp_err_t check_reader(pn532_io_handle_t io_handle)
+{
+    s_last_check_us = esp_timer_get_time();
+    s_stats.checks++;
+
+    // Lost SAM configuration: the PN532 was reset and stays in low-power mode until reconfigured
+    if (!io_handle->isSAMConfigDone) {
+        ESP_LOGW(TAG, "⚠️ PN532 SAM configuration lost");
+        return reader_supervisor_reinit(io_handle);
+    }
+
+    uint32_t version = 0;
+    esp_err_t err = pn532_get_firmware_version(io_handle, &version);
+    if (err != ESP_OK) {
+        // One retry absorbs a single corrupted frame
+        err = pn532_get_firmware_version(io_handle, &version);
+    }
+    if (err != ESP_OK) {
+        s_stats.check_failures++;
+        ESP_LOGW(TAG, "⚠️ PN532 not answering (%s)", esp_err_to_name(err));
+        return reader_supervisor_reinit(io_handle);
+    }
+
+    s_consecutive_errors = 0;
+    return ESP_OK;
+}
+
+esp_err_t reader_supervisor_poll(pn532_io_handle_t io_handle)
+{
+    if (io_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (io_handle->isSAMConfigDone &&
+        s_consecutive_errors < READER_SUPERVISOR_ERROR_THRESHOLD &&
+        elapsed_ms(s_last_check_us) < READER_SUPERVISOR_CHECK_INTERVAL_MS) {
+        return ESP_OK;
+    }
+
+    return check_reader(io_handle);
+}
+
+void reader_supervisor_report(pn532_io_handle_t io_handle, esp_err_t err)
+{
+    if (err == ESP_OK) {
+        s_consecutive_errors = 0;
+        return;
+    }
+
+    if (++s_consecutive_errors == READER_SUPERVISOR_ERROR_THRESHOLD) {
+        ESP_LOGW(TAG, "⚠️ %d reader errors in a row, checking PN532", READER_SUPERVISOR_ERROR_THRESHOLD);
+        check_reader(io_handle);
+    }
+}
+
+void reader_supervisor_get_stats(reader_supervisor_stats_t* stats)
+{
+    if (!stats) {
+        return;
+    }
+
+    *stats = s_stats;
+    stats->uptime_s = (uint32_t)(esp_timer_get_time() / 1000000);
+    stats->reader_uptime_s = elapsed_ms(s_reader_up_us) / 1000;
+}
@@ -0,0 +1,70 @@
+#ifndef READER_SUPERVISOR_H
+#define READER_SUPERVISOR_H
+
+#include "esp_err.h"
+#include "pn532.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define READER_SUPERVISOR_CHECK_INTERVAL_MS  5000  // Liveness check period while idle
+#define READER_SUPERVISOR_ERROR_THRESHOLD    3     // Consecutive reader errors that force a check
+#define READER_SUPERVISOR_REINIT_BUDGET_MS   3000  // Give up a re-init attempt after this long
+#define READER_SUPERVISOR_REINIT_BACKOFF_MS  50    // First retry delay, doubled per retry
+
+typedef struct {
+    uint32_t uptime_s;          // Time since boot
+    uint32_t reader_uptime_s;   // Time since the reader was last (re-)initialised
+    uint32_t checks;            // Liveness checks run
+    uint32_t check_failures;    // Liveness checks the PN532 did not answer
+    uint32_t reinits;           // Successful re-initialisations
+    uint32_t reinit_failures;   // Re-initialisations that ran out of budget
+    uint32_t last_reinit_ms;    // Duration of the last successful re-init
+    uint32_t max_reinit_ms;     // Longest successful re-init
+} reader_supervisor_stats_t;
+
+/**
+ * @brief Start supervising a reader that has just been initialised
+ */
+void reader_supervisor_init(void);
+
+/**
+ * @brief Run a liveness check if one is due; call whenever the reader is idle
+ *
+ * Re-initialises the PN532 if SAM configuration was lost or the chip stopped answering.
+ *
+ * @param io_handle PN532 io handle
+ * @return ESP_OK if the reader is (again) usable
+ */
+esp_err_t reader_supervisor_poll(pn532_io_handle_t io_handle);
+
+/**
+ * @brief Report the result of a reader command from the application
+ *
+ * A run of failures brings the next liveness check forward.
+ *
+ * @param io_handle PN532 io handle
+ * @param err Result of the command
+ */
+void reader_supervisor_report(pn532_io_handle_t io_handle, esp_err_t err);
+
+/**
+ * @brief Release and re-initialise the PN532 within READER_SUPERVISOR_REINIT_BUDGET_MS
+ * @param io_handle PN532 io handle
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if the budget ran out
+ */
+esp_err_t reader_supervisor_reinit(pn532_io_handle_t io_handle);
+
+/**
+ * @brief Get uptime and re-init counters
+ * @param stats Receives the counters
+ */
+void reader_supervisor_get_stats(reader_supervisor_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // READER_SUPERVISOR_H
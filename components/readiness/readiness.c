@@ -0,0 +1,249 @@
+#include "readiness.h"
+#include "wol_client.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "string.h"
+#include <stdio.h>
+
+static const char *TAG = "readiness";
+
+#define PROFILE_VERSION 1
+
+// Learned per PC, stored as blob "pc<N>"
+typedef struct {
+    uint8_t version;
+    uint8_t seen_mask;                          // Signals seen on the last successful boot
+    uint16_t boots;                             // Samples behind the averages
+    uint32_t signal_ms[READINESS_SIG_COUNT];    // Wake to signal, moving average
+    uint32_t ready_ms;                          // Wake to ready, moving average
+} readiness_profile_t;
+
+static const char* const s_signal_names[READINESS_SIG_COUNT] = {
+    [READINESS_SIG_NIC]      = "nic",
+    [READINESS_SIG_USB]      = "usb",
+    [READINESS_SIG_KBD_LEDS] = "leds",
+    [READINESS_SIG_SMB]      = "smb",
+    [READINESS_SIG_RDP]      = "rdp",
+};
+
+static SemaphoreHandle_t s_lock = NULL;
+
+// Current session, guarded by s_lock
+static bool s_active = false;
+static uint8_t s_pc = 0;
+static int64_t s_start_us = 0;
+static int64_t s_seen_us[READINESS_SIG_COUNT];
+static int64_t s_ready_us = 0;
+static readiness_profile_t s_profile;
+
+#define WINDOWS_SIGNALS ((1u << READINESS_SIG_USB) | (1u << READINESS_SIG_KBD_LEDS) | \
+                         (1u << READINESS_SIG_SMB) | (1u << READINESS_SIG_RDP))
+
+static void profile_key(uint8_t pc, char* key, size_t len)
+{
+    snprintf(key, len, "pc%u", pc);
+}
+
+static void load_profile(uint8_t pc, readiness_profile_t* profile)
+{
+    memset(profile, 0, sizeof(*profile));
+
+    nvs_handle_t nvs;
+    if (nvs_open(READINESS_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return;
+    }
+    char key[8];
+    profile_key(pc, key, sizeof(key));
+    size_t size = sizeof(*profile);
+    esp_err_t ret = nvs_get_blob(nvs, key, profile, &size);
+    nvs_close(nvs);
+
+    if (ret != ESP_OK || size != sizeof(*profile) || profile->version != PROFILE_VERSION) {
+        memset(profile, 0, sizeof(*profile));
+    }
+}
+
+static esp_err_t save_profile(uint8_t pc, const readiness_profile_t* profile)
+{
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(READINESS_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    char key[8];
+    profile_key(pc, key, sizeof(key));
+    ret = nvs_set_blob(nvs, key, profile, sizeof(*profile));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    return ret;
+}
+
+esp_err_t readiness_init(void)
+{
+    if (!s_lock) {
+        s_lock = xSemaphoreCreateMutex();
+    }
+    return s_lock ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+void readiness_start(uint8_t pc, int64_t start_us)
+{
+    if (!s_lock) {
+        return;
+    }
+    readiness_profile_t profile;
+    load_profile(pc, &profile);
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_active = true;
+    s_pc = pc;
+    s_start_us = start_us;
+    s_ready_us = 0;
+    memset(s_seen_us, 0, sizeof(s_seen_us));
+    s_profile = profile;
+    xSemaphoreGive(s_lock);
+
+    if (profile.boots) {
+        ESP_LOGI(TAG, "PC %u: expecting signals 0x%02x, ready after ~%lu ms (%u boots)", pc,
+                 profile.seen_mask, (unsigned long)profile.ready_ms, profile.boots);
+    }
+}
+
+void readiness_note(readiness_signal_t signal)
+{
+    if (!s_lock || signal >= READINESS_SIG_COUNT) {
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    // Signals after the ready point still count for learning: one that shows up while we
+    // type means the lock screen wasn't quite done, so it is waited for next time
+    if (s_active) {
+        int64_t now = esp_timer_get_time();
+        if (!s_seen_us[signal]) {
+            ESP_LOGI(TAG, "Signal %s after %lu ms", s_signal_names[signal],
+                     (unsigned long)((now - s_start_us) / 1000));
+        }
+        s_seen_us[signal] = now;
+    }
+    xSemaphoreGive(s_lock);
+}
+
+bool readiness_seen(readiness_signal_t signal)
+{
+    if (!s_lock || signal >= READINESS_SIG_COUNT) {
+        return false;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool seen = s_active && s_seen_us[signal] != 0;
+    xSemaphoreGive(s_lock);
+    return seen;
+}
+
+// Caller holds the lock
+static readiness_verdict_t classify(int64_t now)
+{
+    uint32_t seen_mask = 0;
+    int64_t first_windows_us = 0;
+    for (int i = 0; i < READINESS_SIG_COUNT; i++) {
+        if (s_seen_us[i]) {
+            seen_mask |= 1u << i;
+            if ((WINDOWS_SIGNALS & (1u << i)) && (!first_windows_us || s_seen_us[i] < first_windows_us)) {
+                first_windows_us = s_seen_us[i];
+            }
+        }
+    }
+
+    uint32_t expected = s_profile.seen_mask & WINDOWS_SIGNALS;
+    if (s_profile.boots && expected) {
+        // This PC has shown us what a finished boot looks like
+        if ((seen_mask & expected) == expected) {
+            return READINESS_READY;
+        }
+        int64_t give_up_us = s_start_us + ((int64_t)s_profile.ready_ms * 3 / 2 + READINESS_SLACK_MS) * 1000;
+        if (first_windows_us && now >= give_up_us) {
+            return READINESS_FALLBACK;
+        }
+        return READINESS_WAIT;
+    }
+
+    // First boot: the keyboard driver and a service both up is a safe bet
+    bool input_up = seen_mask & ((1u << READINESS_SIG_USB) | (1u << READINESS_SIG_KBD_LEDS));
+    bool service_up = seen_mask & ((1u << READINESS_SIG_SMB) | (1u << READINESS_SIG_RDP));
+    if (input_up && service_up) {
+        return READINESS_READY;
+    }
+    if (first_windows_us && now - first_windows_us >= (int64_t)READINESS_DEFAULT_WAIT_MS * 1000) {
+        return READINESS_FALLBACK;
+    }
+    return READINESS_WAIT;
+}
+
+readiness_verdict_t readiness_check(void)
+{
+    if (!s_lock) {
+        return READINESS_FALLBACK;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    readiness_verdict_t verdict = READINESS_FALLBACK;
+    if (s_active) {
+        int64_t now = esp_timer_get_time();
+        verdict = classify(now);
+        if (verdict != READINESS_WAIT && !s_ready_us) {
+            s_ready_us = now;
+            ESP_LOGI(TAG, "%s after %lu ms", verdict == READINESS_READY ? "Ready" : "Giving up on missing signals",
+                     (unsigned long)((now - s_start_us) / 1000));
+        }
+    }
+    xSemaphoreGive(s_lock);
+    return verdict;
+}
+
+esp_err_t readiness_finish(bool learn)
+{
+    if (!s_lock) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool active = s_active;
+    s_active = false;
+    uint8_t pc = s_pc;
+    readiness_profile_t profile = s_profile;
+    if (active && learn && s_ready_us) {
+        uint8_t seen_mask = 0;
+        for (int i = 0; i < READINESS_SIG_COUNT; i++) {
+            if (s_seen_us[i]) {
+                seen_mask |= 1u << i;
+                profile.signal_ms[i] = wol_moving_average(profile.signal_ms[i],
+                                                          (uint32_t)((s_seen_us[i] - s_start_us) / 1000),
+                                                          profile.boots);
+            }
+        }
+        profile.ready_ms = wol_moving_average(profile.ready_ms, (uint32_t)((s_ready_us - s_start_us) / 1000),
+                                              profile.boots);
+        profile.seen_mask = seen_mask;
+        profile.version = PROFILE_VERSION;
+        if (profile.boots < UINT16_MAX) {
+            profile.boots++;
+        }
+    } else {
+        learn = false;
+    }
+    xSemaphoreGive(s_lock);
+
+    if (!learn) {
+        return ESP_OK;
+    }
+    esp_err_t ret = save_profile(pc, &profile);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save boot profile: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ESP_LOGI(TAG, "PC %u: learned signals 0x%02x, ready after ~%lu ms", pc, profile.seen_mask,
+             (unsigned long)profile.ready_ms);
+    return ESP_OK;
+}
@@ -0,0 +1,81 @@
+#ifndef READINESS_H
+#define READINESS_H
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define READINESS_NVS_NAMESPACE "readiness"
+
+// Without history, type this long after the first Windows signal (the old fixed boot wait)
+#define READINESS_DEFAULT_WAIT_MS 7000
+// With history, a signal that doesn't show up within 1.5x the learned ready time plus this
+// is given up on
+#define READINESS_SLACK_MS 2000
+
+// Signs of a waking PC, roughly in the order Windows produces them
+typedef enum {
+    READINESS_SIG_NIC,          // PC seen on the network
+    READINESS_SIG_USB,          // HID enumerated or resumed
+    READINESS_SIG_KBD_LEDS,     // Host keyboard driver wrote the LED report
+    READINESS_SIG_SMB,          // 445 open (early service)
+    READINESS_SIG_RDP,          // 3389 open (late service, around the lock screen)
+    READINESS_SIG_COUNT,
+} readiness_signal_t;
+
+typedef enum {
+    READINESS_WAIT,
+    READINESS_READY,            // Every signal this PC normally produces has been seen
+    READINESS_FALLBACK,         // Some signal is missing but waiting longer won't help
+} readiness_verdict_t;
+
+/**
+ * @brief Initialize the classifier (NVS must be initialized)
+ * @return ESP_OK, ESP_ERR_NO_MEM
+ */
+esp_err_t readiness_init(void);
+
+/**
+ * @brief Start classifying a wake-up; discards any unfinished session
+ * @param pc PC index (selects the learned profile)
+ * @param start_us When the PC was asked to wake (esp_timer_get_time())
+ */
+void readiness_start(uint8_t pc, int64_t start_us);
+
+/**
+ * @brief Record a signal; safe from any task, ignored without a session
+ *
+ * The latest occurrence counts, so a USB re-enumeration by Windows after the BIOS one
+ * moves the signal forward.
+ *
+ * @param signal Signal
+ */
+void readiness_note(readiness_signal_t signal);
+
+/**
+ * @brief True if the signal has been seen in this session
+ */
+bool readiness_seen(readiness_signal_t signal);
+
+/**
+ * @brief Decide whether the lock screen is ready for typing
+ * @return Verdict
+ */
+readiness_verdict_t readiness_check(void);
+
+/**
+ * @brief End the session
+ * @param learn true after a successful login: store this boot's signals and timing in NVS
+ * @return ESP_OK, or the NVS error when learning
+ */
+esp_err_t readiness_finish(bool learn);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // READINESS_H
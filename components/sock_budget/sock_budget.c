@@ -0,0 +1,171 @@
+#include "sock_budget.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "string.h"
+#include <errno.h>
+
+static const char *TAG = "sock_budget";
+
+// Without SO_LINGER in lwIP, setsockopt() fails and closed probes sit in TIME_WAIT
+#if defined(ESP_PLATFORM) && !CONFIG_LWIP_SO_LINGER
+#error "sock_budget needs CONFIG_LWIP_SO_LINGER=y"
+#endif
+
+static SemaphoreHandle_t s_lock = NULL;         // Shared UDP sockets and counters
+static SemaphoreHandle_t s_tcp_slots = NULL;
+
+static int s_udp_sock = -1;
+static int s_udp6_sock = -1;
+static sock_budget_stats_t s_stats;
+
+esp_err_t sock_budget_init(void)
+{
+    if (!s_lock) {
+        s_lock = xSemaphoreCreateMutex();
+    }
+    if (!s_tcp_slots) {
+        s_tcp_slots = xSemaphoreCreateCounting(SOCK_BUDGET_TCP_SLOTS, SOCK_BUDGET_TCP_SLOTS);
+    }
+    return (s_lock && s_tcp_slots) ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+// Caller holds s_lock
+static int* udp_slot(int family)
+{
+    return family == AF_INET6 ? &s_udp6_sock : &s_udp_sock;
+}
+
+// Caller holds s_lock
+static int open_udp(int family)
+{
+    int sock = socket(family, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        s_stats.alloc_failures++;
+        ESP_LOGW(TAG, "Failed to create %s UDP socket (errno %d, %lu failures)", family == AF_INET6 ? "IPv6" : "IPv4",
+                 errno, (unsigned long)s_stats.alloc_failures);
+        return -1;
+    }
+    if (family == AF_INET) {
+        int broadcast = 1;
+        if (setsockopt(sock, SOL_SOCKET, SO_BROADCAST, &broadcast, sizeof(broadcast)) < 0) {
+            ESP_LOGE(TAG, "Failed to set broadcast option");
+            close(sock);
+            return -1;
+        }
+    }
+    return sock;
+}
+
+ssize_t sock_budget_udp_sendto(int family, const void* data, size_t len, const struct sockaddr* to,
+                               socklen_t to_len)
+{
+    if (!s_lock) {
+        errno = EINVAL;
+        return -1;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    int* sock = udp_slot(family);
+    if (*sock < 0) {
+        *sock = open_udp(family);
+    }
+    ssize_t sent = -1;
+    int saved_errno = ENFILE;
+    if (*sock >= 0) {
+        sent = sendto(*sock, data, len, 0, to, to_len);
+        saved_errno = errno;
+    }
+    xSemaphoreGive(s_lock);
+    errno = saved_errno;
+    return sent;
+}
+
+void sock_budget_udp_reset(int family)
+{
+    if (!s_lock) {
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    int* sock = udp_slot(family);
+    if (*sock >= 0) {
+        close(*sock);
+        *sock = -1;
+        s_stats.udp_reopens++;
+    }
+    xSemaphoreGive(s_lock);
+}
+
+int sock_budget_tcp_open(void)
+{
+    if (!s_lock || xSemaphoreTake(s_tcp_slots, 0) != pdTRUE) {
+        if (s_lock) {
+            xSemaphoreTake(s_lock, portMAX_DELAY);
+            s_stats.tcp_denied++;
+            xSemaphoreGive(s_lock);
+            ESP_LOGW(TAG, "TCP socket budget used up (%d slots)", SOCK_BUDGET_TCP_SLOTS);
+        }
+        return -1;
+    }
+
+    int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    int saved_errno = errno;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (sock < 0) {
+        s_stats.alloc_failures++;
+    } else if (++s_stats.tcp_in_use > s_stats.tcp_peak) {
+        s_stats.tcp_peak = s_stats.tcp_in_use;
+    }
+    uint32_t failures = s_stats.alloc_failures;
+    xSemaphoreGive(s_lock);
+
+    if (sock < 0) {
+        xSemaphoreGive(s_tcp_slots);
+        ESP_LOGW(TAG, "Failed to create TCP socket (errno %d, %lu failures)", saved_errno, (unsigned long)failures);
+    }
+    return sock;
+}
+
+esp_err_t sock_budget_tcp_close(int sock)
+{
+    if (sock < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t ret = ESP_OK;
+    struct linger lg = { .l_onoff = 1, .l_linger = 0 };
+    if (setsockopt(sock, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg)) < 0) {
+        ESP_LOGD(TAG, "SO_LINGER failed (errno %d); socket closes with FIN", errno);
+        ret = ESP_ERR_NOT_SUPPORTED;
+    }
+    close(sock);
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_stats.tcp_in_use--;
+    if (ret != ESP_OK) {
+        s_stats.linger_failures++;
+    }
+    xSemaphoreGive(s_lock);
+    xSemaphoreGive(s_tcp_slots);
+    return ret;
+}
+
+void sock_budget_get_stats(sock_budget_stats_t* stats)
+{
+    if (!s_lock) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *stats = s_stats;
+    xSemaphoreGive(s_lock);
+}
+
+void sock_budget_log_stats(void)
+{
+    sock_budget_stats_t stats;
+    sock_budget_get_stats(&stats);
+    ESP_LOGI(TAG, "Sockets: %lu/%d TCP in use (peak %lu), %lu denied, %lu allocation failures, %lu UDP reopens, "
+             "%lu closed without RST",
+             (unsigned long)stats.tcp_in_use, SOCK_BUDGET_TCP_SLOTS, (unsigned long)stats.tcp_peak,
+             (unsigned long)stats.tcp_denied, (unsigned long)stats.alloc_failures, (unsigned long)stats.udp_reopens,
+             (unsigned long)stats.linger_failures);
+}
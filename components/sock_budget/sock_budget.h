@@ -0,0 +1,96 @@
+#ifndef SOCK_BUDGET_H
+#define SOCK_BUDGET_H
+
+#include "esp_err.h"
+#include "sdkconfig.h"
+#include "lwip/sockets.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef CONFIG_LWIP_MAX_SOCKETS
+#define SOCK_BUDGET_MAX_SOCKETS CONFIG_LWIP_MAX_SOCKETS
+#else
+#define SOCK_BUDGET_MAX_SOCKETS 10
+#endif
+// Kept out of the TCP budget: the shared IPv4 and IPv6 UDP sockets, plus one for lwIP
+// users that don't go through here (DNS, SNTP)
+#define SOCK_BUDGET_RESERVED 3
+#define SOCK_BUDGET_TCP_SLOTS (SOCK_BUDGET_MAX_SOCKETS - SOCK_BUDGET_RESERVED)
+
+typedef struct {
+    uint32_t tcp_in_use;        // TCP sockets open right now
+    uint32_t tcp_peak;          // Most TCP sockets open at once
+    uint32_t tcp_denied;        // TCP opens refused because every slot was taken
+    uint32_t alloc_failures;    // socket() failures (pool exhausted elsewhere, out of memory)
+    uint32_t udp_reopens;       // Shared UDP sockets dropped after failing sends
+    uint32_t linger_failures;   // TCP sockets closed with FIN because SO_LINGER was refused
+} sock_budget_stats_t;
+
+/**
+ * @brief Set up the budget; call once at startup, before any task opens a socket
+ * @return ESP_OK, ESP_ERR_NO_MEM
+ */
+esp_err_t sock_budget_init(void);
+
+/**
+ * @brief Send a datagram over the shared UDP socket of the address family
+ *
+ * One socket per family serves every sender (WoL, WiFi keep-alive); it is opened on first
+ * use, with SO_BROADCAST for IPv4.
+ *
+ * @param family AF_INET or AF_INET6
+ * @param data Payload
+ * @param len Payload length
+ * @param to Destination
+ * @param to_len Destination length
+ * @return Bytes sent, or -1 with errno set
+ */
+ssize_t sock_budget_udp_sendto(int family, const void* data, size_t len, const struct sockaddr* to,
+                               socklen_t to_len);
+
+/**
+ * @brief Drop the shared UDP socket of a family; the next send opens a new one
+ *
+ * For senders that saw every send fail, e.g. on a socket left stale by a reconnect.
+ *
+ * @param family AF_INET or AF_INET6
+ */
+void sock_budget_udp_reset(int family);
+
+/**
+ * @brief Open a TCP socket if a slot is free
+ * @return Socket, or -1 when the budget is used up or socket() failed (counted in the stats)
+ */
+int sock_budget_tcp_open(void);
+
+/**
+ * @brief Close a TCP socket from sock_budget_tcp_open() and free its slot
+ *
+ * Closes with SO_LINGER 0: lwIP sends RST and frees the PCB at once instead of leaving
+ * it in TIME_WAIT (needs CONFIG_LWIP_SO_LINGER). The socket is closed and its slot freed
+ * either way.
+ *
+ * @param sock Socket
+ * @return ESP_OK, ESP_ERR_NOT_SUPPORTED if SO_LINGER was refused (closed with FIN instead)
+ */
+esp_err_t sock_budget_tcp_close(int sock);
+
+/**
+ * @brief Read the counters
+ * @param stats Output
+ */
+void sock_budget_get_stats(sock_budget_stats_t* stats);
+
+/**
+ * @brief Log the counters
+ */
+void sock_budget_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SOCK_BUDGET_H
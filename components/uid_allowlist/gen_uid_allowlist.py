@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""Generate the perfect-hash UID allowlist table from a UID list file.
+
+List format: one UID per line as hex, bytes optionally separated by spaces,
+:' or '-', optionally followed by the keyword 'admin' for cards that manage
+enrollment, 'wakeall' for cards that wake every PC and/or 'profile=N' (0-15)
+to pick the PC the card logs in to.
+Everything after '#' is a comment. UIDs must be 4, 7 or 10 bytes.
+
+    04:A1:B2:C3:D4:E5:F6   # Alice
+    04:11:22:33:44:55:66 profile=1
+    DEADBEEF admin         # Enrollment card
+    CAFEF00D wakeall       # Morning card for the whole row
+"""
+
+import argparse
+import math
+import sys
+
+MAX_UID_LENGTH = 10
+VALID_LENGTHS = (4, 7, 10)
+FLAG_ADMIN = 0x01  # UID_ALLOWLIST_FLAG_ADMIN
+FLAG_WAKE_ALL = 0x02  # UID_ALLOWLIST_FLAG_WAKE_ALL
+PROFILE_SHIFT = 4  # UID_ALLOWLIST_PROFILE_SHIFT
+MAX_PROFILE = 15
+KEYS_PER_BUCKET = 4
+LOAD_FACTOR = 0.9
+MAX_DISPLACEMENT = 0xFFFFFFFF
+MASK = 0xFFFFFFFF
+
+
+def uid_hash(uid, seed):
+    """Must match uid_hash() in uid_allowlist.c."""
+    h = 2166136261 ^ seed
+    h = ((h ^ len(uid)) * 16777619) & MASK
+    for b in uid + bytes(MAX_UID_LENGTH - len(uid)):
+        h = ((h ^ b) * 16777619) & MASK
+    h ^= h >> 16
+    h = (h * 0x85EBCA6B) & MASK
+    h ^= h >> 13
+    h = (h * 0xC2B2AE35) & MASK
+    h ^= h >> 16
+    return h
+
+
+def parse_list(path):
+    """Return a list of (uid, flags)."""
+    entries = []
+    seen = set()
+    with open(path, encoding='utf-8') as f:
+        for lineno, line in enumerate(f, 1):
+            text = line.split('#', 1)[0]
+            for sep in ':-':
+                text = text.replace(sep, ' ')
+            tokens = text.split()
+            flags = 0
+            has_options = False
+            while tokens:
+                option = tokens[-1].lower()
+                if option == 'admin':
+                    flags |= FLAG_ADMIN
+                elif option == 'wakeall':
+                    flags |= FLAG_WAKE_ALL
+                elif option.startswith('profile='):
+                    try:
+                        profile = int(option[len('profile='):])
+                    except ValueError:
+                        profile = -1
+                    if not 0 <= profile <= MAX_PROFILE:
+                        sys.exit(f'{path}:{lineno}: profile must be 0-{MAX_PROFILE}')
+                    flags |= profile << PROFILE_SHIFT
+                else:
+                    break
+                has_options = True
+                tokens.pop()
+            if not tokens:
+                if has_options:
+                    sys.exit(f'{path}:{lineno}: options without UID')
+                continue
+            try:
+                uid = bytes.fromhex(''.join(tokens))
+            except ValueError:
+                sys.exit(f'{path}:{lineno}: invalid hex UID')
+            if len(uid) not in VALID_LENGTHS:
+                sys.exit(f'{path}:{lineno}: UID must be 4, 7 or 10 bytes, got {len(uid)}')
+            if uid in seen:
+                print(f'{path}:{lineno}: warning: duplicate UID {uid.hex()}', file=sys.stderr)
+                continue
+            seen.add(uid)
+            entries.append((uid, flags))
+    return entries
+
+
+def build_table(entries):
+    """Hash-and-displace (CHD): find a seed per bucket that maps its keys to free slots."""
+    uids = [uid for uid, _ in entries]
+    bucket_count = max(1, math.ceil(len(uids) / KEYS_PER_BUCKET))
+    slot_count = max(1, math.ceil(len(uids) / LOAD_FACTOR))
+
+    buckets = [[] for _ in range(bucket_count)]
+    for uid in uids:
+        buckets[uid_hash(uid, 0) % bucket_count].append(uid)
+
+    displacements = [0] * bucket_count
+    slots = [None] * slot_count
+    for index in sorted(range(bucket_count), key=lambda i: len(buckets[i]), reverse=True):
+        keys = buckets[index]
+        if not keys:
+            break
+        for seed in range(1, MAX_DISPLACEMENT + 1):
+            positions = [uid_hash(uid, seed) % slot_count for uid in keys]
+            if len(set(positions)) == len(positions) and all(slots[p] is None for p in positions):
+                break
+        else:
+            sys.exit('no perfect hash found')
+        displacements[index] = seed
+        for uid, pos in zip(keys, positions):
+            slots[pos] = uid
+    return displacements, slots
+
+
+def write_table(path, source, entries, displacements, slots):
+    flags = dict(entries)
+    out = []
+    out.append(f'// Generated by gen_uid_allowlist.py from {source}. Do not edit.')
+    out.append('#include "uid_allowlist_table.h"')
+    out.append('')
+    out.append(f'const uint32_t uid_allowlist_count = {len(entries)};')
+    out.append(f'const uint32_t uid_allowlist_bucket_count = {len(displacements)};')
+    out.append(f'const uint32_t uid_allowlist_slot_count = {len(slots)};')
+    out.append('')
+    out.append('const uint32_t uid_allowlist_displacements[] = {')
+    for i in range(0, len(displacements), 8):
+        out.append('    ' + ' '.join(f'{d}u,' for d in displacements[i:i + 8]))
+    out.append('};')
+    out.append('')
+    out.append('const uid_allowlist_entry_t uid_allowlist_slots[] = {')
+    for uid in slots:
+        if uid is None:
+            out.append('    { 0 },')
+        else:
+            data = ', '.join(f'0x{b:02X}' for b in uid)
+            out.append(f'    {{ {len(uid)}, {{ {data} }}, 0x{flags[uid]:02X} }},')
+    out.append('};')
+    with open(path, 'w', encoding='utf-8') as f:
+        f.write('\n'.join(out) + '\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('uid_list', help='UID list file')
+    parser.add_argument('output', help='generated C source')
+    args = parser.parse_args()
+
+    entries = parse_list(args.uid_list)
+    displacements, slots = build_table(entries)
+    write_table(args.output, args.uid_list, entries, displacements, slots)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+"""Build an allowlist partition blob from a UID list file.
+
+Uses the same list format as gen_uid_allowlist.py. Flash the result into the
+slot that is not active, with a higher version than the active list:
+
+    parttool.py write_partition --partition-name allowlist_b --input allowlist.bin
+"""
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from gen_uid_allowlist import MAX_UID_LENGTH, parse_list  # noqa: E402
+
+BLOB_MAGIC = 0x4C444955  # "UIDL"
+BLOB_FORMAT = 1
+RECORD = struct.Struct(f'<B{MAX_UID_LENGTH}sB')      # uid_allowlist_record_t
+HEADER = struct.Struct('<IHHIIIII')                  # uid_allowlist_blob_header_t without header_crc
+
+
+def build_blob(entries, version):
+    # Sort key matches the firmware's memcmp over length + padded UID
+    keys = sorted((len(uid), uid.ljust(MAX_UID_LENGTH, b'\0'), flags) for uid, flags in entries)
+    records = b''.join(RECORD.pack(length, uid, flags) for length, uid, flags in keys)
+    header = HEADER.pack(BLOB_MAGIC, BLOB_FORMAT, RECORD.size, version, len(keys),
+                         zlib.crc32(records), 0, 0)
+    return header + struct.pack('<I', zlib.crc32(header)) + records
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('uid_list', help='UID list file')
+    parser.add_argument('output', help='blob to write')
+    parser.add_argument('--version', type=int, required=True,
+                        help='list version, must be higher than the list on the device')
+    parser.add_argument('--partition-size', type=lambda s: int(s, 0), default=0x70000,
+                        help='slot size (default: 0x70000)')
+    args = parser.parse_args()
+
+    if not 0 < args.version <= 0xFFFFFFFF:
+        sys.exit('version must be between 1 and 4294967295')
+
+    blob = build_blob(parse_list(args.uid_list), args.version)
+    if len(blob) > args.partition_size:
+        sys.exit(f'blob is {len(blob)} bytes, slot holds {args.partition_size}')
+    with open(args.output, 'wb') as f:
+        f.write(blob)
+    print(f'{args.output}: {(len(blob) - 32) // RECORD.size} UIDs, version {args.version}, {len(blob)} bytes')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,67 @@
+#include "uid_allowlist.h"
+#include "uid_allowlist_table.h"
+#include "string.h"
+
+// Must match uid_hash() in gen_uid_allowlist.py
+static uint32_t uid_hash(const uint8_t* key, uint8_t length, uint32_t seed)
+{
+    uint32_t h = 2166136261u ^ seed;   // FNV-1a over length and padded UID
+    h = (h ^ length) * 16777619u;
+    for (int i = 0; i < UID_ALLOWLIST_MAX_UID_LENGTH; i++) {
+        h = (h ^ key[i]) * 16777619u;
+    }
+    h ^= h >> 16;                      // murmur3 finaliser
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+// Returns the matching slot or NULL; constant time either way
+static const uid_allowlist_entry_t* find_entry(const uint8_t* uid, uint8_t uid_length)
+{
+    if (!uid || (uid_length != 4 && uid_length != 7 && uid_length != 10)) {
+        return NULL;
+    }
+
+    uint8_t key[UID_ALLOWLIST_MAX_UID_LENGTH] = {0};
+    memcpy(key, uid, uid_length);
+
+    // Hash-and-displace: the bucket picks the seed that sends every key of the bucket to its own slot
+    uint32_t bucket = uid_hash(key, uid_length, 0) % uid_allowlist_bucket_count;
+    uint32_t slot = uid_hash(key, uid_length, uid_allowlist_displacements[bucket]) % uid_allowlist_slot_count;
+    const uid_allowlist_entry_t* entry = &uid_allowlist_slots[slot];
+
+    // No early exit; empty slots have length 0 and never match
+    uint8_t diff = entry->length ^ uid_length;
+    for (int i = 0; i < UID_ALLOWLIST_MAX_UID_LENGTH; i++) {
+        diff |= entry->uid[i] ^ key[i];
+    }
+    return diff == 0 ? entry : NULL;
+}
+
+bool uid_allowlist_contains(const uint8_t* uid, uint8_t uid_length)
+{
+    return find_entry(uid, uid_length) != NULL;
+}
+
+bool uid_allowlist_lookup(const uint8_t* uid, uint8_t uid_length, uint8_t* flags)
+{
+    const uid_allowlist_entry_t* entry = find_entry(uid, uid_length);
+    if (entry && flags) {
+        *flags = entry->flags;
+    }
+    return entry != NULL;
+}
+
+bool uid_allowlist_is_admin(const uint8_t* uid, uint8_t uid_length)
+{
+    const uid_allowlist_entry_t* entry = find_entry(uid, uid_length);
+    return entry && (entry->flags & UID_ALLOWLIST_FLAG_ADMIN);
+}
+
+size_t uid_allowlist_size(void)
+{
+    return uid_allowlist_count;
+}
@@ -0,0 +1,65 @@
+#ifndef UID_ALLOWLIST_H
+#define UID_ALLOWLIST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UID_ALLOWLIST_MAX_UID_LENGTH 10   // 4 (single), 7 (double) or 10 (triple size) byte UIDs
+
+#define UID_ALLOWLIST_FLAG_ADMIN     0x01 // Card manages runtime enrollment ("admin" in the list file)
+#define UID_ALLOWLIST_FLAG_WAKE_ALL  0x02 // Card wakes every PC instead of logging in ("wakeall")
+#define UID_ALLOWLIST_PROFILE_SHIFT  4    // Bits 4-7: PC profile index ("profile=N")
+#define UID_ALLOWLIST_PROFILE(flags) (((flags) >> UID_ALLOWLIST_PROFILE_SHIFT) & 0x0F)
+
+// One table slot; length 0 marks an empty slot
+typedef struct {
+    uint8_t length;
+    uint8_t uid[UID_ALLOWLIST_MAX_UID_LENGTH];
+    uint8_t flags;
+} uid_allowlist_entry_t;
+
+/**
+ * @brief Check a UID against the built-in allowlist
+ *
+ * O(1) perfect-hash lookup. Hashing and comparison always cover the full
+ * padded UID, so the time taken does not depend on the UID or on how close
+ * it is to an authorized one.
+ *
+ * @param uid Card UID
+ * @param uid_length UID length (4, 7 or 10)
+ * @return true if the UID is authorized
+ */
+bool uid_allowlist_contains(const uint8_t* uid, uint8_t uid_length);
+
+/**
+ * @brief Look up a UID in the built-in allowlist and return its flags
+ * @param uid Card UID
+ * @param uid_length UID length (4, 7 or 10)
+ * @param flags Receives UID_ALLOWLIST_FLAG_* and the profile bits of a listed UID
+ * @return true if the UID is authorized
+ */
+bool uid_allowlist_lookup(const uint8_t* uid, uint8_t uid_length, uint8_t* flags);
+
+/**
+ * @brief Check whether a UID is an admin card in the built-in allowlist
+ * @param uid Card UID
+ * @param uid_length UID length (4, 7 or 10)
+ * @return true if the UID is listed with the admin flag
+ */
+bool uid_allowlist_is_admin(const uint8_t* uid, uint8_t uid_length);
+
+/**
+ * @brief Number of UIDs compiled into the allowlist
+ */
+size_t uid_allowlist_size(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UID_ALLOWLIST_H
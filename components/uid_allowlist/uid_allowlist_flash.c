@@ -0,0 +1,180 @@
+#include "uid_allowlist_flash.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "string.h"
+
+static const char *TAG = "uid_allowlist";
+
+#define RECORD_KEY_SIZE   (1 + 10)   // length + UID, the sort key
+
+typedef struct {
+    const esp_partition_t* partition;
+    esp_partition_mmap_handle_t handle;
+    const uid_allowlist_blob_header_t* header;
+    const uid_allowlist_record_t* records;
+} slot_t;
+
+// Mapped once at boot and never changed, so lookups need no lock
+static slot_t s_active;
+
+static uint32_t header_crc(const uid_allowlist_blob_header_t* header)
+{
+    return esp_rom_crc32_le(0, (const uint8_t*)header, offsetof(uid_allowlist_blob_header_t, header_crc));
+}
+
+static bool header_valid(const uid_allowlist_blob_header_t* header, const esp_partition_t* partition)
+{
+    if (header->magic != UID_ALLOWLIST_BLOB_MAGIC ||
+        header->format != UID_ALLOWLIST_BLOB_FORMAT ||
+        header->record_size != sizeof(uid_allowlist_record_t) ||
+        header->header_crc != header_crc(header)) {
+        return false;
+    }
+    size_t max_records = (partition->size - sizeof(*header)) / sizeof(uid_allowlist_record_t);
+    return header->count <= max_records;
+}
+
+// Map a slot and check it end to end: header, record CRC and sort order
+static esp_err_t slot_map(const esp_partition_t* partition, slot_t* slot)
+{
+    uid_allowlist_blob_header_t header;
+    esp_err_t ret = esp_partition_read(partition, 0, &header, sizeof(header));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (!header_valid(&header, partition)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const void* base;
+    size_t size = sizeof(header) + (size_t)header.count * sizeof(uid_allowlist_record_t);
+    ret = esp_partition_mmap(partition, 0, size, ESP_PARTITION_MMAP_DATA, &base, &slot->handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    slot->partition = partition;
+    slot->header = base;
+    slot->records = (const uid_allowlist_record_t*)(slot->header + 1);
+
+    if (esp_rom_crc32_le(0, (const uint8_t*)slot->records, size - sizeof(header)) != header.records_crc) {
+        ret = ESP_ERR_INVALID_CRC;
+    } else {
+        // Binary search relies on strictly ascending keys
+        for (uint32_t i = 1; i < header.count; i++) {
+            if (memcmp(&slot->records[i - 1], &slot->records[i], RECORD_KEY_SIZE) >= 0) {
+                ret = ESP_ERR_INVALID_RESPONSE;
+                break;
+            }
+        }
+    }
+    if (ret != ESP_OK) {
+        esp_partition_munmap(slot->handle);
+        memset(slot, 0, sizeof(*slot));
+    }
+    return ret;
+}
+
+static const esp_partition_t* find_slot(const char* label)
+{
+    return esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+}
+
+esp_err_t uid_allowlist_flash_init(void)
+{
+    if (s_active.header) {
+        return ESP_OK;
+    }
+
+    const esp_partition_t* partitions[2] = {
+        find_slot(UID_ALLOWLIST_PARTITION_A),
+        find_slot(UID_ALLOWLIST_PARTITION_B),
+    };
+    slot_t best = {0};
+    for (int i = 0; i < 2; i++) {
+        slot_t slot = {0};
+        if (!partitions[i] || slot_map(partitions[i], &slot) != ESP_OK) {
+            continue;
+        }
+        if (!best.header || slot.header->version > best.header->version) {
+            if (best.header) {
+                esp_partition_munmap(best.handle);
+            }
+            best = slot;
+        } else {
+            esp_partition_munmap(slot.handle);
+        }
+    }
+
+    if (!best.header) {
+        ESP_LOGW(TAG, "No valid allowlist in flash");
+        return ESP_ERR_NOT_FOUND;
+    }
+    s_active = best;
+    ESP_LOGI(TAG, "✅ Allowlist v%lu active in %s (%lu UIDs)",
+             (unsigned long)s_active.header->version, s_active.partition->label,
+             (unsigned long)s_active.header->count);
+    return ESP_OK;
+}
+
+// Binary search over the mapped records; flags of the match go to *flags
+static bool flash_find(const uint8_t* uid, uint8_t uid_length, uint8_t* flags)
+{
+    if (!s_active.header || !uid || (uid_length != 4 && uid_length != 7 && uid_length != 10)) {
+        return false;
+    }
+
+    uint8_t key[RECORD_KEY_SIZE] = {0};
+    key[0] = uid_length;
+    memcpy(key + 1, uid, uid_length);
+
+    uint32_t lo = 0;
+    uint32_t hi = s_active.header->count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        int cmp = memcmp(&s_active.records[mid], key, RECORD_KEY_SIZE);
+        if (cmp == 0) {
+            *flags = s_active.records[mid].flags;
+            return true;
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return false;
+}
+
+bool uid_allowlist_flash_contains(const uint8_t* uid, uint8_t uid_length)
+{
+    uint8_t flags;
+    return flash_find(uid, uid_length, &flags);
+}
+
+bool uid_allowlist_flash_lookup(const uint8_t* uid, uint8_t uid_length, uint8_t* flags)
+{
+    uint8_t found_flags = 0;
+    if (!flash_find(uid, uid_length, &found_flags)) {
+        return false;
+    }
+    if (flags) {
+        *flags = found_flags;
+    }
+    return true;
+}
+
+bool uid_allowlist_flash_is_admin(const uint8_t* uid, uint8_t uid_length)
+{
+    uint8_t flags = 0;
+    return flash_find(uid, uid_length, &flags) && (flags & UID_ALLOWLIST_FLAG_ADMIN);
+}
+
+size_t uid_allowlist_flash_size(void)
+{
+    return s_active.header ? s_active.header->count : 0;
+}
+
+uint32_t uid_allowlist_flash_version(void)
+{
+    return s_active.header ? s_active.header->version : 0;
+}
@@ -0,0 +1,98 @@
+#ifndef UID_ALLOWLIST_FLASH_H
+#define UID_ALLOWLIST_FLASH_H
+
+#include "esp_err.h"
+#include "esp_partition.h"
+#include "uid_allowlist.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Allowlist blob stored in one of two data partitions (allowlist_a / allowlist_b):
+ *
+ *   uid_allowlist_blob_header_t
+ *   uid_allowlist_record_t[count], sorted by length then UID bytes
+ *
+ * The slot holding the valid blob with the highest version is mapped at boot.
+ * Updates are written to the other slot with parttool.py; a slot whose header
+ * or record CRC doesn't check out is skipped, so an interrupted write leaves
+ * the previous list active. Build blobs with mk_uid_allowlist_blob.py.
+ */
+
+#define UID_ALLOWLIST_PARTITION_A     "allowlist_a"
+#define UID_ALLOWLIST_PARTITION_B     "allowlist_b"
+
+#define UID_ALLOWLIST_BLOB_MAGIC      0x4C444955   // "UIDL"
+#define UID_ALLOWLIST_BLOB_FORMAT     1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t format;
+    uint16_t record_size;     // sizeof(uid_allowlist_record_t)
+    uint32_t version;         // List version; must increase with every update
+    uint32_t count;           // Number of records
+    uint32_t records_crc;     // CRC32 of the record array
+    uint32_t reserved[2];
+    uint32_t header_crc;      // CRC32 of the header bytes above
+} uid_allowlist_blob_header_t;
+
+typedef struct {
+    uint8_t length;           // 4, 7 or 10
+    uint8_t uid[10];          // Zero padded
+    uint8_t flags;            // UID_ALLOWLIST_FLAG_*
+} uid_allowlist_record_t;
+
+_Static_assert(sizeof(uid_allowlist_blob_header_t) == 32, "allowlist header layout is shared with the host tool");
+_Static_assert(sizeof(uid_allowlist_record_t) == 12, "allowlist record layout is shared with the host tool");
+
+/**
+ * @brief Map the newest valid allowlist slot
+ * @return ESP_OK, ESP_ERR_NOT_FOUND if no slot holds a valid list
+ */
+esp_err_t uid_allowlist_flash_init(void);
+
+/**
+ * @brief Binary search the mapped allowlist
+ * @param uid Card UID
+ * @param uid_length UID length (4, 7 or 10)
+ * @return true if the UID is in the list
+ */
+bool uid_allowlist_flash_contains(const uint8_t* uid, uint8_t uid_length);
+
+/**
+ * @brief Binary search the mapped allowlist and return the record flags
+ * @param uid Card UID
+ * @param uid_length UID length (4, 7 or 10)
+ * @param flags Receives UID_ALLOWLIST_FLAG_* and the profile bits of a listed UID
+ * @return true if the UID is in the list
+ */
+bool uid_allowlist_flash_lookup(const uint8_t* uid, uint8_t uid_length, uint8_t* flags);
+
+/**
+ * @brief Check whether a UID is an admin card in the mapped allowlist
+ * @param uid Card UID
+ * @param uid_length UID length (4, 7 or 10)
+ * @return true if the UID is listed with UID_ALLOWLIST_FLAG_ADMIN
+ */
+bool uid_allowlist_flash_is_admin(const uint8_t* uid, uint8_t uid_length);
+
+/**
+ * @brief Number of UIDs in the mapped list (0 if none is mapped)
+ */
+size_t uid_allowlist_flash_size(void);
+
+/**
+ * @brief Version of the mapped list (0 if none is mapped)
+ */
+uint32_t uid_allowlist_flash_version(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UID_ALLOWLIST_FLASH_H
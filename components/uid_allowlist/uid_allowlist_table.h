@@ -0,0 +1,13 @@
+#ifndef UID_ALLOWLIST_TABLE_H
+#define UID_ALLOWLIST_TABLE_H
+
+#include "uid_allowlist.h"
+
+// Defined in the generated uid_allowlist_table.c (see gen_uid_allowlist.py)
+extern const uint32_t uid_allowlist_count;
+extern const uint32_t uid_allowlist_bucket_count;
+extern const uint32_t uid_allowlist_slot_count;
+extern const uint32_t uid_allowlist_displacements[];
+extern const uid_allowlist_entry_t uid_allowlist_slots[];
+
+#endif // UID_ALLOWLIST_TABLE_H
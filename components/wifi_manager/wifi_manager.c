@@ -1,4 +1,5 @@
 #include "wifi_manager.h"
+#include "sock_budget.h"
 #include "esp_wifi.h"
 #include "esp_netif.h"
 #include "esp_event.h"
@@ -21,6 +22,8 @@ static EventGroupHandle_t s_wifi_event_group;
 static int s_retry_num = 0;
 static bool s_wifi_connected = false;
 static TaskHandle_t s_wifi_keepalive_task = NULL;
+static wifi_manager_event_cb_t s_event_cb = NULL;
+static void* s_event_cb_arg = NULL;
 
 #define MAX_RETRY 5
 #define KEEPALIVE_INTERVAL_MS 2000   // Send keepalive every 2 seconds
@@ -37,20 +40,17 @@ static void wifi_keepalive_task(void *pvParameters)
             if (netif) {
                 esp_netif_ip_info_t ip_info;
                 if (esp_netif_get_ip_info(netif, &ip_info) == ESP_OK) {
-                    // Create a simple UDP packet to keep connection active
-                    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-                    if (sock >= 0) {
-                        struct sockaddr_in addr;
-                        memset(&addr, 0, sizeof(addr));
-                        addr.sin_family = AF_INET;
-                        addr.sin_port = htons(53);  // DNS port
-                        addr.sin_addr.s_addr = ip_info.gw.addr;  // Gateway IP
-                        
-                        char keepalive_data[] = "keepalive";
-                        sendto(sock, keepalive_data, strlen(keepalive_data), 0, 
-                               (struct sockaddr*)&addr, sizeof(addr));
-                        close(sock);
-                        
+                    // Simple UDP packet to keep connection active, over the shared socket
+                    // instead of a new one every time
+                    struct sockaddr_in addr;
+                    memset(&addr, 0, sizeof(addr));
+                    addr.sin_family = AF_INET;
+                    addr.sin_port = htons(53);  // DNS port
+                    addr.sin_addr.s_addr = ip_info.gw.addr;  // Gateway IP
+                    
+                    char keepalive_data[] = "keepalive";
+                    if (sock_budget_udp_sendto(AF_INET, keepalive_data, strlen(keepalive_data),
+                                               (struct sockaddr*)&addr, sizeof(addr)) >= 0) {
                         ESP_LOGD(TAG, "📡 Keep-alive packet sent to gateway");
                     }
                 }
@@ -67,6 +67,14 @@ static void event_handler(void* arg, esp_event_base_t event_base,
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
         ESP_LOGI(TAG, "📡 WiFi STA started, attempting connection...");
         esp_wifi_connect();
+#if CONFIG_LWIP_IPV6
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED) {
+        // Link-local address so IPv6 (WoL to ff02::1) can be sent on this link
+        esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+        if (netif && esp_netif_create_ip6_linklocal(netif) != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to create IPv6 link-local address");
+        }
+#endif
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
         wifi_event_sta_disconnected_t* disconnected = (wifi_event_sta_disconnected_t*) event_data;
         ESP_LOGW(TAG, "📡 WiFi disconnected (attempt %d/%d) - Reason: %d", 
@@ -168,6 +176,9 @@ static void event_handler(void* arg, esp_event_base_t event_base,
             xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
             ESP_LOGE(TAG, "❌ Failed to connect to AP after %d attempts", MAX_RETRY);
         }
+        if (s_wifi_connected && s_event_cb) {
+            s_event_cb(false, s_event_cb_arg);
+        }
         s_wifi_connected = false;
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
         ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
@@ -177,6 +188,9 @@ static void event_handler(void* arg, esp_event_base_t event_base,
         s_retry_num = 0;
         xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
         s_wifi_connected = true;
+        if (s_event_cb) {
+            s_event_cb(true, s_event_cb_arg);
+        }
         
         // Start keep-alive task to maintain connection
         if (s_wifi_keepalive_task == NULL) {
@@ -190,6 +204,12 @@ static void event_handler(void* arg, esp_event_base_t event_base,
     }
 }
 
+void wifi_manager_set_event_callback(wifi_manager_event_cb_t cb, void* arg)
+{
+    s_event_cb_arg = arg;
+    s_event_cb = cb;
+}
+
 esp_err_t wifi_manager_init(void)
 {
     ESP_LOGI(TAG, "🔧 Starting WiFi manager initialization...");
@@ -8,6 +8,13 @@
 extern "C" {
 #endif
 
+/**
+ * @brief Connection state callback
+ * @param connected true when an IP address was obtained, false on disconnect
+ * @param arg User argument
+ */
+typedef void (*wifi_manager_event_cb_t)(bool connected, void* arg);
+
 /**
  * @brief Initialize WiFi manager
  * @return ESP_OK on success
@@ -35,6 +42,15 @@ esp_err_t wifi_manager_disconnect(void);
 bool wifi_manager_is_connected(void);
 esp_err_t wifi_manager_check_connection(void);
 
+/**
+ * @brief Register a callback for connection changes
+ *
+ * Runs in the default event loop task; keep it short (e.g. post to a queue).
+ * @param cb Callback, NULL to remove
+ * @param arg User argument
+ */
+void wifi_manager_set_event_callback(wifi_manager_event_cb_t cb, void* arg);
+
 /**
  * @brief Get current IP address
  * @param ip_str Buffer to store IP address string
@@ -1,4 +1,5 @@
 #include "wol_client.h"
+#include "sock_budget.h"
 #include "esp_log.h"
 #include "lwip/err.h"
 #include "lwip/sockets.h"
@@ -7,6 +8,7 @@
 #include <fcntl.h>
 #include <errno.h>
 #include "esp_netif.h"
+#include "esp_timer.h"
 #include "lwip/dns.h"
 #include "string.h"
 #include "freertos/FreeRTOS.h"
@@ -14,42 +16,46 @@
 
 static const char *TAG = "wol_client";
 
-esp_err_t wol_send_magic_packet(const char* mac_address, const char* ip_address, uint16_t port)
-{
-    if (!mac_address) {
-        ESP_LOGE(TAG, "MAC address is required");
-        return ESP_ERR_INVALID_ARG;
-    }
+#define WOL_PORT_DISCARD 9
+#define WOL_PORT_ECHO    7
 
-    // Parse MAC address
-    uint8_t mac[6];
+// Common Windows ports: 3389 (RDP), 135 (RPC), 445 (SMB). Open or refused on any of them
+// means the host is up.
+static const uint16_t windows_ports[] = {3389, 135, 445};
+#define NUM_WINDOWS_PORTS (sizeof(windows_ports) / sizeof(windows_ports[0]))
+
+static esp_err_t parse_mac(const char* mac_address, uint8_t mac[6])
+{
     if (sscanf(mac_address, "%02hhx:%02hhx:%02hhx:%02hhx:%02hhx:%02hhx",
                &mac[0], &mac[1], &mac[2], &mac[3], &mac[4], &mac[5]) != 6) {
         ESP_LOGE(TAG, "Invalid MAC address format: %s", mac_address);
         return ESP_ERR_INVALID_ARG;
     }
+    return ESP_OK;
+}
 
-    // Create magic packet (6 bytes of 0xFF + 16 repetitions of MAC address)
-    uint8_t magic_packet[102];
-    memset(magic_packet, 0xFF, 6);
+// Magic packet: 6 bytes of 0xFF + 16 repetitions of the MAC address
+static void build_magic_packet(const uint8_t mac[6], uint8_t packet[WOL_MAGIC_PACKET_SIZE])
+{
+    memset(packet, 0xFF, 6);
     for (int i = 0; i < 16; i++) {
-        memcpy(magic_packet + 6 + (i * 6), mac, 6);
+        memcpy(packet + 6 + (i * 6), mac, 6);
     }
+}
 
-    // Create UDP socket
-    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-    if (sock < 0) {
-        ESP_LOGE(TAG, "Failed to create socket");
-        return ESP_FAIL;
+esp_err_t wol_send_magic_packet(const char* mac_address, const char* ip_address, uint16_t port)
+{
+    if (!mac_address) {
+        ESP_LOGE(TAG, "MAC address is required");
+        return ESP_ERR_INVALID_ARG;
     }
 
-    // Set socket options
-    int broadcast = 1;
-    if (setsockopt(sock, SOL_SOCKET, SO_BROADCAST, &broadcast, sizeof(broadcast)) < 0) {
-        ESP_LOGE(TAG, "Failed to set broadcast option");
-        close(sock);
-        return ESP_FAIL;
+    uint8_t mac[6];
+    if (parse_mac(mac_address, mac) != ESP_OK) {
+        return ESP_ERR_INVALID_ARG;
     }
+    uint8_t magic_packet[WOL_MAGIC_PACKET_SIZE];
+    build_magic_packet(mac, magic_packet);
 
     struct sockaddr_in addr;
     memset(&addr, 0, sizeof(addr));
@@ -60,7 +66,6 @@ esp_err_t wol_send_magic_packet(const char* mac_address, const char* ip_address,
         // Directed WoL to specific IP
         if (inet_aton(ip_address, &addr.sin_addr) == 0) {
             ESP_LOGE(TAG, "Invalid IP address: %s", ip_address);
-            close(sock);
             return ESP_ERR_INVALID_ARG;
         }
         ESP_LOGI(TAG, "Sending directed WoL to %s:%d", ip_address, port);
@@ -71,155 +76,548 @@ esp_err_t wol_send_magic_packet(const char* mac_address, const char* ip_address,
     }
 
     // Send magic packet
-    ssize_t sent = sendto(sock, magic_packet, sizeof(magic_packet), 0,
-                         (struct sockaddr*)&addr, sizeof(addr));
+    ssize_t sent = sock_budget_udp_sendto(AF_INET, magic_packet, sizeof(magic_packet),
+                                          (struct sockaddr*)&addr, sizeof(addr));
     
     if (sent < 0) {
         ESP_LOGE(TAG, "Failed to send magic packet: %s", strerror(errno));
-        close(sock);
         return ESP_FAIL;
     }
 
     ESP_LOGI(TAG, "Magic packet sent successfully (%d bytes)", sent);
-    close(sock);
     return ESP_OK;
 }
 
-esp_err_t wol_send_magic_packet_all(const char* mac_address, const char* ip_address)
+esp_err_t wol_context_init(wol_context_t* ctx, const char* mac_address, const char* ip_address)
 {
-    if (!mac_address) {
+    if (!ctx || !mac_address) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    // Try directed unicast to PC IP on common ports
-    esp_err_t ok = ESP_FAIL;
+    memset(ctx, 0, sizeof(*ctx));
+    if (parse_mac(mac_address, ctx->mac) != ESP_OK) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    build_magic_packet(ctx->mac, ctx->packet);
+    ctx->packet_len = WOL_MAGIC_PACKET_SIZE;
+
     if (ip_address && strlen(ip_address) > 0) {
-        ESP_LOGI(TAG, "WoL: directed %s:9", ip_address);
-        if (wol_send_magic_packet(mac_address, ip_address, 9) == ESP_OK) ok = ESP_OK;
-        ESP_LOGI(TAG, "WoL: directed %s:7", ip_address);
-        if (wol_send_magic_packet(mac_address, ip_address, 7) == ESP_OK) ok = ESP_OK;
+        struct in_addr ip;
+        if (inet_aton(ip_address, &ip) == 0) {
+            ESP_LOGE(TAG, "Invalid IP address: %s", ip_address);
+            return ESP_ERR_INVALID_ARG;
+        }
+        ctx->directed_addr = ip.s_addr;
     }
+    return ESP_OK;
+}
 
-    // Compute subnet broadcast based on current STA IP/netmask
+esp_err_t wol_context_set_secureon(wol_context_t* ctx, const char* password)
+{
+    if (!ctx || ctx->packet[0] != 0xFF) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!password || !password[0]) {
+        ctx->packet_len = WOL_MAGIC_PACKET_SIZE;
+        return ESP_OK;
+    }
+
+    // 6 bytes in MAC notation, 4 bytes in hex or dotted decimal
+    uint8_t* suffix = ctx->packet + WOL_MAGIC_PACKET_SIZE;
+    unsigned int b[6];
+    char end;
+    int len = 0;
+    if (sscanf(password, "%2x:%2x:%2x:%2x:%2x:%2x%c", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5], &end) == 6) {
+        len = 6;
+    } else if (sscanf(password, "%2x:%2x:%2x:%2x%c", &b[0], &b[1], &b[2], &b[3], &end) == 4 ||
+               (sscanf(password, "%3u.%3u.%3u.%3u%c", &b[0], &b[1], &b[2], &b[3], &end) == 4 &&
+                b[0] <= 255 && b[1] <= 255 && b[2] <= 255 && b[3] <= 255)) {
+        len = 4;
+    } else {
+        ESP_LOGE(TAG, "Invalid SecureOn password format");
+        ctx->packet_len = WOL_MAGIC_PACKET_SIZE;
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < len; i++) {
+        suffix[i] = (uint8_t)b[i];
+    }
+    ctx->packet_len = WOL_MAGIC_PACKET_SIZE + len;
+    return ESP_OK;
+}
+
+esp_err_t wol_context_set_ipv6(wol_context_t* ctx, const char* ipv6_address, bool all_nodes)
+{
+    if (!ctx) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(ctx->directed_addr6, 0, sizeof(ctx->directed_addr6));
+    if (ipv6_address && strlen(ipv6_address) > 0) {
+        struct in6_addr ip6;
+        if (inet_pton(AF_INET6, ipv6_address, &ip6) != 1) {
+            ESP_LOGE(TAG, "Invalid IPv6 address: %s", ipv6_address);
+            return ESP_ERR_INVALID_ARG;
+        }
+        memcpy(ctx->directed_addr6, &ip6, sizeof(ctx->directed_addr6));
+    }
+    ctx->ipv6_all_nodes = all_nodes;
+    return ESP_OK;
+}
+
+static bool has_directed_ipv6(const wol_context_t* ctx)
+{
+    static const uint8_t none[16] = {0};
+    return memcmp(ctx->directed_addr6, none, sizeof(none)) != 0;
+}
+
+// Wait for the pacer's next slot; slots missed while idle are not made up for
+static void pace(wol_pacer_t* pacer)
+{
+    if (!pacer || !pacer->interval_us) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    if (pacer->next_us > now) {
+        TickType_t ticks = pdMS_TO_TICKS((pacer->next_us - now + 999) / 1000);
+        vTaskDelay(ticks ? ticks : 1);
+    } else {
+        pacer->next_us = now;
+    }
+    pacer->next_us += pacer->interval_us;
+}
+
+// One sendto, retried once when lwIP is out of pbufs mid-burst
+static bool send_packet(const wol_context_t* ctx, wol_pacer_t* pacer, const struct sockaddr* addr,
+                        socklen_t addr_len)
+{
+    pace(pacer);
+    ssize_t sent = sock_budget_udp_sendto(addr->sa_family, ctx->packet, ctx->packet_len, addr, addr_len);
+    if (sent < 0 && errno == ENOMEM) {
+        // Let the WiFi task drain the queue once
+        vTaskDelay(1);
+        sent = sock_budget_udp_sendto(addr->sa_family, ctx->packet, ctx->packet_len, addr, addr_len);
+    }
+    return sent >= 0;
+}
+
+// Link-local unicast and link-scope multicast need the STA interface as zone
+static bool ipv6_needs_scope(const uint8_t addr[16])
+{
+    return (addr[0] == 0xFE && (addr[1] & 0xC0) == 0x80) || (addr[0] == 0xFF && (addr[1] & 0x0F) == 0x02);
+}
+
+// Send the magic packet to every destination over the shared sockets; returns the number sent.
+// After a burst in which every send failed the sockets are dropped, in case a reconnect left
+// them stale.
+static int send_burst(const wol_context_t* ctx, wol_pacer_t* pacer, int* attempted)
+{
+    static const uint16_t ports[] = { WOL_PORT_DISCARD, WOL_PORT_ECHO };
+    const int num_ports = sizeof(ports) / sizeof(ports[0]);
+
+    // Directed, subnet broadcast (current STA IP/netmask), then limited broadcast
+    uint32_t targets[3];
+    int num_targets = 0;
+    if (ctx->directed_addr) {
+        targets[num_targets++] = ctx->directed_addr;
+    }
     esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
-    if (netif) {
-        esp_netif_ip_info_t ip_info;
-        if (esp_netif_get_ip_info(netif, &ip_info) == ESP_OK) {
-            uint32_t bcast_addr = (ip_info.ip.addr & ip_info.netmask.addr) | (~ip_info.netmask.addr);
-            struct in_addr bcast_in;
-            bcast_in.s_addr = bcast_addr;
-            char bcast_str[16];
-            const char *res = inet_ntoa_r(bcast_in, bcast_str, sizeof(bcast_str));
-            if (res != NULL) {
-                ESP_LOGI(TAG, "WoL: subnet broadcast %s:9", bcast_str);
-                if (wol_send_magic_packet(mac_address, bcast_str, 9) == ESP_OK) ok = ESP_OK;
-                ESP_LOGI(TAG, "WoL: subnet broadcast %s:7", bcast_str);
-                if (wol_send_magic_packet(mac_address, bcast_str, 7) == ESP_OK) ok = ESP_OK;
+    esp_netif_ip_info_t ip_info;
+    if (netif && esp_netif_get_ip_info(netif, &ip_info) == ESP_OK && ip_info.ip.addr != 0) {
+        targets[num_targets++] = (ip_info.ip.addr & ip_info.netmask.addr) | (~ip_info.netmask.addr);
+    }
+    targets[num_targets++] = INADDR_BROADCAST;
+
+    int sent_ok = 0;
+    *attempted = 0;
+    for (int t = 0; t < num_targets; t++) {
+        for (int p = 0; p < num_ports; p++) {
+            struct sockaddr_in addr = {
+                .sin_family = AF_INET,
+                .sin_port = htons(ports[p]),
+                .sin_addr.s_addr = targets[t],
+            };
+            (*attempted)++;
+            if (send_packet(ctx, pacer, (struct sockaddr*)&addr, sizeof(addr))) {
+                sent_ok++;
+            } else {
+                ESP_LOGD(TAG, "WoL to %s:%d failed: %s", inet_ntoa(addr.sin_addr), ports[p], strerror(errno));
             }
         }
     }
 
-    // Also try limited broadcast in case AP prefers it
-    const char *bcast_any = "255.255.255.255";
-    ESP_LOGI(TAG, "WoL: limited broadcast %s:9", bcast_any);
-    if (wol_send_magic_packet(mac_address, bcast_any, 9) == ESP_OK) ok = ESP_OK;
-    ESP_LOGI(TAG, "WoL: limited broadcast %s:7", bcast_any);
-    if (wol_send_magic_packet(mac_address, bcast_any, 7) == ESP_OK) ok = ESP_OK;
+    // Directed IPv6, then all-nodes multicast
+    static const uint8_t all_nodes[16] = { 0xFF, 0x02, [15] = 0x01 };
+    const uint8_t* targets6[2];
+    int num_targets6 = 0;
+    if (has_directed_ipv6(ctx)) {
+        targets6[num_targets6++] = ctx->directed_addr6;
+    }
+    if (ctx->ipv6_all_nodes) {
+        targets6[num_targets6++] = all_nodes;
+    }
+    uint32_t scope_id = netif ? (uint32_t)esp_netif_get_netif_impl_index(netif) : 0;
+    for (int t = 0; t < num_targets6; t++) {
+        for (int p = 0; p < num_ports; p++) {
+            struct sockaddr_in6 addr = {
+                .sin6_family = AF_INET6,
+                .sin6_port = htons(ports[p]),
+                .sin6_scope_id = ipv6_needs_scope(targets6[t]) ? scope_id : 0,
+            };
+            memcpy(&addr.sin6_addr, targets6[t], sizeof(addr.sin6_addr));
+            (*attempted)++;
+            if (send_packet(ctx, pacer, (struct sockaddr*)&addr, sizeof(addr))) {
+                sent_ok++;
+            } else {
+                ESP_LOGD(TAG, "WoL to IPv6 destination %d port %d failed: %s", t, ports[p], strerror(errno));
+            }
+        }
+    }
 
-    return ok;
+    if (sent_ok == 0) {
+        sock_budget_udp_reset(AF_INET);
+        if (num_targets6) {
+            sock_budget_udp_reset(AF_INET6);
+        }
+    }
+    return sent_ok;
 }
 
-bool wol_check_host_reachable(const char* ip_address, uint32_t timeout_ms)
+esp_err_t wol_context_send_burst(wol_context_t* ctx)
 {
-    if (!ip_address) {
-        ESP_LOGE(TAG, "IP address is required");
-        return false;
+    if (!ctx) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (ctx->packet[0] != 0xFF) {
+        // wol_context_init() failed or was never called
+        return ESP_ERR_INVALID_STATE;
     }
 
-    // Try TCP connection to a small prioritized set of common Windows ports
-    // 3389 (RDP), 135 (RPC), 445 (SMB). Keep list short to avoid long waits.
-    int ports[] = {3389, 135, 445};
-    int num_ports = sizeof(ports) / sizeof(ports[0]);
-    int per_port_timeout_ms = (int)timeout_ms / (num_ports > 0 ? num_ports : 1);
-    if (per_port_timeout_ms < 150) per_port_timeout_ms = 150; // minimum per port
+    int attempted;
+    int sent_ok = send_burst(ctx, NULL, &attempted);
+    ESP_LOGI(TAG, "WoL burst: %d/%d packets sent", sent_ok, attempted);
+    return sent_ok ? ESP_OK : ESP_FAIL;
+}
+
+uint32_t wol_moving_average(uint32_t average, uint32_t sample, uint32_t samples)
+{
+    return (samples == 0 || average == 0) ? sample : (uint32_t)(((uint64_t)average * 3 + sample) / 4);
+}
+
+esp_err_t wol_pacer_init(wol_pacer_t* pacer, uint32_t packets_per_second)
+{
+    if (!pacer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pacer->interval_us = packets_per_second ? 1000000 / packets_per_second : 0;
+    pacer->next_us = 0;
+    return ESP_OK;
+}
+
+esp_err_t wol_pacer_send_burst(wol_pacer_t* pacer, const wol_context_t* ctx)
+{
+    if (!pacer || !ctx) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (ctx->packet[0] != 0xFF) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    int attempted;
+    int sent_ok = send_burst(ctx, pacer, &attempted);
+    ESP_LOGD(TAG, "Paced WoL burst: %d/%d packets sent", sent_ok, attempted);
+    return sent_ok ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t wol_send_magic_packet_all(const char* mac_address, const char* ip_address)
+{
+    wol_context_t ctx;
+    esp_err_t err = wol_context_init(&ctx, mac_address, ip_address);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return wol_context_send_burst(&ctx);
+}
+
+// Reset a probe socket; counts the ones that fell back to FIN (an accepted connection then
+// holds a PCB in TIME_WAIT)
+static void close_probe(int sock, int* fin_closes)
+{
+    if (sock_budget_tcp_close(sock) == ESP_ERR_NOT_SUPPORTED) {
+        (*fin_closes)++;
+    }
+}
+
+// Non-blocking connects to all ports at once, waited on together. Sets a bit per port index
+// that accepted (open) or refused. With first_wins the first answer ends the probe;
+// otherwise it runs until every port has answered or timed out.
+static void probe_ports(const char* ip_address, const uint16_t* ports, int num_ports, uint32_t timeout_ms,
+                        bool first_wins, uint32_t* open_mask, uint32_t* refused_mask)
+{
+    *open_mask = 0;
+    *refused_mask = 0;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    if (inet_aton(ip_address, &addr.sin_addr) == 0) {
+        ESP_LOGE(TAG, "Invalid IP address: %s", ip_address);
+        return;
+    }
+
+    int socks[WOL_PROBE_MAX_PORTS];
+    int pending = 0;
+    int fin_closes = 0;
 
     for (int i = 0; i < num_ports; i++) {
-        int tcp_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-        if (tcp_sock < 0) {
-            ESP_LOGE(TAG, "Failed to create TCP socket");
+        socks[i] = -1;
+        if (first_wins && (*open_mask | *refused_mask)) {
             continue;
         }
-
-        struct sockaddr_in addr;
-        memset(&addr, 0, sizeof(addr));
-        addr.sin_family = AF_INET;
-        addr.sin_port = htons(ports[i]);
-
-        if (inet_aton(ip_address, &addr.sin_addr) == 0) {
-            ESP_LOGE(TAG, "Invalid IP address: %s", ip_address);
-            close(tcp_sock);
+        // Out of budget: probe the ports we have sockets for (sock_budget counts and logs it)
+        int tcp_sock = sock_budget_tcp_open();
+        if (tcp_sock < 0) {
             continue;
         }
 
-        // Make socket non-blocking so connect won't stall
+        // Non-blocking so every connect is in flight at the same time
         int flags = fcntl(tcp_sock, F_GETFL, 0);
         if (flags >= 0) fcntl(tcp_sock, F_SETFL, flags | O_NONBLOCK);
 
+        addr.sin_port = htons(ports[i]);
         ESP_LOGD(TAG, "Trying to connect to %s:%d", ip_address, ports[i]);
         int result = connect(tcp_sock, (struct sockaddr*)&addr, sizeof(addr));
         int saved_errno = errno;
 
         if (result == 0) {
-            ESP_LOGI(TAG, "✅ Host %s is reachable on port %d", ip_address, ports[i]);
-            close(tcp_sock);
-            return true;
+            *open_mask |= 1u << i;
+            close_probe(tcp_sock, &fin_closes);
+        } else if (saved_errno == EINPROGRESS || saved_errno == EALREADY || saved_errno == EWOULDBLOCK) {
+            socks[i] = tcp_sock;
+            pending++;
+        } else if (saved_errno == ECONNREFUSED) {
+            *refused_mask |= 1u << i;
+            close_probe(tcp_sock, &fin_closes);
+        } else {
+            ESP_LOGD(TAG, "❌ Immediate connect error to %s:%d (errno: %d)", ip_address, ports[i], saved_errno);
+            close_probe(tcp_sock, &fin_closes);
         }
+    }
 
-        if (saved_errno != EINPROGRESS && saved_errno != EALREADY && saved_errno != EWOULDBLOCK) {
-            // Immediate error
-            if (saved_errno == ECONNREFUSED) {
-                ESP_LOGI(TAG, "✅ Host %s is up (connection refused on port %d)", ip_address, ports[i]);
-                close(tcp_sock);
-                return true;
-            }
-            ESP_LOGD(TAG, "❌ Immediate connect error to %s:%d (errno: %d)", ip_address, ports[i], saved_errno);
-            close(tcp_sock);
-            continue;
+    int64_t deadline_us = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+    while (pending > 0 && !(first_wins && (*open_mask | *refused_mask))) {
+        int64_t remaining_us = deadline_us - esp_timer_get_time();
+        if (remaining_us <= 0) {
+            ESP_LOGD(TAG, "⏳ Connect timeout to %s", ip_address);
+            break;
         }
 
-        // Wait until socket is writable or timeout
         fd_set writefds;
         FD_ZERO(&writefds);
-        FD_SET(tcp_sock, &writefds);
+        int max_fd = -1;
+        for (int i = 0; i < num_ports; i++) {
+            if (socks[i] >= 0) {
+                FD_SET(socks[i], &writefds);
+                if (socks[i] > max_fd) max_fd = socks[i];
+            }
+        }
         struct timeval tv;
-        tv.tv_sec = per_port_timeout_ms / 1000;
-        tv.tv_usec = (per_port_timeout_ms % 1000) * 1000;
-        int sel = select(tcp_sock + 1, NULL, &writefds, NULL, &tv);
-        if (sel > 0 && FD_ISSET(tcp_sock, &writefds)) {
+        tv.tv_sec = remaining_us / 1000000;
+        tv.tv_usec = remaining_us % 1000000;
+        int sel = select(max_fd + 1, NULL, &writefds, NULL, &tv);
+        if (sel < 0) {
+            ESP_LOGD(TAG, "❌ select() error while connecting to %s", ip_address);
+            break;
+        }
+
+        for (int i = 0; i < num_ports && sel > 0; i++) {
+            if (socks[i] < 0 || !FD_ISSET(socks[i], &writefds)) {
+                continue;
+            }
             int so_error = 0;
             socklen_t len = sizeof(so_error);
-            if (getsockopt(tcp_sock, SOL_SOCKET, SO_ERROR, &so_error, &len) == 0) {
-                if (so_error == 0) {
-                    ESP_LOGI(TAG, "✅ Host %s is reachable on port %d", ip_address, ports[i]);
-                    close(tcp_sock);
-                    return true;
-                }
-                if (so_error == ECONNREFUSED) {
-                    ESP_LOGI(TAG, "✅ Host %s is up (connection refused on port %d)", ip_address, ports[i]);
-                    close(tcp_sock);
-                    return true;
-                }
+            getsockopt(socks[i], SOL_SOCKET, SO_ERROR, &so_error, &len);
+            if (so_error == 0) {
+                *open_mask |= 1u << i;
+            } else if (so_error == ECONNREFUSED) {
+                *refused_mask |= 1u << i;
+            } else {
                 ESP_LOGD(TAG, "❌ Connect SO_ERROR=%d to %s:%d", so_error, ip_address, ports[i]);
             }
-        } else if (sel == 0) {
-            ESP_LOGD(TAG, "⏳ Connect timeout to %s:%d (treating as down)", ip_address, ports[i]);
-        } else {
-            ESP_LOGD(TAG, "❌ select() error while connecting to %s:%d", ip_address, ports[i]);
+            close_probe(socks[i], &fin_closes);
+            socks[i] = -1;
+            pending--;
+        }
+    }
+
+    // Abort whatever is still in flight with RST (SO_LINGER 0, no TIME_WAIT)
+    for (int i = 0; i < num_ports; i++) {
+        if (socks[i] >= 0) {
+            close_probe(socks[i], &fin_closes);
         }
+    }
+    if (fin_closes) {
+        ESP_LOGW(TAG, "%d probe socket(s) to %s closed without RST; is CONFIG_LWIP_SO_LINGER enabled?",
+                 fin_closes, ip_address);
+    }
+}
 
-        close(tcp_sock);
+bool wol_check_host_reachable(const char* ip_address, uint32_t timeout_ms)
+{
+    if (!ip_address) {
+        ESP_LOGE(TAG, "IP address is required");
+        return false;
     }
 
+    uint32_t open_mask, refused_mask;
+    probe_ports(ip_address, windows_ports, NUM_WINDOWS_PORTS, timeout_ms, true, &open_mask, &refused_mask);
+
+    for (int i = 0; i < (int)NUM_WINDOWS_PORTS; i++) {
+        if ((open_mask | refused_mask) & (1u << i)) {
+            ESP_LOGI(TAG, "✅ Host %s is %s on port %d", ip_address,
+                     (open_mask & (1u << i)) ? "reachable" : "up (connection refused)", windows_ports[i]);
+            return true;
+        }
+    }
     ESP_LOGI(TAG, "Host %s is not reachable on any common ports", ip_address);
     return false;
 }
+
+// One connect of wol_probe_hosts() in flight
+typedef struct {
+    int sock;
+    size_t host;
+    int64_t deadline_us;
+} host_probe_t;
+
+static void drop_host_probe(host_probe_t* probes, int* in_flight, int index, int* fin_closes)
+{
+    close_probe(probes[index].sock, fin_closes);
+    probes[index] = probes[--(*in_flight)];
+}
+
+size_t wol_probe_hosts(const uint32_t* addrs, size_t count, uint32_t timeout_ms, bool* up)
+{
+    if (!addrs || !up) {
+        return 0;
+    }
+
+    // Every (host, port) pair is one connect; walk them host by host
+    host_probe_t probes[SOCK_BUDGET_TCP_SLOTS];
+    int in_flight = 0;
+    size_t next = 0;
+    size_t total = count * NUM_WINDOWS_PORTS;
+    size_t found = 0;
+    int fin_closes = 0;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+
+    while (1) {
+        // Keep as many connects in flight as the socket budget allows
+        while (next < total && in_flight < SOCK_BUDGET_TCP_SLOTS) {
+            size_t host = next / NUM_WINDOWS_PORTS;
+            uint16_t port = windows_ports[next % NUM_WINDOWS_PORTS];
+            if (up[host]) {
+                next++;
+                continue;
+            }
+            int tcp_sock = sock_budget_tcp_open();
+            if (tcp_sock < 0) {
+                break;
+            }
+            next++;
+
+            int flags = fcntl(tcp_sock, F_GETFL, 0);
+            if (flags >= 0) fcntl(tcp_sock, F_SETFL, flags | O_NONBLOCK);
+
+            addr.sin_addr.s_addr = addrs[host];
+            addr.sin_port = htons(port);
+            int result = connect(tcp_sock, (struct sockaddr*)&addr, sizeof(addr));
+            int saved_errno = errno;
+            if (result == 0 || (result < 0 && saved_errno == ECONNREFUSED)) {
+                up[host] = true;
+                found++;
+                close_probe(tcp_sock, &fin_closes);
+            } else if (saved_errno == EINPROGRESS || saved_errno == EALREADY || saved_errno == EWOULDBLOCK) {
+                probes[in_flight++] = (host_probe_t) {
+                    .sock = tcp_sock,
+                    .host = host,
+                    .deadline_us = esp_timer_get_time() + (int64_t)timeout_ms * 1000,
+                };
+            } else {
+                ESP_LOGD(TAG, "❌ Immediate connect error to host %u port %d (errno: %d)", (unsigned)host, port,
+                         saved_errno);
+                close_probe(tcp_sock, &fin_closes);
+            }
+        }
+        if (in_flight == 0) {
+            // Done, or the budget is taken by someone else; the caller probes again later
+            if (next < total) {
+                ESP_LOGD(TAG, "No TCP socket for host probes, %u connects left", (unsigned)(total - next));
+            }
+            break;
+        }
+
+        fd_set writefds;
+        FD_ZERO(&writefds);
+        int max_fd = -1;
+        int64_t wake_us = probes[0].deadline_us;
+        for (int i = 0; i < in_flight; i++) {
+            FD_SET(probes[i].sock, &writefds);
+            if (probes[i].sock > max_fd) max_fd = probes[i].sock;
+            if (probes[i].deadline_us < wake_us) wake_us = probes[i].deadline_us;
+        }
+        int64_t remaining_us = wake_us - esp_timer_get_time();
+        if (remaining_us < 0) {
+            remaining_us = 0;
+        }
+        struct timeval tv;
+        tv.tv_sec = remaining_us / 1000000;
+        tv.tv_usec = remaining_us % 1000000;
+        int sel = select(max_fd + 1, NULL, &writefds, NULL, &tv);
+        if (sel < 0) {
+            ESP_LOGD(TAG, "❌ select() error while probing hosts");
+            break;
+        }
+
+        int64_t now_us = esp_timer_get_time();
+        for (int i = 0; i < in_flight; ) {
+            if (up[probes[i].host]) {
+                // Another port of this host answered already
+                drop_host_probe(probes, &in_flight, i, &fin_closes);
+            } else if (FD_ISSET(probes[i].sock, &writefds)) {
+                int so_error = 0;
+                socklen_t len = sizeof(so_error);
+                getsockopt(probes[i].sock, SOL_SOCKET, SO_ERROR, &so_error, &len);
+                if (so_error == 0 || so_error == ECONNREFUSED) {
+                    up[probes[i].host] = true;
+                    found++;
+                }
+                drop_host_probe(probes, &in_flight, i, &fin_closes);
+            } else if (now_us >= probes[i].deadline_us) {
+                drop_host_probe(probes, &in_flight, i, &fin_closes);
+            } else {
+                i++;
+            }
+        }
+    }
+
+    // Abort whatever is still in flight with RST (SO_LINGER 0, no TIME_WAIT)
+    while (in_flight > 0) {
+        drop_host_probe(probes, &in_flight, 0, &fin_closes);
+    }
+    if (fin_closes) {
+        ESP_LOGW(TAG, "%d host probe socket(s) closed without RST; is CONFIG_LWIP_SO_LINGER enabled?", fin_closes);
+    }
+    return found;
+}
+
+uint32_t wol_probe_ports(const char* ip_address, const uint16_t* ports, size_t num_ports, uint32_t timeout_ms)
+{
+    if (!ip_address || !ports || num_ports == 0 || num_ports > WOL_PROBE_MAX_PORTS) {
+        return 0;
+    }
+    uint32_t open_mask, refused_mask;
+    probe_ports(ip_address, ports, (int)num_ports, timeout_ms, false, &open_mask, &refused_mask);
+    return open_mask;
+}
@@ -3,6 +3,8 @@
 
 #include "esp_err.h"
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -21,14 +23,280 @@ esp_err_t wol_send_magic_packet(const char* mac_address, const char* ip_address,
 // both directed to PC IP and subnet broadcast). Succeeds if any send succeeds.
 esp_err_t wol_send_magic_packet_all(const char* mac_address, const char* ip_address);
 
+#define WOL_MAGIC_PACKET_SIZE 102
+#define WOL_SECUREON_MAX_LEN 6
+#define WOL_PROBE_MAX_PORTS 8
+
+// Wake-on-LAN sender for one PC: MAC parsed and magic packet built once. Bursts go out over
+// the shared UDP sockets of components/sock_budget.
+typedef struct {
+    uint8_t mac[6];
+    uint8_t packet[WOL_MAGIC_PACKET_SIZE + WOL_SECUREON_MAX_LEN];
+    uint8_t packet_len;         // 102, or 106/108 with a SecureOn password
+    uint32_t directed_addr;     // PC IPv4 in network byte order, 0 if none
+    uint8_t directed_addr6[16]; // PC IPv6, all zero if none
+    bool ipv6_all_nodes;        // Also send to ff02::1 on the STA interface
+} wol_context_t;
+
+/**
+ * @brief Parse the target and build its magic packet
+ * @param ctx Context to fill
+ * @param mac_address Target MAC address (format: "AA:BB:CC:DD:EE:FF")
+ * @param ip_address Target IP address for directed WoL (optional)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG
+ */
+esp_err_t wol_context_init(wol_context_t* ctx, const char* mac_address, const char* ip_address);
+
 /**
- * @brief Check if a host is reachable (ping)
+ * @brief Append a SecureOn password to the magic packet
+ *
+ * NICs with SecureOn enabled ignore magic packets without the password set in the BIOS/NIC.
+ *
+ * @param ctx Initialized context
+ * @param password 6 bytes as "AA:BB:CC:DD:EE:FF", 4 bytes as "AA:BB:CC:DD" or "a.b.c.d";
+ *                 NULL or "" removes the password
+ * @return ESP_OK, ESP_ERR_INVALID_ARG
+ */
+esp_err_t wol_context_set_secureon(wol_context_t* ctx, const char* password);
+
+/**
+ * @brief Add IPv6 destinations to the burst
+ *
+ * For VLANs that filter IPv4 broadcast but pass IPv6 multicast. Needs an IPv6 link-local
+ * address on the STA interface (wifi_manager creates one on connect).
+ *
+ * @param ctx Initialized context
+ * @param ipv6_address PC IPv6 for directed WoL (optional; link-local addresses use the STA
+ *                     interface)
+ * @param all_nodes Also send to the all-nodes multicast group ff02::1
+ * @return ESP_OK, ESP_ERR_INVALID_ARG
+ */
+esp_err_t wol_context_set_ipv6(wol_context_t* ctx, const char* ipv6_address, bool all_nodes);
+
+/**
+ * @brief Send the magic packet to every destination in one burst
+ *
+ * Destinations are the PC IP, the subnet broadcast of the STA interface and the limited
+ * broadcast, then the PC IPv6 and ff02::1 if configured, each on ports 9 and 7. The shared
+ * sockets are reopened after a burst in which every send failed.
+ *
+ * @param ctx Initialized context
+ * @return ESP_OK if any send succeeded
+ */
+esp_err_t wol_context_send_burst(wol_context_t* ctx);
+
+/**
+ * @brief Check if a host is reachable (TCP connect to 3389, 135 and 445 in parallel)
+ *
+ * The first port that accepts or refuses decides; the other attempts are aborted with RST.
+ *
  * @param ip_address Target IP address
- * @param timeout_ms Timeout in milliseconds
+ * @param timeout_ms Timeout in milliseconds for all ports together
  * @return true if reachable, false otherwise
  */
 bool wol_check_host_reachable(const char* ip_address, uint32_t timeout_ms);
 
+/**
+ * @brief Find out which of the given TCP ports accept a connection
+ *
+ * All ports are probed concurrently; connections are reset right away.
+ *
+ * @param ip_address Target IP address
+ * @param ports Ports to try (at most WOL_PROBE_MAX_PORTS)
+ * @param num_ports Number of ports
+ * @param timeout_ms Timeout for all ports together
+ * @return Bit i set if ports[i] is open (a refused port doesn't count)
+ */
+uint32_t wol_probe_ports(const char* ip_address, const uint16_t* ports, size_t num_ports, uint32_t timeout_ms);
+
+/**
+ * @brief Probe several hosts at once on the ports of wol_check_host_reachable()
+ *
+ * Non-blocking connects under one select(), as many in flight as sock_budget allows; a host
+ * counts as up on its first open or refused port and its other connects are aborted.
+ *
+ * @param addrs IPv4 addresses in network byte order
+ * @param count Number of hosts
+ * @param timeout_ms Timeout per connect
+ * @param up Set for every host that answered; hosts already set are skipped
+ * @return Number of hosts newly found up
+ */
+size_t wol_probe_hosts(const uint32_t* addrs, size_t count, uint32_t timeout_ms, bool* up);
+
+/**
+ * @brief Moving average for learned wake and boot timings
+ *
+ * The new sample weighs 1/4. The first sample, or any sample while the average is still 0,
+ * is taken as is.
+ *
+ * @param average Current average
+ * @param sample New sample
+ * @param samples Number of samples behind the current average
+ * @return Updated average
+ */
+uint32_t wol_moving_average(uint32_t average, uint32_t sample, uint32_t samples);
+
+// Rate limit shared by many targets: packets spaced at least interval_us apart
+typedef struct {
+    uint32_t interval_us;       // Minimum gap between packets, 0 for no limit
+    int64_t next_us;            // Earliest time for the next packet
+} wol_pacer_t;
+
+/**
+ * @brief Set up a pacer
+ * @param pacer Pacer to fill
+ * @param packets_per_second Rate limit for all bursts sent through it (0 = none)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG
+ */
+esp_err_t wol_pacer_init(wol_pacer_t* pacer, uint32_t packets_per_second);
+
+/**
+ * @brief Send a target's burst (same destinations as wol_context_send_burst()) at the pacer's rate
+ *
+ * Blocks until every packet of the burst is sent.
+ *
+ * @param pacer Initialized pacer
+ * @param ctx Initialized context of the target
+ * @return ESP_OK if any send succeeded
+ */
+esp_err_t wol_pacer_send_burst(wol_pacer_t* pacer, const wol_context_t* ctx);
+
+#define WOL_GROUP_MAX_HOSTS 64
+
+typedef enum {
+    WOL_GROUP_NO_SIGN,          // Nothing heard from the host
+    WOL_GROUP_WOKE,             // Host sent a frame (local) or answered a probe (routed)
+    WOL_GROUP_ANSWERS_ARP,      // Only an ARP reply; awake or an offloading NIC
+} wol_group_status_t;
+
+typedef struct {
+    wol_group_status_t status;
+    uint16_t bursts;            // Bursts sent to this host
+    uint32_t confirm_ms;        // Start of the wake to confirmation
+} wol_group_result_t;
+
+typedef struct {
+    uint32_t packets_per_second;    // Limit over all hosts (0 = none)
+    uint32_t resend_interval_ms;    // Start of one round of bursts to the next
+    uint32_t window_ms;             // Give up on hosts still silent after this long
+    uint32_t probe_timeout_ms;      // Connect timeout of the routed host probes
+    bool (*cancelled)(void);        // Polled between packets and probes (optional)
+} wol_group_config_t;
+
+/**
+ * @brief Wake several PCs at once and confirm each one
+ *
+ * Every round sends one burst to each host not confirmed yet, paced to the configured
+ * rate. Hosts on our subnet are confirmed by the first frame they send (like the wake
+ * watch), routed hosts by parallel TCP probes between rounds. Hosts still silent at the end of the
+ * window are ARPed once.
+ *
+ * @param hosts Initialized contexts (at most WOL_GROUP_MAX_HOSTS)
+ * @param count Number of hosts
+ * @param config Pacing and timing
+ * @param results One result per host
+ * @return ESP_OK if every host was confirmed, ESP_ERR_TIMEOUT if some weren't,
+ *         ESP_ERR_NOT_FINISHED if cancelled
+ */
+esp_err_t wol_group_wake(const wol_context_t* hosts, size_t count, const wol_group_config_t* config,
+                         wol_group_result_t* results);
+
+/**
+ * @brief Watch for frames from several PCs at once (used by wol_group_wake())
+ *
+ * Only one group watch can run at a time; it is independent of wol_wake_watch_start().
+ *
+ * @param hosts Contexts holding the MACs (at most WOL_GROUP_MAX_HOSTS)
+ * @param count Number of hosts
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_STATE without a STA interface
+ */
+esp_err_t wol_group_watch_start(const wol_context_t* hosts, size_t count);
+
+/**
+ * @brief True once hosts[index] of the running group watch has sent a frame
+ */
+bool wol_group_watch_seen(size_t index);
+
+/**
+ * @brief Stop the group watch
+ */
+void wol_group_watch_stop(void);
+
+#define WOL_PRESENCE_MAX_TRACKED 4
+
+/**
+ * @brief Set up ARP probing and frame watching; call once at startup, before any task uses them
+ * @return ESP_OK, ESP_ERR_NO_MEM
+ */
+esp_err_t wol_presence_init(void);
+
+typedef enum {
+    WOL_PRESENCE_UNKNOWN,       // ARP can't tell (other subnet, no WiFi, IP answered from another MAC)
+    WOL_PRESENCE_UP,            // PC's MAC answered ARP for its IP
+    WOL_PRESENCE_DOWN,          // No ARP reply on our segment
+} wol_presence_t;
+
+/**
+ * @brief True if the PC's IP is on the STA interface's subnet (ARP and broadcasts reach it)
+ * @param ctx Context holding the PC's IP
+ */
+bool wol_context_is_local(const wol_context_t* ctx);
+
+/**
+ * @brief Check if the PC is on by ARPing its IP and comparing the answering MAC
+ *
+ * Only works for a PC on the same subnet; returns WOL_PRESENCE_UNKNOWN otherwise, in which
+ * case wol_check_host_reachable() should decide. A NIC with ARP offload may answer while
+ * the PC sleeps.
+ *
+ * @param ctx Context holding the PC's MAC and IP
+ * @param timeout_ms Time to wait for a reply (one retry halfway through)
+ * @return Presence verdict
+ */
+wol_presence_t wol_check_host_arp(const wol_context_t* ctx, uint32_t timeout_ms);
+
+/**
+ * @brief Start watching for the PC's NIC coming up
+ *
+ * The first frame received from the PC's MAC (gratuitous ARP, DHCP request, IPv6 DAD, ...)
+ * signals the watch. ARP replies and neighbor advertisements are ignored since NICs with
+ * offload send those while asleep. Only broadcasts reach us over WiFi, which is what a
+ * booting PC sends first.
+ *
+ * @param ctx Context holding the PC's MAC
+ * @return ESP_OK, ESP_ERR_INVALID_STATE without a STA interface
+ */
+esp_err_t wol_wake_watch_start(const wol_context_t* ctx);
+
+/**
+ * @brief Wait for the watch started with wol_wake_watch_start()
+ * @param timeout_ms Maximum time to wait
+ * @return true once a frame from the PC has been seen (stays true until the next start)
+ */
+bool wol_wake_watch_wait(uint32_t timeout_ms);
+
+/**
+ * @brief Stop watching
+ */
+void wol_wake_watch_stop(void);
+
+/**
+ * @brief Time-stamp every frame received from this PC (see wol_presence_last_seen_us())
+ *
+ * ARP replies and neighbor advertisements don't count, like for the wake watch.
+ *
+ * @param ctx Context holding the PC's MAC
+ * @return ESP_OK, ESP_ERR_NO_MEM if WOL_PRESENCE_MAX_TRACKED PCs are tracked already
+ */
+esp_err_t wol_presence_track(const wol_context_t* ctx);
+
+/**
+ * @brief When a tracked PC last sent something we could see
+ * @param ctx Context holding the PC's MAC
+ * @return esp_timer_get_time() of the last frame, 0 if none yet or not tracked
+ */
+int64_t wol_presence_last_seen_us(const wol_context_t* ctx);
+
 #ifdef __cplusplus
 }
 #endif
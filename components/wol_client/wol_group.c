@@ -0,0 +1,152 @@
+#include "wol_client.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "string.h"
+
+static const char *TAG = "wol_group";
+
+// Between rounds the group watch is polled this often
+#define GROUP_POLL_MS 100
+#define GROUP_ARP_TIMEOUT_MS 200
+// Routed hosts probed together; cancellation is checked between batches
+#define GROUP_PROBE_BATCH 8
+
+static bool group_cancelled(const wol_group_config_t* config)
+{
+    return config->cancelled && config->cancelled();
+}
+
+static void confirm(wol_group_result_t* result, wol_group_status_t status, int64_t start_us, size_t* pending)
+{
+    result->status = status;
+    result->confirm_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+    (*pending)--;
+}
+
+// Routed hosts: probe the silent ones in parallel batches
+static void probe_routed(const wol_context_t* hosts, size_t count, const bool* local,
+                         const wol_group_config_t* config, wol_group_result_t* results,
+                         int64_t start_us, size_t* pending)
+{
+    uint32_t addrs[GROUP_PROBE_BATCH];
+    size_t index[GROUP_PROBE_BATCH];
+    size_t i = 0;
+
+    while (i < count && *pending && !group_cancelled(config)) {
+        size_t batch = 0;
+        for (; i < count && batch < GROUP_PROBE_BATCH; i++) {
+            if (!local[i] && results[i].status == WOL_GROUP_NO_SIGN && hosts[i].directed_addr) {
+                addrs[batch] = hosts[i].directed_addr;
+                index[batch++] = i;
+            }
+        }
+        if (batch == 0) {
+            break;
+        }
+
+        bool up[GROUP_PROBE_BATCH] = {0};
+        if (wol_probe_hosts(addrs, batch, config->probe_timeout_ms, up) == 0) {
+            continue;
+        }
+        for (size_t b = 0; b < batch; b++) {
+            if (up[b]) {
+                confirm(&results[index[b]], WOL_GROUP_WOKE, start_us, pending);
+                ESP_LOGI(TAG, "Host %u answers after %lu ms", (unsigned)index[b],
+                         (unsigned long)results[index[b]].confirm_ms);
+            }
+        }
+    }
+}
+
+// Hosts on our subnet confirm themselves through the group watch
+static void collect_watch(const wol_context_t* hosts, size_t count, const bool* local,
+                          wol_group_result_t* results, int64_t start_us, size_t* pending)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (local[i] && results[i].status == WOL_GROUP_NO_SIGN && wol_group_watch_seen(i)) {
+            confirm(&results[i], WOL_GROUP_WOKE, start_us, pending);
+            ESP_LOGI(TAG, "Host %u woke after %lu ms", (unsigned)i, (unsigned long)results[i].confirm_ms);
+        }
+    }
+}
+
+esp_err_t wol_group_wake(const wol_context_t* hosts, size_t count, const wol_group_config_t* config,
+                         wol_group_result_t* results)
+{
+    if (!hosts || !config || !results || count == 0 || count > WOL_GROUP_MAX_HOSTS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    bool local[WOL_GROUP_MAX_HOSTS];
+    size_t num_local = 0;
+    for (size_t i = 0; i < count; i++) {
+        local[i] = wol_context_is_local(&hosts[i]);
+        num_local += local[i];
+    }
+    memset(results, 0, count * sizeof(*results));
+
+    // Without the watch local hosts are probed like routed ones
+    if (num_local && wol_group_watch_start(hosts, count) != ESP_OK) {
+        ESP_LOGW(TAG, "Group watch unavailable, probing every host");
+        memset(local, 0, sizeof(local));
+        num_local = 0;
+    }
+
+    wol_pacer_t pacer;
+    wol_pacer_init(&pacer, config->packets_per_second);
+    ESP_LOGI(TAG, "Waking %u hosts (%u local), %lu packets/s", (unsigned)count, (unsigned)num_local,
+             (unsigned long)config->packets_per_second);
+
+    int64_t start_us = esp_timer_get_time();
+    int64_t window_end_us = start_us + (int64_t)config->window_ms * 1000;
+    size_t pending = count;
+    int round = 0;
+
+    while (pending && esp_timer_get_time() < window_end_us && !group_cancelled(config)) {
+        int64_t round_start_us = esp_timer_get_time();
+        size_t sent = 0;
+        round++;
+        for (size_t i = 0; i < count && !group_cancelled(config); i++) {
+            collect_watch(hosts, count, local, results, start_us, &pending);
+            if (results[i].status != WOL_GROUP_NO_SIGN) {
+                continue;
+            }
+            if (wol_pacer_send_burst(&pacer, &hosts[i]) == ESP_OK) {
+                sent++;
+            }
+            results[i].bursts++;
+        }
+        ESP_LOGI(TAG, "Round %d: bursts to %u hosts in %lu ms, %u still silent", round, (unsigned)sent,
+                 (unsigned long)((esp_timer_get_time() - round_start_us) / 1000), (unsigned)pending);
+
+        int64_t next_round_us = round_start_us + (int64_t)config->resend_interval_ms * 1000;
+        if (next_round_us > window_end_us) {
+            next_round_us = window_end_us;
+        }
+        while (pending && esp_timer_get_time() < next_round_us && !group_cancelled(config)) {
+            probe_routed(hosts, count, local, config, results, start_us, &pending);
+            collect_watch(hosts, count, local, results, start_us, &pending);
+            vTaskDelay(pdMS_TO_TICKS(GROUP_POLL_MS));
+        }
+    }
+    wol_group_watch_stop();
+    collect_watch(hosts, count, local, results, start_us, &pending);
+
+    if (group_cancelled(config)) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+
+    // A host that was on all along sends nothing we can see over WiFi; ask it directly
+    for (size_t i = 0; i < count && pending; i++) {
+        if (local[i] && results[i].status == WOL_GROUP_NO_SIGN &&
+            wol_check_host_arp(&hosts[i], GROUP_ARP_TIMEOUT_MS) == WOL_PRESENCE_UP) {
+            confirm(&results[i], WOL_GROUP_ANSWERS_ARP, start_us, &pending);
+        }
+    }
+
+    ESP_LOGI(TAG, "Group wake done: %u/%u hosts confirmed in %d rounds", (unsigned)(count - pending),
+             (unsigned)count, round);
+    return pending ? ESP_ERR_TIMEOUT : ESP_OK;
+}
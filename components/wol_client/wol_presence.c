@@ -0,0 +1,320 @@
+#include "wol_client.h"
+#include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_netif_net_stack.h"
+#include "lwip/etharp.h"
+#include "lwip/netif.h"
+#include "lwip/pbuf.h"
+#include "lwip/tcpip.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "string.h"
+
+static const char *TAG = "wol_presence";
+
+// Offsets in an Ethernet II frame
+#define ETH_SRC_OFFSET       6
+#define ETH_TYPE_OFFSET      12
+#define ETH_HEADER_LEN       14
+#define ARP_OPCODE           (ETH_HEADER_LEN + 6)
+#define ARP_SENDER_MAC       (ETH_HEADER_LEN + 8)
+#define ARP_SENDER_IP        (ETH_HEADER_LEN + 14)
+#define ARP_FRAME_MIN_LEN    (ETH_HEADER_LEN + 28)
+#define IP6_NEXT_HEADER      (ETH_HEADER_LEN + 6)
+#define ICMP6_TYPE           (ETH_HEADER_LEN + 40)
+#define ETHTYPE_ARP          0x0806
+#define ETHTYPE_IPV6         0x86DD
+#define ARP_OP_REPLY         2
+#define IP6_NH_ICMP6         58
+#define ICMP6_NEIGHBOR_ADVERT 136
+
+#define ARP_SEEN_BIT  BIT0
+#define WAKE_SEEN_BIT BIT1
+
+static EventGroupHandle_t s_events = NULL;
+static SemaphoreHandle_t s_arp_lock = NULL;       // One ARP probe at a time
+static netif_input_fn s_orig_input = NULL;
+
+// Written by the prober/watcher, read by the tap in the WiFi RX task
+static volatile uint32_t s_watch_ip = 0;
+static uint8_t s_seen_mac[6];
+static volatile bool s_watch_mac_armed = false;
+static uint8_t s_watch_mac[6];
+
+// MACs whose traffic is time-stamped for wol_presence_last_seen_us()
+typedef struct {
+    uint8_t mac[6];
+    volatile int64_t last_seen_us;
+} tracked_mac_t;
+static tracked_mac_t s_tracked[WOL_PRESENCE_MAX_TRACKED];
+static volatile int s_tracked_count = 0;
+
+// Group watch: MACs copied in before arming, seen bits only written by the tap
+static uint8_t s_group_macs[WOL_GROUP_MAX_HOSTS][6];
+static volatile uint32_t s_group_seen[(WOL_GROUP_MAX_HOSTS + 31) / 32];
+static volatile size_t s_group_count = 0;
+static volatile bool s_group_armed = false;
+
+static uint16_t read_u16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+// Frames a sleeping NIC may still send on its own (ARP/ND offload) don't mean it woke up
+static bool is_offload_answer(const uint8_t *frame, uint16_t len, uint16_t type)
+{
+    if (type == ETHTYPE_ARP) {
+        return len >= ARP_FRAME_MIN_LEN && read_u16(frame + ARP_OPCODE) == ARP_OP_REPLY;
+    }
+    if (type == ETHTYPE_IPV6) {
+        return len > ICMP6_TYPE && frame[IP6_NEXT_HEADER] == IP6_NH_ICMP6 &&
+               frame[ICMP6_TYPE] == ICMP6_NEIGHBOR_ADVERT;
+    }
+    return false;
+}
+
+// Runs for every received frame before lwIP queues it: note who answered, then pass it on
+static err_t tap_input(struct pbuf *p, struct netif *inp)
+{
+    const uint8_t *frame = (const uint8_t *)p->payload;
+    if (p->len >= ETH_HEADER_LEN) {
+        uint16_t type = read_u16(frame + ETH_TYPE_OFFSET);
+        uint32_t watch_ip = s_watch_ip;
+        if (watch_ip && type == ETHTYPE_ARP && p->len >= ARP_FRAME_MIN_LEN &&
+            memcmp(frame + ARP_SENDER_IP, &watch_ip, 4) == 0) {
+            memcpy(s_seen_mac, frame + ARP_SENDER_MAC, 6);
+            xEventGroupSetBits(s_events, ARP_SEEN_BIT);
+        }
+        // Gratuitous ARP, DHCP, IPv6 DAD... whatever the PC sends first once its NIC is up
+        if (s_watch_mac_armed && memcmp(frame + ETH_SRC_OFFSET, s_watch_mac, 6) == 0 &&
+            !is_offload_answer(frame, p->len, type)) {
+            s_watch_mac_armed = false;
+            xEventGroupSetBits(s_events, WAKE_SEEN_BIT);
+        }
+        if (s_group_armed && !is_offload_answer(frame, p->len, type)) {
+            size_t count = s_group_count;
+            for (size_t i = 0; i < count; i++) {
+                if (memcmp(frame + ETH_SRC_OFFSET, s_group_macs[i], 6) == 0) {
+                    s_group_seen[i / 32] |= 1u << (i % 32);
+                }
+            }
+        }
+        for (int i = 0; i < s_tracked_count; i++) {
+            if (memcmp(frame + ETH_SRC_OFFSET, s_tracked[i].mac, 6) == 0 &&
+                !is_offload_answer(frame, p->len, type)) {
+                s_tracked[i].last_seen_us = esp_timer_get_time();
+            }
+        }
+    }
+    return s_orig_input(p, inp);
+}
+
+typedef struct {
+    struct tcpip_api_call_data call;    // Must be first
+    struct netif *netif;
+    ip4_addr_t ip;
+} arp_request_msg_t;
+
+// tcpip thread: hook the input path once, then ask who has the IP (if any)
+static err_t arp_request_in_tcpip(struct tcpip_api_call_data *call)
+{
+    arp_request_msg_t *msg = (arp_request_msg_t *)call;
+    if (msg->netif->input != tap_input) {
+        s_orig_input = msg->netif->input;
+        msg->netif->input = tap_input;
+    }
+    return msg->ip.addr ? etharp_request(msg->netif, &msg->ip) : ERR_OK;
+}
+
+esp_err_t wol_presence_init(void)
+{
+    if (!s_events) {
+        s_events = xEventGroupCreate();
+    }
+    if (!s_arp_lock) {
+        s_arp_lock = xSemaphoreCreateMutex();
+    }
+    return (s_events && s_arp_lock) ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+bool wol_context_is_local(const wol_context_t* ctx)
+{
+    esp_netif_t *esp_netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    esp_netif_ip_info_t ip_info;
+    return ctx && ctx->directed_addr && esp_netif && esp_netif_get_ip_info(esp_netif, &ip_info) == ESP_OK &&
+           ip_info.ip.addr != 0 &&
+           (ip_info.ip.addr & ip_info.netmask.addr) == (ctx->directed_addr & ip_info.netmask.addr);
+}
+
+wol_presence_t wol_check_host_arp(const wol_context_t* ctx, uint32_t timeout_ms)
+{
+    if (!ctx || !ctx->directed_addr) {
+        return WOL_PRESENCE_UNKNOWN;
+    }
+    if (!s_events || !s_arp_lock) {
+        return WOL_PRESENCE_UNKNOWN;
+    }
+
+    // ARP only answers for hosts on our own segment
+    if (!wol_context_is_local(ctx)) {
+        return WOL_PRESENCE_UNKNOWN;
+    }
+    esp_netif_t *esp_netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+
+    arp_request_msg_t msg = {
+        .netif = (struct netif *)esp_netif_get_netif_impl(esp_netif),
+        .ip = { .addr = ctx->directed_addr },
+    };
+    if (!msg.netif) {
+        return WOL_PRESENCE_UNKNOWN;
+    }
+
+    xSemaphoreTake(s_arp_lock, portMAX_DELAY);
+    xEventGroupClearBits(s_events, ARP_SEEN_BIT);
+    s_watch_ip = ctx->directed_addr;
+
+    // Second request halfway through in case the first one was lost on the air
+    EventBits_t bits = 0;
+    for (int attempt = 0; attempt < 2 && !(bits & ARP_SEEN_BIT); attempt++) {
+        if (tcpip_api_call(arp_request_in_tcpip, &msg.call) != ERR_OK) {
+            ESP_LOGD(TAG, "etharp_request failed");
+        }
+        bits = xEventGroupWaitBits(s_events, ARP_SEEN_BIT, pdFALSE, pdFALSE, pdMS_TO_TICKS(timeout_ms / 2));
+    }
+    s_watch_ip = 0;
+    uint8_t seen_mac[6];
+    memcpy(seen_mac, s_seen_mac, sizeof(seen_mac));
+    xSemaphoreGive(s_arp_lock);
+
+    if (!(bits & ARP_SEEN_BIT)) {
+        ESP_LOGD(TAG, "No ARP reply within %lu ms", (unsigned long)timeout_ms);
+        return WOL_PRESENCE_DOWN;
+    }
+    if (memcmp(seen_mac, ctx->mac, sizeof(ctx->mac)) != 0) {
+        ESP_LOGW(TAG, "⚠️ IP answered from %02x:%02x:%02x:%02x:%02x:%02x, not the PC's MAC",
+                 seen_mac[0], seen_mac[1], seen_mac[2], seen_mac[3], seen_mac[4], seen_mac[5]);
+        return WOL_PRESENCE_UNKNOWN;
+    }
+    ESP_LOGD(TAG, "PC answered ARP");
+    return WOL_PRESENCE_UP;
+}
+
+esp_err_t wol_wake_watch_start(const wol_context_t* ctx)
+{
+    if (!ctx) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_events) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_netif_t *esp_netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    arp_request_msg_t msg = {
+        .netif = esp_netif ? (struct netif *)esp_netif_get_netif_impl(esp_netif) : NULL,
+    };
+    if (!msg.netif) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    memcpy(s_watch_mac, ctx->mac, sizeof(s_watch_mac));
+    xEventGroupClearBits(s_events, WAKE_SEEN_BIT);
+    s_watch_mac_armed = true;
+    if (tcpip_api_call(arp_request_in_tcpip, &msg.call) != ERR_OK) {
+        s_watch_mac_armed = false;
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+bool wol_wake_watch_wait(uint32_t timeout_ms)
+{
+    if (!s_events) {
+        return false;
+    }
+    EventBits_t bits = xEventGroupWaitBits(s_events, WAKE_SEEN_BIT, pdFALSE, pdFALSE, pdMS_TO_TICKS(timeout_ms));
+    return (bits & WAKE_SEEN_BIT) != 0;
+}
+
+void wol_wake_watch_stop(void)
+{
+    s_watch_mac_armed = false;
+}
+
+esp_err_t wol_group_watch_start(const wol_context_t* hosts, size_t count)
+{
+    if (!hosts || count == 0 || count > WOL_GROUP_MAX_HOSTS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_netif_t *esp_netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    arp_request_msg_t msg = {
+        .netif = esp_netif ? (struct netif *)esp_netif_get_netif_impl(esp_netif) : NULL,
+    };
+    if (!msg.netif) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_group_armed = false;
+    for (size_t i = 0; i < count; i++) {
+        memcpy(s_group_macs[i], hosts[i].mac, 6);
+    }
+    memset((void *)s_group_seen, 0, sizeof(s_group_seen));
+    s_group_count = count;
+    s_group_armed = true;
+    if (tcpip_api_call(arp_request_in_tcpip, &msg.call) != ERR_OK) {
+        s_group_armed = false;
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+bool wol_group_watch_seen(size_t index)
+{
+    return index < s_group_count && (s_group_seen[index / 32] & (1u << (index % 32))) != 0;
+}
+
+void wol_group_watch_stop(void)
+{
+    s_group_armed = false;
+}
+
+esp_err_t wol_presence_track(const wol_context_t* ctx)
+{
+    if (!ctx) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < s_tracked_count; i++) {
+        if (memcmp(s_tracked[i].mac, ctx->mac, 6) == 0) {
+            return ESP_OK;
+        }
+    }
+    if (s_tracked_count == WOL_PRESENCE_MAX_TRACKED) {
+        return ESP_ERR_NO_MEM;
+    }
+    // Entry first, count second: the tap only reads entries below the count
+    memcpy(s_tracked[s_tracked_count].mac, ctx->mac, 6);
+    s_tracked[s_tracked_count].last_seen_us = 0;
+    s_tracked_count++;
+
+    // Make sure the tap is installed even if no ARP probe has run yet
+    esp_netif_t *esp_netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    arp_request_msg_t msg = {
+        .netif = esp_netif ? (struct netif *)esp_netif_get_netif_impl(esp_netif) : NULL,
+    };
+    if (msg.netif) {
+        tcpip_api_call(arp_request_in_tcpip, &msg.call);
+    }
+    return ESP_OK;
+}
+
+int64_t wol_presence_last_seen_us(const wol_context_t* ctx)
+{
+    for (int i = 0; ctx && i < s_tracked_count; i++) {
+        if (memcmp(s_tracked[i].mac, ctx->mac, 6) == 0) {
+            return s_tracked[i].last_seen_us;
+        }
+    }
+    return 0;
+}
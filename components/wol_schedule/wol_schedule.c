@@ -0,0 +1,140 @@
+#include "wol_schedule.h"
+#include "wol_client.h"
+#include "esp_log.h"
+#include "nvs.h"
+#include "string.h"
+#include <stdio.h>
+
+static const char *TAG = "wol_schedule";
+
+#define STATS_VERSION 1
+
+static void stats_key(uint8_t pc, char* key, size_t len)
+{
+    snprintf(key, len, "pc%u", pc);
+}
+
+esp_err_t wol_schedule_get_stats(uint8_t pc, wol_schedule_stats_t* stats)
+{
+    memset(stats, 0, sizeof(*stats));
+
+    nvs_handle_t nvs;
+    if (nvs_open(WOL_SCHEDULE_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    char key[8];
+    stats_key(pc, key, sizeof(key));
+    size_t size = sizeof(*stats);
+    esp_err_t ret = nvs_get_blob(nvs, key, stats, &size);
+    nvs_close(nvs);
+
+    if (ret != ESP_OK || size != sizeof(*stats) || stats->version != STATS_VERSION) {
+        memset(stats, 0, sizeof(*stats));
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t save_stats(uint8_t pc, const wol_schedule_stats_t* stats)
+{
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(WOL_SCHEDULE_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    char key[8];
+    stats_key(pc, key, sizeof(key));
+    ret = nvs_set_blob(nvs, key, stats, sizeof(*stats));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    return ret;
+}
+
+// Gap after the first burst. A PC that nearly always wakes on the first burst gets time to
+// show it did (its usual wake time plus half) before the next one is sent.
+static uint32_t first_interval(const wol_schedule_t* schedule)
+{
+    const wol_schedule_config_t* config = schedule->config;
+    const wol_schedule_stats_t* stats = &schedule->stats;
+    uint32_t interval = config->first_interval_ms;
+
+    if (stats->wakes >= WOL_SCHEDULE_LEARN_MIN_WAKES && stats->one_burst * 4 >= stats->wakes * 3) {
+        uint32_t learned = stats->wake_ms * 3 / 2;
+        if (learned > interval) {
+            interval = learned;
+        }
+    }
+    return interval < config->max_interval_ms ? interval : config->max_interval_ms;
+}
+
+void wol_schedule_start(wol_schedule_t* schedule, const wol_schedule_config_t* config, uint8_t pc)
+{
+    memset(schedule, 0, sizeof(*schedule));
+    schedule->config = config;
+    schedule->pc = pc;
+    wol_schedule_get_stats(pc, &schedule->stats);
+
+    if (schedule->stats.wakes) {
+        ESP_LOGI(TAG, "PC %u: %u/%u wake-ups on the first burst, ~%lu ms to wake, first resend after %lu ms",
+                 pc, schedule->stats.one_burst, schedule->stats.wakes, (unsigned long)schedule->stats.wake_ms,
+                 (unsigned long)first_interval(schedule));
+    }
+}
+
+int64_t wol_schedule_sent(wol_schedule_t* schedule, int64_t now_us)
+{
+    const wol_schedule_config_t* config = schedule->config;
+
+    if (schedule->bursts == 0) {
+        schedule->start_us = now_us;
+        schedule->interval_ms = first_interval(schedule);
+    } else {
+        uint32_t next = schedule->interval_ms * (config->backoff ? config->backoff : 1);
+        schedule->interval_ms = next < config->max_interval_ms ? next : config->max_interval_ms;
+    }
+    if (schedule->bursts < UINT16_MAX) {
+        schedule->bursts++;
+    }
+    return now_us + (int64_t)schedule->interval_ms * 1000;
+}
+
+esp_err_t wol_schedule_finish(wol_schedule_t* schedule, bool woke, int64_t now_us)
+{
+    wol_schedule_stats_t* stats = &schedule->stats;
+    if (schedule->bursts == 0) {
+        return ESP_OK;
+    }
+
+    if (woke) {
+        uint32_t wake_ms = (uint32_t)((now_us - schedule->start_us) / 1000);
+        stats->wake_ms = wol_moving_average(stats->wake_ms, wake_ms, stats->wakes);
+        if (stats->wakes < UINT16_MAX) {
+            stats->wakes++;
+        }
+        if (schedule->bursts == 1 && stats->one_burst < UINT16_MAX) {
+            stats->one_burst++;
+        }
+        if (schedule->bursts > stats->max_bursts) {
+            stats->max_bursts = schedule->bursts;
+        }
+        stats->bursts += schedule->bursts;
+        ESP_LOGI(TAG, "PC %u woke after %u burst(s), %lu ms (%lu bursts over %u wake-ups, max %u)",
+                 schedule->pc, schedule->bursts, (unsigned long)wake_ms, (unsigned long)stats->bursts,
+                 stats->wakes, stats->max_bursts);
+    } else {
+        if (stats->failures < UINT16_MAX) {
+            stats->failures++;
+        }
+        ESP_LOGW(TAG, "PC %u did not wake after %u burst(s) (%u failed cycles)", schedule->pc, schedule->bursts,
+                 stats->failures);
+    }
+    stats->version = STATS_VERSION;
+
+    esp_err_t ret = save_stats(schedule->pc, stats);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save wake statistics: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
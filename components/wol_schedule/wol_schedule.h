@@ -0,0 +1,82 @@
+#ifndef WOL_SCHEDULE_H
+#define WOL_SCHEDULE_H
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WOL_SCHEDULE_NVS_NAMESPACE "wol_sched"
+
+// The learned first gap is used once this many wake-ups are on record, most of them
+// needing a single burst
+#define WOL_SCHEDULE_LEARN_MIN_WAKES 2
+
+typedef struct {
+    uint32_t first_interval_ms;     // Gap after the first burst without usable history
+    uint32_t max_interval_ms;       // Cap for the growing gap
+    uint8_t backoff;                // Gap multiplier per burst (1 = fixed spacing)
+} wol_schedule_config_t;
+
+// Per-PC wake statistics, kept in NVS as blob "pc<N>"
+typedef struct {
+    uint8_t version;
+    uint16_t wakes;                 // Cycles that ended with the PC waking up
+    uint16_t failures;              // Cycles that ended without a sign of life
+    uint16_t one_burst;             // Wake-ups that needed only the first burst
+    uint16_t max_bursts;            // Most bursts a wake-up has needed
+    uint32_t bursts;                // Bursts sent over all wake-ups
+    uint32_t wake_ms;               // First burst to first sign of life, moving average
+} wol_schedule_stats_t;
+
+// One wake cycle; owned by the task sending the bursts
+typedef struct {
+    const wol_schedule_config_t* config;
+    uint8_t pc;
+    uint16_t bursts;                // Bursts sent so far
+    uint32_t interval_ms;           // Gap before the next burst
+    int64_t start_us;               // First burst
+    wol_schedule_stats_t stats;
+} wol_schedule_t;
+
+/**
+ * @brief Start a wake cycle and load the PC's statistics
+ * @param schedule Cycle state
+ * @param config Spacing, must outlive the cycle
+ * @param pc PC index (selects the statistics)
+ */
+void wol_schedule_start(wol_schedule_t* schedule, const wol_schedule_config_t* config, uint8_t pc);
+
+/**
+ * @brief Record a burst that was just sent
+ * @param schedule Cycle state
+ * @param now_us esp_timer_get_time() after sending
+ * @return When the next burst is due (esp_timer_get_time() time base)
+ */
+int64_t wol_schedule_sent(wol_schedule_t* schedule, int64_t now_us);
+
+/**
+ * @brief End the cycle and store its outcome in the PC's statistics
+ * @param schedule Cycle state
+ * @param woke true if the PC showed a sign of life
+ * @param now_us When it did (or when the cycle gave up)
+ * @return ESP_OK, or the NVS error
+ */
+esp_err_t wol_schedule_finish(wol_schedule_t* schedule, bool woke, int64_t now_us);
+
+/**
+ * @brief Read a PC's statistics
+ * @param pc PC index
+ * @param stats Output, zeroed when there is no history
+ * @return ESP_OK, ESP_ERR_NOT_FOUND without history
+ */
+esp_err_t wol_schedule_get_stats(uint8_t pc, wol_schedule_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WOL_SCHEDULE_H
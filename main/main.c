@@ -7,10 +7,19 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/event_groups.h"
 
 #include "sdkconfig.h"
+#if CONFIG_PN532_TRANSPORT_SPI
+#include "pn532_driver_spi.h"
+#elif CONFIG_PN532_TRANSPORT_HSU
+#include "pn532_driver_hsu.h"
+#else
 #include "pn532_driver_i2c.h"
+#endif
 #include "pn532.h"
+#include "pn532_diag.h"
 #include "driver/rmt_tx.h"
 #include "led_strip.h"
 #include "driver/gpio.h"
@@ -18,13 +27,37 @@
 // New includes for Windows login functionality
 #include "wifi_manager.h"
 #include "wol_client.h"
+#include "wol_schedule.h"
 #include "hid_keyboard.h"
+#include "card_cache.h"
+#include "card_provision.h"
+#include "ndef.h"
+#include "classic_reader.h"
+#include "reader_supervisor.h"
+#include "uid_allowlist.h"
+#include "uid_allowlist_flash.h"
+#include "card_enroll.h"
+#include "login_worker.h"
+#include "login_trace.h"
+#include "host_tracker.h"
+#include "sock_budget.h"
+#include "readiness.h"
 #include "nvs_flash.h"
 
 
-// I2C mode configuration for PN532 (from sdkconfig)
+// PN532 pins for the selected transport (from sdkconfig)
+#if CONFIG_PN532_TRANSPORT_SPI
+#define MISO_PIN   CONFIG_PN532_MISO_PIN
+#define MOSI_PIN   CONFIG_PN532_MOSI_PIN
+#define SCK_PIN    CONFIG_PN532_SCK_PIN
+#define CS_PIN     CONFIG_PN532_CS_PIN
+#elif CONFIG_PN532_TRANSPORT_HSU
+#define UART_RX_PIN CONFIG_PN532_UART_RX_PIN
+#define UART_TX_PIN CONFIG_PN532_UART_TX_PIN
+#else
 #define SCL_PIN    CONFIG_PN532_SCL_PIN
 #define SDA_PIN    CONFIG_PN532_SDA_PIN
+#endif
 #define RESET_PIN  CONFIG_PN532_RESET_PIN
 #define IRQ_PIN    CONFIG_PN532_IRQ_PIN
 
@@ -38,34 +71,130 @@ static const char *TAG = "windows_login_nfc";
 #define LED_NUM CONFIG_LED_NUM
 #define LED_RMT_RES_HZ CONFIG_LED_RMT_RES_HZ
 
-// Authorized UIDs (replace with your actual card UIDs)
-// Format: Each UID is 4 or 7 bytes, add as many as needed
-#define MAX_AUTHORIZED_UIDS 5
-#define MAX_UID_LENGTH 7
-
-// Add your authorized UID here (example UID - replace with your actual card UID)
-static const uint8_t authorized_uids[MAX_AUTHORIZED_UIDS][MAX_UID_LENGTH] = {
-    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // Placeholder for additional UIDs
-    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // Placeholder for additional UIDs
-    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // Placeholder for additional UIDs
-    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // Placeholder for additional UIDs
-    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}  // Placeholder for additional UIDs
-};
-
-static const uint8_t authorized_uid_lengths[MAX_AUTHORIZED_UIDS] = {
-    7, // 0 means unused slot
-    4, // 0 means unused slot
-    0, // 0 means unused slot
-    0, // 0 means unused slot
-    0  // 0 means unused slot
-};
-
 // Windows Login Configuration
 #define WIFI_SSID "WiFiSSID"
 #define WIFI_PASSWORD "WiFiPassword"
 #define PC_MAC_ADDRESS "XX:XX:XX:XX:XX:XX"
 #define PC_IP_ADDRESS "x.x.x.x"
 #define WINDOWS_PASSWORD "WindowsPassword"
+// Optional: SecureOn password set in the NIC ("AA:BB:CC:DD:EE:FF" or "a.b.c.d", "" for none)
+// and the PC's IPv6 address for directed IPv6 WoL ("" for none)
+#define PC_SECUREON_PASSWORD ""
+#define PC_IPV6_ADDRESS ""
+// Also send every WoL burst to the IPv6 all-nodes group ff02::1, for VLANs that filter
+// IPv4 broadcast but pass IPv6 multicast
+#define WOL_IPV6_ALL_NODES 1
+
+// PCs a card can log into. A card's profile ("profile=N" in main/authorized_uids.txt or the
+// allowlist partition) indexes this table; enrolled cards and cards without one use entry 0.
+typedef struct {
+    const char *name;
+    const char *mac;
+    const char *ip;
+    const char *password;
+    const char *secureon;       // SecureOn password, NULL or "" for none
+    const char *ipv6;           // IPv6 address for directed WoL, NULL or "" for none
+} pc_profile_t;
+
+static const pc_profile_t pc_profiles[] = {
+    { "Default PC", PC_MAC_ADDRESS, PC_IP_ADDRESS, WINDOWS_PASSWORD, PC_SECUREON_PASSWORD, PC_IPV6_ADDRESS },
+};
+#define PC_PROFILE_COUNT (sizeof(pc_profiles) / sizeof(pc_profiles[0]))
+
+// Parsed MAC, prebuilt magic packet and open socket per PC; only the login worker sends
+static wol_context_t pc_wol[PC_PROFILE_COUNT];
+
+// A "wakeall" card wakes every PC in pc_profiles[] without logging in. Packets are paced to
+// WOL_GROUP_PPS over all PCs, resent every WOL_GROUP_RESEND_MS to PCs that haven't shown up
+// yet, for up to WOL_GROUP_WINDOW_MS.
+#define WAKE_ALL_PROFILE 0xFF
+#define WOL_GROUP_PPS 50
+#define WOL_GROUP_RESEND_MS 10000
+#define WOL_GROUP_WINDOW_MS 60000
+#define WOL_GROUP_PROBE_TIMEOUT_MS 300
+
+// Card metadata cache: repeat taps within the TTL skip identification and page reads
+#define CARD_CACHE_POLICY CARD_CACHE_POLICY_SKIP_ALL
+#define CARD_CACHE_TTL_MS (10 * 60 * 1000)
+
+// Set to 1 to turn the reader into an enrollment station that writes CARD_PROVISION_URI
+// to every card placed on it (instead of performing logins)
+#define CARD_PROVISION_MODE 0
+#define CARD_PROVISION_URI "https://example.com/badge"
+#define CARD_PROVISION_COUNT 0          // Stop after this many cards (0 = until reset)
+#define CARD_PROVISION_READ_ONLY 0      // Permanently lock provisioned cards
+
+// Mifare Classic badges: besides the UID, the content of CLASSIC_AUTH_BLOCK must match
+// CLASSIC_AUTH_EXPECTED. Keys are tried in order; the key that worked is cached per card.
+#define CLASSIC_AUTH_ENABLED 1
+#define CLASSIC_AUTH_BLOCK 4            // First data block of sector 1
+static const uint8_t classic_auth_expected[CLASSIC_READER_BLOCK_SIZE] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+static const uint8_t classic_keys[][CLASSIC_READER_KEY_LENGTH] = {
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, // Factory default
+    {0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5}, // MAD key A
+    {0xD3, 0xF7, 0xD3, 0xF7, 0xD3, 0xF7}, // NFC Forum key
+    {0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+};
+
+// Runtime enrollment: tap an admin card ("admin" in main/authorized_uids.txt or the allowlist
+// partition), then within ENROLL_WINDOW_MS the card to enroll; an authorized card is revoked instead
+#define CARD_ENROLL_ENABLED 1
+#define ENROLL_WINDOW_MS 10000
+
+// Reader health: PN532 antenna self-test and RF registers at boot, periodically and after
+// a run of misreads, so a detuned antenna can be told apart from bad cards
+#define READER_DIAG_INTERVAL_MS (30 * 60 * 1000)
+#define READER_DIAG_MISREAD_THRESHOLD 5
+
+// The tap loop wakes up this often without a card to let the supervisor check the PN532
+#define READER_IDLE_POLL_MS 1000
+// A card left on the reader is re-checked this often; a missed poll reports it removed
+#define READER_PRESENCE_POLL_MS 200
+
+// A login (WoL + typing) still running after this long is cancelled
+#define LOGIN_TIMEOUT_MS 90000
+// Per-stage deadlines for the login trace; a stage running longer logs a warning (0 = none)
+#define TRACE_DEADLINE_CARD_READ_MS 300
+#define TRACE_DEADLINE_AUTH_MS 20
+#define TRACE_DEADLINE_QUEUE_MS 100
+#define TRACE_DEADLINE_WIFI_CHECK_MS 500
+#define TRACE_DEADLINE_TOTAL_MS 45000
+// Log p50/p95/p99 per stage and the socket counters after this many logins (0 = never)
+#define TRACE_SUMMARY_EVERY 10
+// Period of the state machine's housekeeping tick
+#define APP_TICK_MS 1000
+
+// Background PC state tracking: a tap uses the tracked state instead of probing as long as
+// the next scheduled probe is at most HOST_STATE_MARGIN_MS overdue. Probes run every
+// HOST_TRACK_MIN_INTERVAL_MS after activity and back off to HOST_TRACK_MAX_INTERVAL_MS once
+// nobody has been around for HOST_TRACK_IDLE_AFTER_MS.
+#define HOST_STATE_MARGIN_MS 10000
+#define HOST_TRACK_MIN_INTERVAL_MS 5000
+#define HOST_TRACK_MAX_INTERVAL_MS 60000
+#define HOST_TRACK_IDLE_AFTER_MS (2 * 60 * 1000)
+
+// ARP presence check for a PC on the local subnet, tried before TCP probing
+#define ARP_PROBE_TIMEOUT_MS 300
+// WoL resend schedule: one burst right away, the next after WOL_FIRST_RESEND_MS (or the PC's
+// learned wake time), each later gap WOL_RESEND_BACKOFF times longer up to WOL_MAX_RESEND_MS.
+// Resending stops as soon as the PC shows a sign of life, or after WOL_WAKE_WINDOW_MS.
+#define WOL_FIRST_RESEND_MS 2000
+#define WOL_MAX_RESEND_MS 8000
+#define WOL_RESEND_BACKOFF 2
+#define WOL_WAKE_WINDOW_MS 30000
+// Once it is awake, how long Windows may take to reach the lock screen; typing starts as
+// soon as the readiness classifier (components/readiness) says it is safe.
+#define BOOT_CONFIRM_TIMEOUT_MS 45000
+
+static const wol_schedule_config_t wol_schedule_config = {
+    .first_interval_ms = WOL_FIRST_RESEND_MS,
+    .max_interval_ms = WOL_MAX_RESEND_MS,
+    .backoff = WOL_RESEND_BACKOFF,
+};
 
 // Set to 1 to force sending WoL packets on each tap regardless of PC state (for testing with Wireshark)
 #define WOL_ALWAYS_SEND_FOR_TEST 0
@@ -84,7 +213,70 @@ void led_pc_connect(void);
 void led_auth_success(void);
 void led_auth_fail(void);
 void led_read_fail(void);
-esp_err_t perform_windows_login(void);
+esp_err_t perform_windows_login(const pc_profile_t *pc, uint32_t trace);
+
+// Application events: the reader, login worker, WiFi, USB and a timer post these to the
+// state machine running in app_main
+typedef enum {
+    APP_EVENT_CARD_TAP,         // New card on the reader; card.authorized holds the verdict
+    APP_EVENT_CARD_REMOVED,
+    APP_EVENT_NET_UP,
+    APP_EVENT_NET_DOWN,
+    APP_EVENT_USB_MOUNTED,
+    APP_EVENT_USB_UNMOUNTED,
+    APP_EVENT_USB_SUSPENDED,
+    APP_EVENT_USB_RESUMED,
+    APP_EVENT_KBD_LEDS,         // Host keyboard driver wrote the LED report
+    APP_EVENT_LOGIN_DONE,       // Login job finished; result holds the outcome
+    APP_EVENT_TICK,
+} app_event_type_t;
+
+typedef struct {
+    app_event_type_t type;
+    union {
+        struct {
+            uint8_t uid[CARD_CACHE_MAX_UID_LENGTH];
+            uint8_t uid_length;
+            bool authorized;
+            uint8_t profile;    // Index into pc_profiles
+            uint32_t trace;     // login_trace id of this tap
+        } card;
+        esp_err_t result;
+    };
+} app_event_t;
+
+typedef enum {
+    APP_STATE_IDLE,             // Waiting for a card
+    APP_STATE_LOGIN,            // Login worker is waking a PC or typing; more jobs may be queued
+    APP_STATE_CANCELLING,       // Cancel requested, waiting for the login worker to stop
+} app_state_t;
+
+// LED patterns, played in order by the LED task so callers never block on a blink
+typedef enum {
+    LED_BOOT,
+    LED_PC_CONNECT,
+    LED_AUTH_SUCCESS,
+    LED_AUTH_FAIL,
+    LED_READ_FAIL,
+} led_pattern_t;
+
+#define APP_EVENT_QUEUE_LEN 16
+#define LED_QUEUE_LEN 4
+
+static QueueHandle_t app_event_queue = NULL;
+static QueueHandle_t led_queue = NULL;
+
+static void app_post(const app_event_t *event) {
+    if (!app_event_queue || xQueueSend(app_event_queue, event, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "⚠️ Event queue full, dropped event %d", event->type);
+    }
+}
+
+static void led_post(led_pattern_t pattern) {
+    if (!led_queue || xQueueSend(led_queue, &pattern, 0) != pdTRUE) {
+        ESP_LOGD(TAG, "LED busy, skipped pattern %d", pattern);
+    }
+}
 
 // Helper: case-insensitive substring check
 static bool strcasestr_simple(const char *haystack, const char *needle) {
@@ -101,66 +293,158 @@ static bool strcasestr_simple(const char *haystack, const char *needle) {
     return false;
 }
 
-// Function to extract URL from NDEF data (simplified approach)
-bool extract_url_from_ndef(uint8_t* data, int data_len, char* url, int url_max_len) {
-    if (!data || data_len <= 0 || !url || url_max_len <= 1) return false;
+static uint32_t reader_misreads = 0;
+static uint8_t reader_present_uid[CARD_CACHE_MAX_UID_LENGTH];
+static uint8_t reader_present_uid_length = 0;   // 0 = no card on the reader
+static int64_t reader_last_diag_us = 0;
 
-    // Look for the pattern: 03 13 d1 01 0f 55 04/05 [URL text] fe
-    for (int i = 0; i < data_len - 8; i++) {
-        // Check for NDEF TLV header: 03 13 d1 01 0f 55
-        if (data[i] == 0x03 && data[i+1] == 0x13 && data[i+2] == 0xd1 && 
-            data[i+3] == 0x01 && data[i+4] == 0x0f && data[i+5] == 0x55) {
-            
-            // uint8_t uri_code = data[i+6]; // Not used in this implementation
-            int url_start = i + 7;
-            int url_len = 0;
-            
-            // Extract URL text until we hit 0xfe or end of data
-            for (int j = url_start; j < data_len && url_len < url_max_len - 1; j++) {
-                if (data[j] == 0xfe) break; // NDEF terminator
-                url[url_len++] = data[j];
-            }
-            url[url_len] = '\0';
-            
-            // The URL is already complete in the NDEF data, no need to add protocol prefix
-            
-            return true;
-        }
+static void reader_run_diagnostics(pn532_io_handle_t io, const char *reason) {
+    pn532_diag_report_t report;
+
+    ESP_LOGI(TAG, "🩺 Reader self-test (%s)", reason);
+    reader_last_diag_us = esp_timer_get_time();
+    esp_err_t err = pn532_diag_run(io, &report);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "⚠️ Reader self-test failed: %s", esp_err_to_name(err));
+        return;
     }
-    return false;
+
+    pn532_diag_log(&report);
+
+    reader_supervisor_stats_t stats;
+    reader_supervisor_get_stats(&stats);
+    ESP_LOGI(TAG, "Uptime %lus, reader up %lus, %lu re-inits (%lu failed, last %lums, max %lums)",
+             (unsigned long)stats.uptime_s, (unsigned long)stats.reader_uptime_s,
+             (unsigned long)stats.reinits, (unsigned long)stats.reinit_failures,
+             (unsigned long)stats.last_reinit_ms, (unsigned long)stats.max_reinit_ms);
+    if (!report.antenna_ok) {
+        ESP_LOGW(TAG, "⚠️ Antenna out of limits - misreads are caused by the reader, not the cards");
+    } else if (report.external_field) {
+        ESP_LOGW(TAG, "⚠️ Another RF field is present near the reader");
+    }
+}
+
+static void reader_diagnostics_if_due(pn532_io_handle_t io) {
+    if (esp_timer_get_time() - reader_last_diag_us >= (int64_t)READER_DIAG_INTERVAL_MS * 1000) {
+        reader_run_diagnostics(io, "periodic");
+    }
+}
+
+// Misread feedback; a run of misreads triggers a self-test. The card counts as not yet
+// seen so the next poll retries it.
+static void reader_misread(pn532_io_handle_t io) {
+    reader_present_uid_length = 0;
+    led_post(LED_READ_FAIL);
+    if (++reader_misreads == READER_DIAG_MISREAD_THRESHOLD) {
+        reader_run_diagnostics(io, "repeated misreads");
+    }
+}
+
+// Compare without an early exit so timing does not reveal how many bytes matched
+static bool equal_const_time(const uint8_t *a, const uint8_t *b, size_t len) {
+    uint8_t diff = 0;
+    for (size_t i = 0; i < len; i++) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
+
+// Extract the first URI record from tag user memory (page 4 onwards)
+static bool extract_url_from_ndef(const uint8_t* data, size_t data_len, char* url, size_t url_max_len) {
+    if (!data || !url || url_max_len <= 1) return false;
+
+    ndef_record_t record;
+    if (ndef_find_uri(data, data_len, &record) != ESP_OK) {
+        return false;
+    }
+    return ndef_uri_to_string(&record, url, url_max_len) == ESP_OK;
 }
 
-// Function to check if UID is authorized
+// Function to check if UID is authorized: runtime enrollments and revocations first, then the
+// built-in list (main/authorized_uids.txt) and the allowlist partition
 bool authenticate_uid(const uint8_t* uid, uint8_t uid_length) {
     if (!uid || uid_length == 0) return false;
-    
-    // Check against all authorized UIDs
-    for (int i = 0; i < MAX_AUTHORIZED_UIDS; i++) {
-        // Skip unused slots (length = 0)
-        if (authorized_uid_lengths[i] == 0) continue;
-        
-        // Check if lengths match
-        if (authorized_uid_lengths[i] != uid_length) continue;
-        
-        // Compare UID bytes
-        bool match = true;
-        for (int j = 0; j < uid_length; j++) {
-            if (authorized_uids[i][j] != uid[j]) {
-                match = false;
-                break;
-            }
-        }
-        
-        if (match) {
-            ESP_LOGI(TAG, "✅ UID matches authorized UID #%d", i + 1);
-            return true;
-        }
+
+#if CARD_ENROLL_ENABLED
+    card_enroll_state_t enrolled = card_enroll_lookup(uid, uid_length);
+    if (enrolled == CARD_ENROLL_REVOKED) {
+        ESP_LOGI(TAG, "❌ UID has been revoked");
+        return false;
     }
-    
+    if (enrolled == CARD_ENROLL_ALLOWED) {
+        ESP_LOGI(TAG, "✅ UID found in enrolled cards");
+        return true;
+    }
+#endif
+    if (uid_allowlist_contains(uid, uid_length)) {
+        ESP_LOGI(TAG, "✅ UID found in authorized list");
+        return true;
+    }
+    if (uid_allowlist_flash_contains(uid, uid_length)) {
+        ESP_LOGI(TAG, "✅ UID found in allowlist partition v%lu", (unsigned long)uid_allowlist_flash_version());
+        return true;
+    }
+
     ESP_LOGI(TAG, "❌ UID not found in authorized list");
     return false;
 }
 
+// PC profile of an authorized card (WAKE_ALL_PROFILE for a "wakeall" card); cards only known
+// through enrollment use the default PC
+static uint8_t uid_profile(const uint8_t* uid, uint8_t uid_length) {
+    uint8_t flags = 0;
+    if (!uid_allowlist_lookup(uid, uid_length, &flags)) {
+        uid_allowlist_flash_lookup(uid, uid_length, &flags);
+    }
+    if (flags & UID_ALLOWLIST_FLAG_WAKE_ALL) {
+        return WAKE_ALL_PROFILE;
+    }
+    uint8_t profile = UID_ALLOWLIST_PROFILE(flags);
+    if (profile >= PC_PROFILE_COUNT) {
+        ESP_LOGW(TAG, "⚠️ Card profile %u not configured, using %s", profile, pc_profiles[0].name);
+        profile = 0;
+    }
+    return profile;
+}
+
+#if CARD_ENROLL_ENABLED
+static int64_t enroll_armed_until_us = 0;
+
+static bool is_admin_uid(const uint8_t* uid, uint8_t uid_length) {
+    return card_enroll_lookup(uid, uid_length) != CARD_ENROLL_REVOKED &&
+           (uid_allowlist_is_admin(uid, uid_length) || uid_allowlist_flash_is_admin(uid, uid_length));
+}
+
+// Admin card arms enrollment; the next card within the window is enrolled or revoked.
+// Returns true if the tap was consumed.
+static bool handle_enrollment_tap(const uint8_t* uid, uint8_t uid_length) {
+    int64_t now = esp_timer_get_time();
+
+    if (is_admin_uid(uid, uid_length)) {
+        enroll_armed_until_us = now + (int64_t)ENROLL_WINDOW_MS * 1000;
+        ESP_LOGI(TAG, "🛂 Admin card - tap the card to enroll or revoke within %d s", ENROLL_WINDOW_MS / 1000);
+        led_post(LED_BOOT);
+        return true;
+    }
+    if (now >= enroll_armed_until_us) {
+        return false;
+    }
+    enroll_armed_until_us = 0;
+
+    esp_err_t err;
+    if (authenticate_uid(uid, uid_length)) {
+        err = card_enroll_revoke(uid, uid_length);
+        ESP_LOGI(TAG, "🚫 Revoking card: %s", esp_err_to_name(err));
+        led_post(LED_AUTH_FAIL);
+    } else {
+        err = card_enroll_add(uid, uid_length);
+        ESP_LOGI(TAG, "📝 Enrolling card: %s", esp_err_to_name(err));
+        led_post(err == ESP_OK ? LED_AUTH_SUCCESS : LED_READ_FAIL);
+    }
+    return true;
+}
+#endif
+
 // LED status indication function (legacy - use specific functions instead)
 void led_status_indication(const char* color, int duration_ms) {
     // This function is kept for compatibility but should use specific LED functions
@@ -447,14 +731,60 @@ void init_led() {
 #endif
 }
 
-// Windows Login Function
-esp_err_t perform_windows_login(void)
+// After wake-up: probe SMB and RDP until they open and let the readiness classifier combine
+// them with the USB/keyboard signals from the state machine. ESP_OK once typing is safe,
+// ESP_ERR_TIMEOUT if Windows never showed up, ESP_ERR_NOT_FINISHED when cancelled.
+static esp_err_t wait_for_windows_ready(const pc_profile_t *pc)
+{
+    static const struct {
+        uint16_t port;
+        readiness_signal_t signal;
+    } ready_ports[] = {
+        { 445, READINESS_SIG_SMB },
+        { 3389, READINESS_SIG_RDP },
+    };
+
+    int64_t deadline_us = esp_timer_get_time() + (int64_t)BOOT_CONFIRM_TIMEOUT_MS * 1000;
+    while (esp_timer_get_time() < deadline_us) {
+        uint16_t ports[2];
+        readiness_signal_t signals[2];
+        size_t count = 0;
+        for (size_t i = 0; i < sizeof(ready_ports) / sizeof(ready_ports[0]); i++) {
+            if (!readiness_seen(ready_ports[i].signal)) {
+                ports[count] = ready_ports[i].port;
+                signals[count++] = ready_ports[i].signal;
+            }
+        }
+        if (count > 0) {
+            uint32_t open = wol_probe_ports(pc->ip, ports, count, 1000);
+            for (size_t i = 0; i < count; i++) {
+                if (open & (1u << i)) {
+                    readiness_note(signals[i]);
+                }
+            }
+        }
+
+        if (readiness_check() != READINESS_WAIT) {
+            return ESP_OK;
+        }
+        if (login_worker_wait_ms(count > 0 ? 250 : 100)) {
+            return ESP_ERR_NOT_FINISHED;
+        }
+    }
+    return ESP_ERR_TIMEOUT;
+}
+
+// Windows Login Function. Runs in the login worker; returns ESP_ERR_NOT_FINISHED when cancelled.
+esp_err_t perform_windows_login(const pc_profile_t *pc, uint32_t trace)
 {
-    ESP_LOGI(TAG, "🔐 Starting Windows login process...");
+    size_t pc_index = pc - pc_profiles;
+    wol_context_t *wol = &pc_wol[pc_index];
+    ESP_LOGI(TAG, "🔐 Starting Windows login process for %s...", pc->name);
     
     // Check WiFi connection first
     ESP_LOGI(TAG, "🔍 Checking WiFi connection...");
     esp_err_t wifi_check = wifi_manager_check_connection();
+    login_trace_mark(trace, LOGIN_TRACE_WIFI_CHECK);
     if (wifi_check != ESP_OK) {
         ESP_LOGE(TAG, "❌ WiFi connection lost! Cannot proceed with login");
         return ESP_FAIL;
@@ -463,19 +793,39 @@ esp_err_t perform_windows_login(void)
     // Optional: send WoL regardless of state for testing
 #if WOL_ALWAYS_SEND_FOR_TEST
     ESP_LOGW(TAG, "WOL test mode enabled: sending WoL packet");
-    wol_send_magic_packet_all(PC_MAC_ADDRESS, PC_IP_ADDRESS);
+    wol_context_send_burst(wol);
+    login_trace_mark(trace, LOGIN_TRACE_WOL_SEND);
 #endif
 
     // Check if PC is already on
     ESP_LOGI(TAG, "🔍 Checking if PC is already on...");
-    ESP_LOGI(TAG, "📍 PC IP Address: %s", PC_IP_ADDRESS);
-    ESP_LOGI(TAG, "📍 PC MAC Address: %s", PC_MAC_ADDRESS);
-    // Keep detection quick to avoid long waits on tap
-    bool pc_is_on = wol_check_host_reachable(PC_IP_ADDRESS, 600);
+    ESP_LOGI(TAG, "📍 PC IP Address: %s", pc->ip);
+    ESP_LOGI(TAG, "📍 PC MAC Address: %s", pc->mac);
+    // The background tracker usually knows already. Otherwise keep detection quick to avoid
+    // long waits on tap: ARP answers in milliseconds on the local segment and rules a PC out,
+    // but only a TCP probe proves it is up
+    bool pc_is_on;
+    host_state_t cached = host_tracker_get(pc_index, HOST_STATE_MARGIN_MS);
+    if (cached == HOST_STATE_UP || cached == HOST_STATE_OFF) {
+        ESP_LOGI(TAG, "⚡ PC is %s (tracked)", host_state_name(cached));
+        pc_is_on = cached == HOST_STATE_UP;
+    } else {
+        wol_presence_t presence = wol_check_host_arp(wol, ARP_PROBE_TIMEOUT_MS);
+        if (presence == WOL_PRESENCE_UP) {
+            // A sleeping PC whose NIC does ARP offload also answers; one burst wakes it if so
+            wol_context_send_burst(wol);
+            login_trace_mark(trace, LOGIN_TRACE_WOL_SEND);
+        }
+        pc_is_on = presence != WOL_PRESENCE_DOWN && wol_check_host_reachable(pc->ip, 600);
+        if (presence == WOL_PRESENCE_UP && !pc_is_on) {
+            ESP_LOGI(TAG, "💤 PC answers ARP only; treating it as asleep until Windows shows up");
+        }
+    }
+    login_trace_mark(trace, LOGIN_TRACE_HOST_PROBE);
     
     if (pc_is_on) {
         ESP_LOGI(TAG, "✅ PC is already on! Proceeding with login...");
-        led_pc_connect();  // Purple blink for PC connection
+        led_post(LED_PC_CONNECT);  // Purple blink for PC connection
         
         // PC is already on - quick login with no delay
         ESP_LOGI(TAG, "⚡ Quick login - PC is already running");
@@ -485,11 +835,13 @@ esp_err_t perform_windows_login(void)
         
         // Brief delay before typing password
         ESP_LOGI(TAG, "⏳ Brief delay before typing password...");
-        vTaskDelay(500 / portTICK_PERIOD_MS);
+        if (login_worker_wait_ms(500)) {
+            return ESP_ERR_NOT_FINISHED;
+        }
 
         // Type the Windows password
         ESP_LOGI(TAG, "Typing Windows password...");
-        esp_err_t ret = hid_keyboard_type_string(WINDOWS_PASSWORD, 50);
+        esp_err_t ret = hid_keyboard_type_string(pc->password, 50);
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "Failed to type password");
             return ret;
@@ -498,86 +850,683 @@ esp_err_t perform_windows_login(void)
         // Press Enter to submit
         ESP_LOGI(TAG, "Pressing Enter to submit password...");
         hid_keyboard_press_enter();
+        login_trace_mark(trace, LOGIN_TRACE_HID_TYPE);
         
         ESP_LOGI(TAG, "🎉 Windows login completed!");
         
     } else {
         ESP_LOGI(TAG, "💤 PC is off. Sending Wake-on-LAN packet...");
         
-        // Alternate WoL and probe 3 ports for 30 seconds total
+        // Resend WoL on a backoff schedule for up to 30 seconds. On our subnet the PC's first
+        // broadcast (gratuitous ARP, DHCP) tells us it woke up, so no probes are sent while it
+        // is still off; a PC behind a router is probed between bursts instead.
         esp_err_t ret = ESP_FAIL;
-        int start_time = esp_timer_get_time() / 1000; // Convert to milliseconds
-        int attempt = 0;
+        bool watching = wol_context_is_local(wol) && wol_wake_watch_start(wol) == ESP_OK;
+        bool booting = false;
+        wol_schedule_t schedule;
+        wol_schedule_start(&schedule, &wol_schedule_config, pc_index);
+        int64_t window_end_us = esp_timer_get_time() + (int64_t)WOL_WAKE_WINDOW_MS * 1000;
+        readiness_start(pc_index, esp_timer_get_time());
         
-        while ((esp_timer_get_time() / 1000) - start_time < 30000 && !pc_is_on) {
-            attempt++;
-            ESP_LOGI(TAG, "🔔 WoL attempt %d", attempt);
-            ret = wol_send_magic_packet_all(PC_MAC_ADDRESS, PC_IP_ADDRESS);
+        while (esp_timer_get_time() < window_end_us && !booting && !login_worker_cancelled()) {
+            ESP_LOGI(TAG, "🔔 WoL attempt %u", schedule.bursts + 1);
+            ret = wol_context_send_burst(wol);
+            login_trace_mark(trace, LOGIN_TRACE_WOL_SEND);
             if (ret != ESP_OK) {
                 ESP_LOGW(TAG, "WoL send failed: %s", esp_err_to_name(ret));
             }
+            int64_t resend_at_us = wol_schedule_sent(&schedule, esp_timer_get_time());
+            if (resend_at_us > window_end_us) {
+                resend_at_us = window_end_us;
+            }
             
-            ESP_LOGI(TAG, "🔍 Probing 3 ports...");
-            for (int probe = 1; probe <= 3; probe++) {
-                ESP_LOGI(TAG, "Probe %d/3", probe);
-                if (wol_check_host_reachable(PC_IP_ADDRESS, 1000)) {
+            if (watching) {
+                while (!login_worker_cancelled() && esp_timer_get_time() < resend_at_us) {
+                    if (wol_wake_watch_wait(100)) {
+                        readiness_note(READINESS_SIG_NIC);
+                        booting = true;
+                        break;
+                    }
+                }
+                login_trace_mark(trace, LOGIN_TRACE_WAKE_WAIT);
+                continue;
+            }
+
+            ESP_LOGI(TAG, "🔍 Probing until the next burst...");
+            while (!login_worker_cancelled() && esp_timer_get_time() < resend_at_us) {
+                if (wol_check_host_reachable(pc->ip, 1000)) {
                     pc_is_on = true;
+                    booting = true;
                     break;
                 }
+                login_worker_wait_ms(100);  // Unreachable errors return at once
             }
-            
-            if (pc_is_on) break;
-            
-            // Quick check if we're still within 30s before next WoL
-            if ((esp_timer_get_time() / 1000) - start_time >= 30000) {
-                break;
-            }
+            login_trace_mark(trace, LOGIN_TRACE_HOST_PROBE);
         }
+        wol_wake_watch_stop();
         
+        if (login_worker_cancelled()) {
+            readiness_finish(false);
+            return ESP_ERR_NOT_FINISHED;
+        }
+
         // Check if PC is now on
-        ESP_LOGI(TAG, "Checking if PC is now on...");
-        if (!pc_is_on) {
-            pc_is_on = wol_check_host_reachable(PC_IP_ADDRESS, 3000);
+        if (!booting) {
+            ESP_LOGI(TAG, "Checking if PC is now on...");
+            booting = wol_check_host_reachable(pc->ip, 3000);
+            login_trace_mark(trace, LOGIN_TRACE_HOST_PROBE);
+        }
+        wol_schedule_finish(&schedule, booting, esp_timer_get_time());
+
+        if (booting) {
+            // The NIC comes up well before the lock screen; watch Windows come up from here on
+            ESP_LOGI(TAG, "🌅 PC is waking up (after %u WoL bursts), waiting for Windows...", schedule.bursts);
+            host_tracker_set(pc_index, HOST_STATE_BOOTING);
+            esp_err_t ready = wait_for_windows_ready(pc);
+            login_trace_mark(trace, LOGIN_TRACE_BOOT_WAIT);
+            if (ready == ESP_ERR_NOT_FINISHED) {
+                readiness_finish(false);
+                return ESP_ERR_NOT_FINISHED;
+            }
+            pc_is_on = ready == ESP_OK;
+            if (!pc_is_on && wol_check_host_reachable(pc->ip, 1000)) {
+                // Up, but without the signals the classifier waits for (e.g. no USB to it)
+                ESP_LOGW(TAG, "⚠️ PC answers on the network but shows no other sign of Windows; trying anyway");
+                pc_is_on = true;
+            }
         }
         
         if (pc_is_on) {
             ESP_LOGI(TAG, "✅ PC is now on! Proceeding with login...");
-            led_pc_connect();  // Purple blink for PC connection
-            
-            // Wait for Windows to boot and lock screen to be ready
-            ESP_LOGI(TAG, "⏳ Waiting for Windows to boot and lock screen to be ready...");
-            vTaskDelay(7000 / portTICK_PERIOD_MS);
+            led_post(LED_PC_CONNECT);  // Purple blink for PC connection
 
             // Wake focus before typing
             hid_keyboard_press_enter();
             
             // Brief delay before typing password
             ESP_LOGI(TAG, "⏳ Brief delay before typing password...");
-            vTaskDelay(500 / portTICK_PERIOD_MS);
+            if (login_worker_wait_ms(500)) {
+                readiness_finish(false);
+                return ESP_ERR_NOT_FINISHED;
+            }
 
             // Type the Windows password
             ESP_LOGI(TAG, "Typing Windows password...");
-            ret = hid_keyboard_type_string(WINDOWS_PASSWORD, 50);
+            ret = hid_keyboard_type_string(pc->password, 50);
             if (ret != ESP_OK) {
                 ESP_LOGE(TAG, "Failed to type password");
+                readiness_finish(false);
                 return ret;
             }
             
             // Press Enter to submit
             ESP_LOGI(TAG, "Pressing Enter to submit password...");
             hid_keyboard_press_enter();
+            login_trace_mark(trace, LOGIN_TRACE_HID_TYPE);
             
             ESP_LOGI(TAG, "🎉 Windows login completed!");
+            readiness_finish(true);
             
         } else {
             ESP_LOGW(TAG, "❌ PC did not respond after Wake-on-LAN. It may not support WoL or be configured properly.");
+            readiness_finish(false);
+            host_tracker_set(pc_index, HOST_STATE_OFF);
             return ESP_FAIL;
         }
     }
     
+    host_tracker_set(pc_index, HOST_STATE_UP);
     return ESP_OK;
 }
 
+#if CARD_PROVISION_MODE
+static void provision_card_done(const uint8_t* uid, uint8_t uid_length, esp_err_t result, void* arg)
+{
+    ESP_LOG_BUFFER_HEX_LEVEL(TAG, uid, uid_length, ESP_LOG_INFO);
+    led_post(result == ESP_OK ? LED_AUTH_SUCCESS : LED_AUTH_FAIL);
+}
+
+// Enrollment station: write the configured URI to a stack of cards, one after another
+static void run_provisioning_station(pn532_io_handle_t io_handle)
+{
+    static uint8_t tlv[128];
+    size_t tlv_len = 0;
+
+    esp_err_t err = card_provision_build_uri_tlv(CARD_PROVISION_URI, tlv, sizeof(tlv), &tlv_len);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "❌ Provisioning URI does not fit a card: %s", esp_err_to_name(err));
+        return;
+    }
+
+    card_provision_job_t job = {
+        .tlv = tlv,
+        .tlv_length = tlv_len,
+        .make_read_only = CARD_PROVISION_READ_ONLY,
+    };
+    card_provision_station_stats_t stats = {0};
+
+    ESP_LOGI(TAG, "🏭 Provisioning mode: writing %s (%d bytes) to each card", CARD_PROVISION_URI, (int)tlv_len);
+    card_provision_station_run(io_handle, &job, CARD_PROVISION_COUNT, provision_card_done, NULL, &stats);
+    ESP_LOGI(TAG, "🏭 Batch done: %lu ok, %lu failed in %lu s", (unsigned long)stats.cards_ok,
+             (unsigned long)stats.cards_failed, (unsigned long)(stats.elapsed_ms / 1000));
+}
+#endif
+
+// Card reader task: owns the PN532, turns cards into tap/removal events for the state machine
+static void reader_post_tap(const uint8_t *uid, uint8_t uid_length, bool authorized, uint32_t trace) {
+    login_trace_mark(trace, LOGIN_TRACE_AUTH);
+    app_event_t event = { .type = APP_EVENT_CARD_TAP };
+    memcpy(event.card.uid, uid, uid_length);
+    event.card.uid_length = uid_length;
+    event.card.authorized = authorized;
+    event.card.profile = authorized ? uid_profile(uid, uid_length) : 0;
+    event.card.trace = trace;
+    app_post(&event);
+}
+
+static void reader_task(void *arg)
+{
+    pn532_io_handle_t io = (pn532_io_handle_t)arg;
+    esp_err_t err;
+
+    ESP_LOGI(TAG, "Waiting for an ISO14443A Card ...");
+    while (1)
+    {
+        uint8_t uid[CARD_CACHE_MAX_UID_LENGTH] = {0}; // Buffer to store the returned UID
+        uint8_t uid_length;                     // Length of the UID (4 or 7 bytes depending on ISO14443A card type)
+        int64_t poll_started_us = esp_timer_get_time();
+
+        // Wait for an ISO14443A type cards (Mifare, etc.).  When one is found
+        // 'uid' will be populated with the UID, and uid_length will indicate
+        // if the uid is 4 bytes (Mifare Classic) or 7 bytes (Mifare Ultralight)
+        err = pn532_read_passive_target_id(io, PN532_BRTY_ISO14443A_106KBPS, uid, &uid_length, READER_IDLE_POLL_MS);
+        reader_supervisor_report(io, err == ESP_ERR_TIMEOUT ? ESP_OK : err);
+
+        if (ESP_ERR_TIMEOUT == err)
+        {
+            if (reader_present_uid_length) {
+                app_event_t event = { .type = APP_EVENT_CARD_REMOVED };
+                memcpy(event.card.uid, reader_present_uid, reader_present_uid_length);
+                event.card.uid_length = reader_present_uid_length;
+                reader_present_uid_length = 0;
+                app_post(&event);
+            }
+
+            // No card: idle time for housekeeping
+            reader_supervisor_poll(io);
+            reader_diagnostics_if_due(io);
+#if CARD_ENROLL_ENABLED
+            card_enroll_poll();
+#endif
+        }
+        else if (ESP_OK == err)
+        {
+            // A card resting on the reader is one tap, not one per poll
+            if (uid_length == reader_present_uid_length && memcmp(uid, reader_present_uid, uid_length) == 0) {
+                vTaskDelay(pdMS_TO_TICKS(READER_PRESENCE_POLL_MS));
+                continue;
+            }
+            memcpy(reader_present_uid, uid, uid_length);
+            reader_present_uid_length = uid_length;
+
+            // Detection includes the part of the poll spent waiting for the card
+            uint32_t trace = login_trace_start(poll_started_us);
+            login_trace_mark(trace, LOGIN_TRACE_DETECT);
+
+            // Display some basic information about the card
+            ESP_LOGI(TAG, "Found an ISO14443A card");
+            ESP_LOGI(TAG, "UID Length: %d bytes", uid_length);
+            ESP_LOGI(TAG, "UID Value:");
+            ESP_LOG_BUFFER_HEX_LEVEL(TAG, uid, uid_length, ESP_LOG_INFO);
+
+#if CARD_ENROLL_ENABLED
+            if (handle_enrollment_tap(uid, uid_length)) {
+                login_trace_finish(trace, ESP_OK);
+                reader_misreads = 0;
+                continue;
+            }
+#endif
+
+#if CLASSIC_AUTH_ENABLED
+            // Mifare Classic badges carry no NDEF; authorize on UID plus sector content
+            uint8_t sak = 0;
+            pn532_get_passive_target_info(io, NULL, &sak);
+            if (classic_reader_is_classic(sak)) {
+                ESP_LOGI(TAG, "found Mifare Classic target (SAK 0x%02x)", sak);
+
+                uint8_t block[CLASSIC_READER_BLOCK_SIZE];
+                err = classic_reader_read_block(io, uid, uid_length, sak, CLASSIC_AUTH_BLOCK,
+                                                classic_keys, sizeof(classic_keys) / sizeof(classic_keys[0]),
+                                                block, NULL);
+                login_trace_mark(trace, LOGIN_TRACE_CARD_READ);
+                bool authorized = false;
+                if (err == ESP_ERR_NOT_FOUND) {
+                    ESP_LOGI(TAG, "❌ Authentication failed. Sector keys unknown.");
+                } else if (err != ESP_OK) {
+                    ESP_LOGW(TAG, "❌ Failed to read block %d - misread or card too far", CLASSIC_AUTH_BLOCK);
+                    login_trace_finish(trace, err);
+                    reader_misread(io);
+                    continue;
+                } else {
+                    // Run both checks every time so the response time doesn't tell which one failed
+                    bool uid_ok = authenticate_uid(uid, uid_length);
+                    bool content_ok = equal_const_time(block, classic_auth_expected, sizeof(block));
+                    if (uid_ok & content_ok) {
+                        ESP_LOGI(TAG, "✅ AUTHENTICATION SUCCESS! Card and sector content authorized.");
+                        authorized = true;
+                    } else {
+                        ESP_LOGI(TAG, "❌ Authentication failed. UID or sector content not authorized.");
+                    }
+                }
+
+                reader_post_tap(uid, uid_length, authorized, trace);
+                reader_misreads = 0;
+                continue;
+            }
+#endif
+
+            // Repeat taps of a recently seen card can skip identification and content reads
+            card_cache_entry_t cached_card;
+            bool cache_hit = CARD_CACHE_POLICY != CARD_CACHE_POLICY_DISABLED &&
+                             card_cache_lookup(uid, uid_length, CARD_CACHE_TTL_MS, &cached_card);
+            bool skip_reads = cache_hit && CARD_CACHE_POLICY == CARD_CACHE_POLICY_SKIP_ALL;
+
+            NTAG2XX_MODEL ntag_model = NTAG2XX_UNKNOWN;
+            int page_max = 0;
+            if (cache_hit) {
+                ntag_model = (NTAG2XX_MODEL)cached_card.model;
+                page_max = cached_card.page_count;
+                ESP_LOGI(TAG, "⚡ Known card (model %d, %d pages) - skipping identification", ntag_model, page_max);
+            } else {
+                err = pn532_in_list_passive_target(io);
+                if (err != ESP_OK) {
+                    ESP_LOGW(TAG, "❌ Failed to inList passive target - misread or card too far");
+                    login_trace_finish(trace, err);
+                    reader_misread(io);
+                    continue;
+                }
+
+                err = ntag2xx_get_model(io, &ntag_model);
+                if (err != ESP_OK) {
+                    ESP_LOGW(TAG, "❌ Failed to get NTAG model - misread or card too far");
+                    login_trace_finish(trace, err);
+                    reader_misread(io);
+                    continue;
+                }
+
+                switch (ntag_model) {
+                    case NTAG2XX_NTAG213:
+                        page_max = 45;
+                        ESP_LOGI(TAG, "found NTAG213 target (or maybe NTAG203)");
+                        break;
+
+                    case NTAG2XX_NTAG215:
+                        page_max = 135;
+                        ESP_LOGI(TAG, "found NTAG215 target");
+                        break;
+
+                    case NTAG2XX_NTAG216:
+                        page_max = 231;
+                        ESP_LOGI(TAG, "found NTAG216 target");
+                        break;
+
+                    default:
+                        ESP_LOGI(TAG, "Found unknown NTAG target!");
+                        login_trace_finish(trace, ESP_ERR_NOT_SUPPORTED);
+                        reader_misread(io);
+                        continue;
+                }
+            }
+
+            // Read pages to get NDEF data for authentication
+            uint8_t ndef_data[256];
+            int ndef_len = 0;
+            bool auth_success = false;
+            
+            // Read first 16 pages (256 bytes) to capture NDEF data across boundaries
+            for(int page=0; !skip_reads && page < 16 && page < page_max; page+=4) {
+                uint8_t buf[16];
+                err = ntag2xx_read_page(io, page, buf, 16);
+                if (err == ESP_OK) {
+                    ESP_LOG_BUFFER_HEXDUMP(TAG, buf, 16, ESP_LOG_INFO);
+                    
+                    // Collect NDEF data for authentication
+                    if (ndef_len <= (int)sizeof(ndef_data) - 16) {
+                        memcpy(ndef_data + ndef_len, buf, 16);
+                        ndef_len += 16;
+                    }
+                }
+                else {
+                    ESP_LOGI(TAG, "Failed to read page %d", page);
+                    break;
+                }
+            }
+            
+            // Check if we failed to read any data (misread)
+            if (!skip_reads && ndef_len == 0) {
+                ESP_LOGW(TAG, "❌ Failed to read card data - misread or card too far");
+                card_cache_invalidate(uid, uid_length);
+                login_trace_finish(trace, err);
+                reader_misread(io);
+                continue; // Try again
+            }
+
+            if (!skip_reads) {
+                // Remember the card; user memory starts at page 4
+                card_cache_entry_t entry = {
+                    .uid_length = uid_length,
+                    .model = (uint8_t)ntag_model,
+                    .page_count = (uint16_t)page_max,
+                    .ndef_length = (uint16_t)(ndef_len > 16 ? ndef_len - 16 : 0),
+                    .ndef_hash = card_cache_hash(ndef_data + 16, ndef_len > 16 ? ndef_len - 16 : 0),
+                };
+                memcpy(entry.uid, uid, uid_length);
+                if (cache_hit && entry.ndef_hash != cached_card.ndef_hash) {
+                    ESP_LOGI(TAG, "Card content changed since last tap");
+                }
+                card_cache_store(&entry);
+
+                char url[128];
+                if (ndef_len > 16 && extract_url_from_ndef(ndef_data + 16, ndef_len - 16, url, sizeof(url))) {
+                    ESP_LOGI(TAG, "🔗 Card URL: %s", url);
+                }
+            }
+            
+            login_trace_mark(trace, LOGIN_TRACE_CARD_READ);
+
+            // Try to authenticate the card using UID
+            ESP_LOGI(TAG, "🔍 Authenticating card using UID...");
+            ESP_LOGI(TAG, "📋 Card UID (%d bytes):", uid_length);
+            ESP_LOG_BUFFER_HEX_LEVEL(TAG, uid, uid_length, ESP_LOG_INFO);
+            
+            if (authenticate_uid(uid, uid_length)) {
+                ESP_LOGI(TAG, "✅ AUTHENTICATION SUCCESS! Card authorized.");
+                auth_success = true;
+            } else {
+                ESP_LOGI(TAG, "❌ Authentication failed. UID not authorized.");
+            }
+
+            // The state machine starts (or cancels) the login; the reader keeps polling
+            reader_post_tap(uid, uid_length, auth_success, trace);
+            
+            // Continue reading remaining pages for display
+            for(int page=16; !skip_reads && page < page_max; page+=4) {
+                uint8_t buf[16];
+                err = ntag2xx_read_page(io, page, buf, 16);
+                if (err == ESP_OK) {
+                    ESP_LOG_BUFFER_HEXDUMP(TAG, buf, 16, ESP_LOG_INFO);
+                }
+                else {
+                    ESP_LOGI(TAG, "Failed to read page %d", page);
+                    break;
+                }
+            }
+            
+            if (auth_success) {
+                ESP_LOGI(TAG, "🎉 Authorized card processed successfully!");
+            }
+            
+            reader_misreads = 0;
+        } else {
+            // NFC read failed - show single red blink for misread/cut-off
+            ESP_LOGD(TAG, "NFC read failed or no card detected");
+            reader_misread(io);
+        }
+    }
+}
+
+static void led_task(void *arg)
+{
+    led_pattern_t pattern;
+    while (1) {
+        if (xQueueReceive(led_queue, &pattern, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        switch (pattern) {
+            case LED_BOOT:         led_boot_indication(); break;
+            case LED_PC_CONNECT:   led_pc_connect(); break;
+            case LED_AUTH_SUCCESS: led_auth_success(); break;
+            case LED_AUTH_FAIL:    led_auth_fail(); break;
+            case LED_READ_FAIL:    led_read_fail(); break;
+        }
+    }
+}
+
+// Wake every PC at once, e.g. a row of workstations in the morning. Runs in the login worker.
+static esp_err_t wake_all_pcs(uint32_t trace)
+{
+    static const wol_group_config_t config = {
+        .packets_per_second = WOL_GROUP_PPS,
+        .resend_interval_ms = WOL_GROUP_RESEND_MS,
+        .window_ms = WOL_GROUP_WINDOW_MS,
+        .probe_timeout_ms = WOL_GROUP_PROBE_TIMEOUT_MS,
+        .cancelled = login_worker_cancelled,
+    };
+    static wol_group_result_t results[PC_PROFILE_COUNT];
+
+    ESP_LOGI(TAG, "⏰ Waking all %u PCs...", (unsigned)PC_PROFILE_COUNT);
+    if (wifi_manager_check_connection() != ESP_OK) {
+        ESP_LOGE(TAG, "❌ WiFi connection lost! Cannot wake PCs");
+        return ESP_FAIL;
+    }
+    login_trace_mark(trace, LOGIN_TRACE_WIFI_CHECK);
+
+    esp_err_t ret = wol_group_wake(pc_wol, PC_PROFILE_COUNT, &config, results);
+    login_trace_mark(trace, LOGIN_TRACE_WAKE_WAIT);
+    if (ret == ESP_ERR_NOT_FINISHED) {
+        return ret;
+    }
+    for (size_t i = 0; i < PC_PROFILE_COUNT; i++) {
+        switch (results[i].status) {
+            case WOL_GROUP_WOKE:
+                ESP_LOGI(TAG, "🌅 %s is waking up (%u bursts, %lu ms)", pc_profiles[i].name, results[i].bursts,
+                         (unsigned long)results[i].confirm_ms);
+                host_tracker_set(i, HOST_STATE_BOOTING);
+                break;
+            case WOL_GROUP_ANSWERS_ARP:
+                ESP_LOGI(TAG, "✅ %s answers ARP (already on?)", pc_profiles[i].name);
+                break;
+            default:
+                ESP_LOGW(TAG, "❌ %s did not respond after %u bursts", pc_profiles[i].name, results[i].bursts);
+                host_tracker_set(i, HOST_STATE_OFF);
+                break;
+        }
+    }
+    return ret;
+}
+
+// Login worker job: one login per queued tap, against the card's PC profile
+static esp_err_t login_job(const login_job_t *job, void *arg)
+{
+    login_trace_mark(job->tag, LOGIN_TRACE_QUEUE);
+    if (job->profile == WAKE_ALL_PROFILE) {
+        return wake_all_pcs(job->tag);
+    }
+    return perform_windows_login(&pc_profiles[job->profile], job->tag);
+}
+
+static void login_job_done(const login_job_t *job, esp_err_t result, void *arg)
+{
+    login_trace_finish(job->tag, result);
+    app_event_t event = { .type = APP_EVENT_LOGIN_DONE };
+    event.result = result;
+    app_post(&event);
+}
+
+static void on_wifi_event(bool connected, void *arg) {
+    app_event_t event = { .type = connected ? APP_EVENT_NET_UP : APP_EVENT_NET_DOWN };
+    app_post(&event);
+}
+
+static void on_usb_event(hid_keyboard_usb_event_t usb_event, void *arg) {
+    app_event_t event;
+    switch (usb_event) {
+        case HID_KEYBOARD_USB_MOUNTED:   event.type = APP_EVENT_USB_MOUNTED; break;
+        case HID_KEYBOARD_USB_UNMOUNTED: event.type = APP_EVENT_USB_UNMOUNTED; break;
+        case HID_KEYBOARD_USB_SUSPENDED: event.type = APP_EVENT_USB_SUSPENDED; break;
+        case HID_KEYBOARD_USB_LEDS:      event.type = APP_EVENT_KBD_LEDS; break;
+        default:                         event.type = APP_EVENT_USB_RESUMED; break;
+    }
+    app_post(&event);
+}
+
+static void on_app_tick(void *arg) {
+    app_event_t event = { .type = APP_EVENT_TICK };
+    app_post(&event);
+}
+
+static const char *app_state_name(app_state_t state) {
+    switch (state) {
+        case APP_STATE_IDLE:       return "idle";
+        case APP_STATE_LOGIN:      return "login";
+        case APP_STATE_CANCELLING: return "cancelling";
+    }
+    return "?";
+}
+
+static void app_set_state(app_state_t *state, app_state_t next) {
+    if (*state != next) {
+        ESP_LOGI(TAG, "State: %s → %s", app_state_name(*state), app_state_name(next));
+        *state = next;
+    }
+}
+
+static void app_cancel_login(app_state_t *state, const char *reason) {
+    ESP_LOGW(TAG, "⏹️ Cancelling login: %s", reason);
+    login_worker_cancel();
+    app_set_state(state, APP_STATE_CANCELLING);
+}
+
+// Hands an authorized tap to the login worker, which decides between start, queue, coalesce,
+// supersede and cancel (see login_worker_submit)
+static void app_submit_login(app_state_t *state, const app_event_t *event, int64_t *login_started_us) {
+    login_job_t job = {
+        .uid_length = event->card.uid_length,
+        .profile = event->card.profile,
+        .tag = event->card.trace,
+    };
+    memcpy(job.uid, event->card.uid, event->card.uid_length);
+    const char *pc = job.profile == WAKE_ALL_PROFILE ? "all PCs" : pc_profiles[job.profile].name;
+
+    switch (login_worker_submit(&job)) {
+        case LOGIN_WORKER_STARTED:
+            led_post(LED_AUTH_SUCCESS);
+            ESP_LOGI(TAG, "🚀 Triggering Windows login process for %s...", pc);
+            break;
+        case LOGIN_WORKER_SUPERSEDED:
+            led_post(LED_AUTH_SUCCESS);
+            ESP_LOGI(TAG, "🔀 Switching login to %s", pc);
+            break;
+        case LOGIN_WORKER_COALESCED:
+            ESP_LOGI(TAG, "⏳ Login for %s already in progress", pc);
+            login_trace_finish(job.tag, ESP_OK);
+            return;
+        case LOGIN_WORKER_CANCELLED:
+            ESP_LOGW(TAG, "⏹️ Cancelling login: card tapped again");
+            login_trace_finish(job.tag, ESP_OK);
+            if (!login_worker_busy()) {
+                app_set_state(state, APP_STATE_IDLE);
+            } else if (*state == APP_STATE_LOGIN) {
+                app_set_state(state, APP_STATE_CANCELLING);
+            }
+            return;
+        case LOGIN_WORKER_QUEUE_FULL:
+            ESP_LOGW(TAG, "⚠️ Login queue full, tap ignored");
+            login_trace_finish(job.tag, ESP_ERR_NO_MEM);
+            return;
+    }
+    *login_started_us = esp_timer_get_time();
+    app_set_state(state, APP_STATE_LOGIN);
+}
+
+// Application state machine: every decision is taken here, one event at a time
+static void app_run_state_machine(void)
+{
+    app_state_t state = APP_STATE_IDLE;
+    int64_t login_started_us = 0;
+    uint32_t logins_done = 0;
+    app_event_t event;
+
+    while (1) {
+        if (xQueueReceive(app_event_queue, &event, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        switch (event.type) {
+            case APP_EVENT_CARD_TAP:
+                if (!event.card.authorized) {
+                    led_post(LED_AUTH_FAIL);
+                    login_trace_finish(event.card.trace, ESP_ERR_NOT_ALLOWED);
+                } else {
+                    host_tracker_poke();
+                    app_submit_login(&state, &event, &login_started_us);
+                }
+                break;
+
+            case APP_EVENT_CARD_REMOVED:
+                ESP_LOGI(TAG, "Card removed");
+                break;
+
+            case APP_EVENT_NET_UP:
+                ESP_LOGI(TAG, "📡 Network up");
+                break;
+
+            case APP_EVENT_NET_DOWN:
+                ESP_LOGW(TAG, "📡 Network down");
+                if (state != APP_STATE_IDLE) {
+                    app_cancel_login(&state, "network down");
+                }
+                break;
+
+            case APP_EVENT_USB_MOUNTED:
+            case APP_EVENT_USB_RESUMED:
+                host_tracker_poke();
+                readiness_note(READINESS_SIG_USB);
+                ESP_LOGI(TAG, "🔌 USB host active");
+                break;
+
+            case APP_EVENT_KBD_LEDS:
+                readiness_note(READINESS_SIG_KBD_LEDS);
+                break;
+
+            case APP_EVENT_USB_UNMOUNTED:
+            case APP_EVENT_USB_SUSPENDED:
+                ESP_LOGI(TAG, "🔌 USB host gone or asleep");
+                break;
+
+            case APP_EVENT_LOGIN_DONE:
+                if (event.result == ESP_OK) {
+                    ESP_LOGI(TAG, "🎉 Windows login process completed successfully!");
+                } else if (event.result == ESP_ERR_NOT_FINISHED) {
+                    ESP_LOGI(TAG, "⏹️ Windows login cancelled");
+                } else if (event.result == ESP_ERR_INVALID_STATE) {
+                    ESP_LOGI(TAG, "⏭️ Queued login superseded by another PC");
+                } else {
+                    ESP_LOGE(TAG, "❌ Windows login process failed!");
+                }
+                if (TRACE_SUMMARY_EVERY && ++logins_done % TRACE_SUMMARY_EVERY == 0) {
+                    login_trace_log_summary();
+                    sock_budget_log_stats();
+                }
+                // A superseding or queued tap keeps the worker going
+                if (!login_worker_busy()) {
+                    app_set_state(&state, APP_STATE_IDLE);
+                } else {
+                    login_started_us = esp_timer_get_time();
+                    app_set_state(&state, APP_STATE_LOGIN);
+                }
+                break;
+
+            case APP_EVENT_TICK:
+                if (state == APP_STATE_LOGIN &&
+                    esp_timer_get_time() - login_started_us > (int64_t)LOGIN_TIMEOUT_MS * 1000) {
+                    app_cancel_login(&state, "timeout");
+                }
+                break;
+        }
+    }
+}
+
 void app_main()
 {
     pn532_io_t pn532_io;
@@ -587,14 +1536,56 @@ void app_main()
     ESP_LOGI(TAG, "🚀 Starting Windows Login NFC Reader");
     ESP_LOGI(TAG, "📋 Configuration:");
     ESP_LOGI(TAG, "   WiFi SSID: %s", WIFI_SSID);
-    ESP_LOGI(TAG, "   PC IP: %s", PC_IP_ADDRESS);
-    ESP_LOGI(TAG, "   PC MAC: %s", PC_MAC_ADDRESS);
+    for (size_t i = 0; i < PC_PROFILE_COUNT; i++) {
+        ESP_LOGI(TAG, "   PC %u (%s): IP %s, MAC %s", (unsigned)i, pc_profiles[i].name,
+                 pc_profiles[i].ip, pc_profiles[i].mac);
+    }
     ESP_LOGI(TAG, "   Password: %s", WINDOWS_PASSWORD);
 
     // Initialize LED
     ESP_LOGI(TAG, "💡 Initializing LED...");
     init_led();
     ESP_LOGI(TAG, "✅ LED initialized");
+
+    // Event plumbing for the state machine; LED patterns and logins run in their own tasks
+    app_event_queue = xQueueCreate(APP_EVENT_QUEUE_LEN, sizeof(app_event_t));
+    led_queue = xQueueCreate(LED_QUEUE_LEN, sizeof(led_pattern_t));
+    if (!app_event_queue || !led_queue) {
+        ESP_LOGE(TAG, "❌ Failed to create event queues");
+        return;
+    }
+    xTaskCreate(led_task, "led", 3072, NULL, 3, NULL);
+
+    // Per-tap stage timings, summarised every TRACE_SUMMARY_EVERY logins
+    if (login_trace_init() == ESP_OK) {
+        login_trace_set_deadline(LOGIN_TRACE_CARD_READ, TRACE_DEADLINE_CARD_READ_MS);
+        login_trace_set_deadline(LOGIN_TRACE_AUTH, TRACE_DEADLINE_AUTH_MS);
+        login_trace_set_deadline(LOGIN_TRACE_QUEUE, TRACE_DEADLINE_QUEUE_MS);
+        login_trace_set_deadline(LOGIN_TRACE_WIFI_CHECK, TRACE_DEADLINE_WIFI_CHECK_MS);
+        login_trace_set_deadline(LOGIN_TRACE_TOTAL, TRACE_DEADLINE_TOTAL_MS);
+    }
+    // Shared sockets, ARP probing and the wake watch, set up once before any task uses them
+    if (sock_budget_init() != ESP_OK || wol_presence_init() != ESP_OK) {
+        ESP_LOGE(TAG, "❌ Failed to set up WoL networking");
+        return;
+    }
+    for (size_t i = 0; i < PC_PROFILE_COUNT; i++) {
+        if (wol_context_init(&pc_wol[i], pc_profiles[i].mac, pc_profiles[i].ip) != ESP_OK) {
+            ESP_LOGW(TAG, "⚠️ Invalid MAC/IP for %s; Wake-on-LAN will fail", pc_profiles[i].name);
+            continue;
+        }
+        if (wol_context_set_secureon(&pc_wol[i], pc_profiles[i].secureon) != ESP_OK) {
+            ESP_LOGW(TAG, "⚠️ Invalid SecureOn password for %s; sending without it", pc_profiles[i].name);
+        }
+        if (wol_context_set_ipv6(&pc_wol[i], pc_profiles[i].ipv6, WOL_IPV6_ALL_NODES) != ESP_OK) {
+            ESP_LOGW(TAG, "⚠️ Invalid IPv6 address for %s", pc_profiles[i].name);
+            wol_context_set_ipv6(&pc_wol[i], NULL, WOL_IPV6_ALL_NODES);
+        }
+    }
+    if (login_worker_init(login_job, login_job_done, NULL, 4096, 4) != ESP_OK) {
+        ESP_LOGE(TAG, "❌ Failed to start login worker");
+        return;
+    }
     
     // Initialize NVS (required for WiFi)
     ESP_LOGI(TAG, "🔧 Initializing NVS...");
@@ -605,6 +1596,7 @@ void app_main()
     }
     ESP_ERROR_CHECK(err);
     ESP_LOGI(TAG, "✅ NVS initialized");
+    readiness_init();
 
     // Initialize WiFi
     ESP_LOGI(TAG, "🔧 Initializing WiFi...");
@@ -614,6 +1606,7 @@ void app_main()
         ESP_LOGE(TAG, "Error code: %s", esp_err_to_name(err));
         return;
     }
+    wifi_manager_set_event_callback(on_wifi_event, NULL);
     ESP_LOGI(TAG, "✅ WiFi manager initialized successfully");
     
     // Connect to WiFi
@@ -630,6 +1623,20 @@ void app_main()
     char ip_str[16];
     wifi_manager_get_ip(ip_str, sizeof(ip_str));
     ESP_LOGI(TAG, "IP address: %s", ip_str);
+
+    // Keep each PC's state fresh in the background so a tap doesn't have to probe
+    host_tracker_host_t tracked[PC_PROFILE_COUNT];
+    for (size_t i = 0; i < PC_PROFILE_COUNT; i++) {
+        tracked[i] = (host_tracker_host_t){ .wol = &pc_wol[i], .ip = pc_profiles[i].ip };
+    }
+    const host_tracker_config_t tracker_config = {
+        .min_interval_ms = HOST_TRACK_MIN_INTERVAL_MS,
+        .max_interval_ms = HOST_TRACK_MAX_INTERVAL_MS,
+        .idle_after_ms = HOST_TRACK_IDLE_AFTER_MS,
+    };
+    if (host_tracker_init(tracked, PC_PROFILE_COUNT, &tracker_config) != ESP_OK) {
+        ESP_LOGW(TAG, "⚠️ Host tracker not started; every tap will probe the PC");
+    }
     
     // Initialize HID keyboard
     ESP_LOGI(TAG, "Initializing HID keyboard...");
@@ -640,19 +1647,23 @@ void app_main()
     }
     
     ESP_LOGI(TAG, "✅ HID keyboard initialized!");
+    hid_keyboard_set_usb_callback(on_usb_event, NULL);
     
     // Show boot indication
-    led_boot_indication();
+    led_post(LED_BOOT);
     
     ESP_LOGI(TAG, "🔄 Ready! Waiting for NFC card authentication...");
     ESP_LOGI(TAG, "💡 Tap your authorized NFC card to trigger Windows login");
-    ESP_LOGI(TAG, "📋 Authorized UIDs configured:");
-    for (int i = 0; i < MAX_AUTHORIZED_UIDS; i++) {
-        if (authorized_uid_lengths[i] > 0) {
-            ESP_LOGI(TAG, "   UID #%d (%d bytes):", i + 1, authorized_uid_lengths[i]);
-            ESP_LOG_BUFFER_HEX_LEVEL(TAG, authorized_uids[i], authorized_uid_lengths[i], ESP_LOG_INFO);
-        }
+    ESP_LOGI(TAG, "📋 Authorized UIDs configured: %u", (unsigned)uid_allowlist_size());
+    if (uid_allowlist_flash_init() == ESP_OK) {
+        ESP_LOGI(TAG, "📋 Allowlist partition: %u UIDs (v%lu)",
+                 (unsigned)uid_allowlist_flash_size(), (unsigned long)uid_allowlist_flash_version());
     }
+#if CARD_ENROLL_ENABLED
+    if (card_enroll_init() == ESP_OK) {
+        ESP_LOGI(TAG, "📋 Enrolled/revoked at runtime: %u", (unsigned)card_enroll_count());
+    }
+#endif
     
     // Start WiFi health check task
     ESP_LOGI(TAG, "🔧 Starting WiFi health monitoring...");
@@ -669,8 +1680,16 @@ void app_main()
 
     vTaskDelay(1000 / portTICK_PERIOD_MS);
 
+#if CONFIG_PN532_TRANSPORT_SPI
+    ESP_LOGI(TAG, "init PN532 in SPI mode");
+    ESP_ERROR_CHECK(pn532_new_driver_spi(MISO_PIN, MOSI_PIN, SCK_PIN, CS_PIN, RESET_PIN, IRQ_PIN, SPI2_HOST, 0, &pn532_io));
+#elif CONFIG_PN532_TRANSPORT_HSU
+    ESP_LOGI(TAG, "init PN532 in HSU mode");
+    ESP_ERROR_CHECK(pn532_new_driver_hsu(UART_RX_PIN, UART_TX_PIN, RESET_PIN, IRQ_PIN, UART_NUM_1, PN532_HSU_BAUD_AUTO, &pn532_io));
+#else
     ESP_LOGI(TAG, "init PN532 in I2C mode");
     ESP_ERROR_CHECK(pn532_new_driver_i2c(SDA_PIN, SCL_PIN, RESET_PIN, IRQ_PIN, 0, &pn532_io));
+#endif
 
     do {
         err = pn532_init(&pn532_io);
@@ -696,143 +1715,20 @@ void app_main()
     ESP_LOGI(TAG, "Found chip PN5%x", (unsigned int)(version_data >> 24) & 0xFF);
     ESP_LOGI(TAG, "Firmware ver. %d.%d", (int)(version_data >> 16) & 0xFF, (int)(version_data >> 8) & 0xFF);
 
-    ESP_LOGI(TAG, "Waiting for an ISO14443A Card ...");
-    while (1)
-    {
-        uint8_t uid[] = {0, 0, 0, 0, 0, 0, 0}; // Buffer to store the returned UID
-        uint8_t uid_length;                     // Length of the UID (4 or 7 bytes depending on ISO14443A card type)
-
-        // Wait for an ISO14443A type cards (Mifare, etc.).  When one is found
-        // 'uid' will be populated with the UID, and uid_length will indicate
-        // if the uid is 4 bytes (Mifare Classic) or 7 bytes (Mifare Ultralight)
-        err = pn532_read_passive_target_id(&pn532_io, PN532_BRTY_ISO14443A_106KBPS, uid, &uid_length, 0);
-
-        if (ESP_OK == err)
-        {
-            // Display some basic information about the card
-            ESP_LOGI(TAG, "Found an ISO14443A card");
-            ESP_LOGI(TAG, "UID Length: %d bytes", uid_length);
-            ESP_LOGI(TAG, "UID Value:");
-            ESP_LOG_BUFFER_HEX_LEVEL(TAG, uid, uid_length, ESP_LOG_INFO);
-
-            err = pn532_in_list_passive_target(&pn532_io);
-            if (err != ESP_OK) {
-                ESP_LOGW(TAG, "❌ Failed to inList passive target - misread or card too far");
-                led_read_fail();
-                continue;
-            }
-
-            NTAG2XX_MODEL ntag_model = NTAG2XX_UNKNOWN;
-            err = ntag2xx_get_model(&pn532_io, &ntag_model);
-            if (err != ESP_OK) {
-                ESP_LOGW(TAG, "❌ Failed to get NTAG model - misread or card too far");
-                led_read_fail();
-                continue;
-            }
+#if CARD_PROVISION_MODE
+    run_provisioning_station(&pn532_io);
+#endif
 
-            int page_max;
-            switch (ntag_model) {
-                case NTAG2XX_NTAG213:
-                    page_max = 45;
-                    ESP_LOGI(TAG, "found NTAG213 target (or maybe NTAG203)");
-                    break;
+    card_cache_init();
+    reader_supervisor_init();
+    reader_run_diagnostics(&pn532_io, "boot");
 
-                case NTAG2XX_NTAG215:
-                    page_max = 135;
-                    ESP_LOGI(TAG, "found NTAG215 target");
-                    break;
+    xTaskCreate(reader_task, "reader", 6144, &pn532_io, 5, NULL);
 
-                case NTAG2XX_NTAG216:
-                    page_max = 231;
-                    ESP_LOGI(TAG, "found NTAG216 target");
-                    break;
+    const esp_timer_create_args_t tick_args = { .callback = on_app_tick, .name = "app_tick" };
+    esp_timer_handle_t tick_timer;
+    ESP_ERROR_CHECK(esp_timer_create(&tick_args, &tick_timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(tick_timer, (uint64_t)APP_TICK_MS * 1000));
 
-                default:
-                    ESP_LOGI(TAG, "Found unknown NTAG target!");
-                    continue;
-            }
-
-            // Read pages to get NDEF data for authentication
-            uint8_t ndef_data[256];
-            int ndef_len = 0;
-            bool auth_success = false;
-            
-            // Read first 16 pages (256 bytes) to capture NDEF data across boundaries
-            for(int page=0; page < 16 && page < page_max; page+=4) {
-                uint8_t buf[16];
-                err = ntag2xx_read_page(&pn532_io, page, buf, 16);
-                if (err == ESP_OK) {
-                    ESP_LOG_BUFFER_HEXDUMP(TAG, buf, 16, ESP_LOG_INFO);
-                    
-                    // Collect NDEF data for authentication
-                    if (ndef_len <= (int)sizeof(ndef_data) - 16) {
-                        memcpy(ndef_data + ndef_len, buf, 16);
-                        ndef_len += 16;
-                    }
-                }
-                else {
-                    ESP_LOGI(TAG, "Failed to read page %d", page);
-                    break;
-                }
-            }
-            
-            // Check if we failed to read any data (misread)
-            if (ndef_len == 0) {
-                ESP_LOGW(TAG, "❌ Failed to read card data - misread or card too far");
-                led_read_fail();
-                continue; // Try again
-            }
-            
-            // Try to authenticate the card using UID
-            ESP_LOGI(TAG, "🔍 Authenticating card using UID...");
-            ESP_LOGI(TAG, "📋 Card UID (%d bytes):", uid_length);
-            ESP_LOG_BUFFER_HEX_LEVEL(TAG, uid, uid_length, ESP_LOG_INFO);
-            
-            if (authenticate_uid(uid, uid_length)) {
-                ESP_LOGI(TAG, "✅ AUTHENTICATION SUCCESS! Card authorized.");
-                auth_success = true;
-                
-                // Show authentication success LED
-                led_auth_success();
-                
-                // Perform Windows login instead of just LED effects
-                ESP_LOGI(TAG, "🚀 Triggering Windows login process...");
-                esp_err_t login_result = perform_windows_login();
-                
-                if (login_result == ESP_OK) {
-                    ESP_LOGI(TAG, "🎉 Windows login process completed successfully!");
-                } else {
-                    ESP_LOGE(TAG, "❌ Windows login process failed!");
-                }
-            } else {
-                ESP_LOGI(TAG, "❌ Authentication failed. UID not authorized.");
-                
-                // Show authentication failure LED
-                led_auth_fail();
-            }
-            
-            // Continue reading remaining pages for display
-            for(int page=16; page < page_max; page+=4) {
-                uint8_t buf[16];
-                err = ntag2xx_read_page(&pn532_io, page, buf, 16);
-                if (err == ESP_OK) {
-                    ESP_LOG_BUFFER_HEXDUMP(TAG, buf, 16, ESP_LOG_INFO);
-                }
-                else {
-                    ESP_LOGI(TAG, "Failed to read page %d", page);
-                    break;
-                }
-            }
-            
-            if (auth_success) {
-                ESP_LOGI(TAG, "🎉 Authorized card processed successfully!");
-            }
-            
-            vTaskDelay(1000 / portTICK_PERIOD_MS);
-        } else {
-            // NFC read failed - show single red blink for misread/cut-off
-            ESP_LOGD(TAG, "NFC read failed or no card detected");
-            led_read_fail();
-        }
-    }
-}
\ No newline at end of file
+    app_run_state_machine();
+}